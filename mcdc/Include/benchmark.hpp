@@ -0,0 +1,61 @@
+// --------------------------------------------------------------------------------------------------------------------------------
+// License:	BSD-3-Clause
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Copyright 2019      Armin Montigny
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+// following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the 
+//    following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the 
+//    following disclaimer in the documentation and /or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or 
+//    promote products derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+
+
+#pragma once
+#ifndef BENCHMARK_HPP
+#define BENCHMARK_HPP
+
+//
+// Benchmark for the virtual machine
+//
+// The virtual machine has a byte code interpreter and a reference implementation, 
+// which calls a std::function for every opcode. And there is the bit sliced mode.
+// This benchmark compiles boolean expressions and runs all implementations for all possible input values.
+// The results are compared and the runtime is shown.
+//
+// The boolean expressions are read from an option file. All "-s" options will be used,
+// also those, that are commented out. So the typical "options.txt" can be used as a test set.
+
+
+#include "types.hpp"
+
+#include <string>
+#include <vector>
+
+
+// Read all boolean expressions given with option "-s" from an option file. Also commented lines will be read
+std::vector<std::string> readBooleanExpressionsFromOptionFile(const std::string& optionFileName);
+
+// Run the benchmark for all boolean expressions in the given option file and show the results
+void benchmarkVirtualMachine(const std::string& optionFileName);
+
+
+#endif
@@ -0,0 +1,103 @@
+// --------------------------------------------------------------------------------------------------------------------------------
+// License:	BSD-3-Clause
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Copyright 2019      Armin Montigny
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+// following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the 
+//    following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the 
+//    following disclaimer in the documentation and /or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or 
+//    promote products derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+
+
+#pragma once
+#ifndef BRANCHANDBOUND_HPP
+#define BRANCHANDBOUND_HPP
+
+//
+// Exact solver for the unate covering problem with branch and bound
+//
+// If the reduction of a coverage table (see coverage.hpp) ends with a cyclic core, then Petricks method
+// multiplies out the complete CNF to a DNF. This DNF grows exponentially and may need all the memory of the machine.
+// But we need only the minimum covers. This solver searches them directly on the reduced table:
+//
+// - Every node of the search tree has a set of not yet covered rows and a set of still allowed columns
+// - In every node the table is reduced again: A row, that is covered by only one allowed column, makes this
+//   column essential. A row, that contains all columns of another row, is covered automatically and is removed.
+//   Columns, that cover no row any longer, are removed. If only one minimum cover is needed, then also dominated
+//   columns are removed. For all minimum covers this is not possible, because they are needed for equal cost alternatives.
+// - Then a lower bound for the remaining rows is calculated: A set of rows, where no 2 rows have a common column
+//   (an independent set of rows) needs at least one column per row. If the selected columns plus this lower bound
+//   is more than the best cover found so far, then this part of the search tree is dropped
+// - Else the row with the fewest columns is selected. For every of its columns there is a branch, where this column
+//   is selected. The columns of the earlier branches are not allowed any longer. So every cover is found only once
+//
+// The result is the same as the one from Petricks method: All covers with the minimum number of columns.
+// If requested (option -onecover), only one minimum cover is searched. This is the fastest mode.
+//
+// The input is the cyclic core as a vector of rows. Each row is a bitset with one bit for each column, that covers it.
+
+
+#include "types.hpp"
+#include "dynamicbitset.hpp"
+
+#include <vector>
+#include <set>
+
+
+class BranchAndBoundCovering
+{
+public:
+	explicit BranchAndBoundCovering(bool findAllMinimumCovers = true) noexcept : searchAllMinimumCovers(findAllMinimumCovers) {}
+
+	// Functor operator. Rows of the table. Bit c in a row: Column c covers the row. All rows have the same number of bits (the number of columns)
+	// Returns the minimum covers as sets of column indices, sorted like the result of Petricks method
+	ProductTermVector operator()(const std::vector<DynamicBitset>& tableRow);
+
+protected:
+	// Search in the sub tree with the given not covered rows and allowed columns. selectedColumn are the columns selected so far
+	void search(DynamicBitset liveRow, DynamicBitset liveColumn, std::vector<uint>& selectedColumn);
+
+	// Reduce the table of a node. Selected essential columns are appended. Returns false, if a row cannot be covered any longer
+	bool reduce(DynamicBitset& liveRow, DynamicBitset& liveColumn, std::vector<uint>& selectedColumn);
+	// Number of rows in a greedy independent set of rows. A lower bound for the number of columns still needed
+	uint lowerBound(const DynamicBitset& liveRow, const DynamicBitset& liveColumn) const;
+	// Check, if a cover with this number of columns can still be a result
+	bool isCandidate(std::size_t numberOfColumns) const noexcept { return searchAllMinimumCovers ? (numberOfColumns <= bestNumberOfColumns) : (numberOfColumns < bestNumberOfColumns); }
+
+	// Search all covers with the minimum number of columns, or only one
+	bool searchAllMinimumCovers{ true };
+
+	// The table. Rows as bitsets over the columns and columns as bitsets over the rows
+	std::vector<DynamicBitset> rowBit{};
+	std::vector<DynamicBitset> columnBit{};
+
+	// Number of columns in the best cover found so far and all minimum covers with this size
+	std::size_t bestNumberOfColumns{ 0U };
+	std::set<ProductTerm> minimumCover{};
+
+	// Number of visited nodes in the search tree. For option -stats
+	ull numberOfNodes{ 0ULL };
+};
+
+
+#endif
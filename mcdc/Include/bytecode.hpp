@@ -0,0 +1,72 @@
+// --------------------------------------------------------------------------------------------------------------------------------
+// License:	BSD-3-Clause
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Copyright 2019      Armin Montigny
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+// following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the 
+//    following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the 
+//    following disclaimer in the documentation and /or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or 
+//    promote products derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+
+
+#pragma once
+#ifndef BYTECODE_HPP
+#define BYTECODE_HPP
+
+//
+// Dense byte code for the virtual machine
+//
+// The loader of the virtual machine converts the object code from the code generator into byte code.
+// One byte code line has an opcode and up to 3 operands with 16 bit. So a line needs only 8 bytes and
+// a complete program fits easily into the cache.
+//
+// The byte code is interpreted by a simple switch loop in the virtual machine and it is also the
+// input for the bit sliced SIMD kernels.
+//
+// Operands for the load operations (ID, IDNOT) are the bit positions of the boolean variable in the input value.
+// Operands for all other operations are machine register numbers.
+
+#include "types.hpp"
+#include "token.hpp"
+
+#include <cstdint>
+#include <vector>
+
+
+// Type for the operands. Registers and bit positions
+using ByteCodeOperand = uint16_t;
+
+// One line of byte code. The Token is used as opcode
+struct ByteCodeLine
+{
+	Token operation{ Token::NONE };
+	ByteCodeOperand parameter1{ null<ByteCodeOperand>() };
+	ByteCodeOperand parameter2{ null<ByteCodeOperand>() };
+	ByteCodeOperand parameter3{ null<ByteCodeOperand>() };
+};
+
+// A complete program in byte code
+using ByteCodeProgram = std::vector<ByteCodeLine>;
+
+
+#endif
@@ -0,0 +1,471 @@
+// --------------------------------------------------------------------------------------------------------------------------------
+// License:	BSD-3-Clause
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Copyright 2019      Armin Montigny
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+// following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the 
+//    following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the 
+//    following disclaimer in the documentation and /or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or 
+//    promote products derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+
+
+#pragma once
+#ifndef COMPILETIMEEVALUATOR_HPP
+#define COMPILETIMEEVALUATOR_HPP
+
+//
+// Compile time evaluator for boolean expressions
+//
+// Header only. The boolean expression is given as string literal and it is compiled and evaluated 
+// by the C++ compiler. Nothing is done at runtime. This can be used in unit test generators to embed
+// precomputed truth tables without calling the mcdc program during the build. 
+//
+// The same grammar as for the runtime compiler is used (see grammar.hpp). The scanner and the shift
+// match reduce parser are reimplemented with constexpr functions. The code generator creates byte code
+// (see bytecode.hpp). Every generated value gets its own register. So no register allocation is needed.
+// 
+// The byte code is evaluated in bit sliced mode. One run of the program calculates the results for 
+// 64 input values. So also a complete truth table can be calculated in reasonable "compile time".
+//
+// The mapping of boolean variables to input bits is the same as in the runtime virtual machine. 
+// The alphabetically first variable is the most significant bit. For "ab", input value 2 means a=1, b=0
+//
+// Example:
+//
+//		constexpr CompileTimeBooleanExpression booleanExpression{ "ab+c" };
+//		static_assert(booleanExpression.isValid());
+//		static_assert(booleanExpression(0b110U));
+//		constexpr auto truthTable{ booleanExpression.truthTable<booleanExpression.numberOfBooleanVariables()>() };
+//		static_assert(truthTable.numberOfMinterms() == 5U);
+//
+
+
+#include "types.hpp"
+#include "token.hpp"
+#include "grammar.hpp"
+#include "bytecode.hpp"
+
+#include <array>
+
+
+// Maximum number of byte code lines for a boolean expression, evaluated at compile time
+constexpr uint MaxNumberOfCompileTimeByteCodeLines{ 256U };
+// Maximum depth of the parse stack
+constexpr uint MaxCompileTimeParseStackSize{ 128U };
+// Maximum number of different letters in the boolean expression
+constexpr uint MaxNumberOfCompileTimeSymbols{ 26U };
+
+
+
+// Truth table with results for all 2^NumberOfVariables input values. Packed, bit k of word w is the result for input value w*64+k
+template <uint NumberOfVariables>
+struct CompileTimeTruthTable
+{
+	static_assert(NumberOfVariables <= static_cast<uint>(MaxNumberOfBitsForEvaluation), "Too many boolean variables for a truth table");
+
+	// Number of words needed for all input values
+	static constexpr uint NumberOfWords{ (NumberOfVariables > NumberOfLaneBitsInTruthTableWord) ? (1U << (NumberOfVariables - NumberOfLaneBitsInTruthTableWord)) : 1U };
+	static constexpr uint NumberOfInputValues{ 1U << NumberOfVariables };
+
+	std::array<TruthTableWord, NumberOfWords> word{};
+
+	// Result for one input value
+	constexpr bool operator[](uint inputValue) const noexcept { return null<TruthTableWord>() != (word[inputValue >> NumberOfLaneBitsInTruthTableWord] & (1ULL << (inputValue & (NumberOfLanesInTruthTableWord - 1U)))); }
+
+	// Number of input values, for which the boolean expression is true
+	constexpr uint numberOfMinterms() const noexcept
+	{
+		uint count{ 0U };
+		for (uint w = 0U; w < NumberOfWords; ++w)
+		{
+			TruthTableWord value{ word[w] };
+			while (null<TruthTableWord>() != value)
+			{
+				value &= value - 1U;
+				++count;
+			}
+		}
+		return count;
+	}
+	// Get the n-th minterm (in ascending order). Returns NumberOfInputValues, if there is no such minterm
+	constexpr uint minterm(uint index) const noexcept
+	{
+		uint result{ NumberOfInputValues };
+		uint count{ 0U };
+		for (uint inputValue = 0U; inputValue < NumberOfInputValues; ++inputValue)
+		{
+			if ((*this)[inputValue])
+			{
+				if (count == index)
+				{
+					result = inputValue;
+					break;
+				}
+				++count;
+			}
+		}
+		return result;
+	}
+};
+
+
+
+// A boolean expression, compiled at compile time
+class CompileTimeBooleanExpression
+{
+public:
+	// Compile the boolean expression. In case of a syntax error, isValid() will return false
+	constexpr explicit CompileTimeBooleanExpression(const cchar* source) noexcept { compile(source); }
+
+	// Was the compilation successful?
+	constexpr bool isValid() const noexcept { return valid; }
+	// Number of different boolean variables (letters) in the boolean expression
+	constexpr uint numberOfBooleanVariables() const noexcept { return numberOfVariables; }
+	// Number of byte code lines of the compiled program
+	constexpr uint numberOfByteCodeLines() const noexcept { return numberOfLines; }
+	// One line of the compiled program
+	constexpr ByteCodeLine byteCodeLine(uint index) const noexcept { return byteCode[index]; }
+
+	// Evaluate the boolean expression for one input value
+	constexpr bool operator()(uint inputValue) const noexcept
+	{
+		std::array<TruthTableWord, MaxNumberOfCompileTimeByteCodeLines> machineRegister{};
+		const TruthTableWord result{ runBitSliced(inputValue >> NumberOfLaneBitsInTruthTableWord, machineRegister) };
+		return null<TruthTableWord>() != (result & (1ULL << (inputValue & (NumberOfLanesInTruthTableWord - 1U))));
+	}
+
+	// Calculate the complete truth table. NumberOfVariables should be numberOfBooleanVariables().
+	// If it is greater, then the additional (high) input bits are ignored
+	template <uint NumberOfVariables>
+	constexpr CompileTimeTruthTable<NumberOfVariables> truthTable() const noexcept
+	{
+		CompileTimeTruthTable<NumberOfVariables> result{};
+		std::array<TruthTableWord, MaxNumberOfCompileTimeByteCodeLines> machineRegister{};
+		for (uint blockIndex = 0U; blockIndex < CompileTimeTruthTable<NumberOfVariables>::NumberOfWords; ++blockIndex)
+		{
+			result.word[blockIndex] = runBitSliced(blockIndex, machineRegister);
+		}
+		// Unused lanes, for less than 6 variables, are 0
+		if (NumberOfVariables < NumberOfLaneBitsInTruthTableWord)
+		{
+			result.word[0] &= (1ULL << (1U << NumberOfVariables)) - 1U;
+		}
+		return result;
+	}
+
+protected:
+	// The compiled program
+	std::array<ByteCodeLine, MaxNumberOfCompileTimeByteCodeLines> byteCode{};
+	uint numberOfLines{ 0U };
+	uint numberOfVariables{ 0U };
+	bool valid{ false };
+
+	// Scanner. Same behaviour as the runtime scanner (see scanner.cpp). Position will be incremented
+	static constexpr TokenWithAttribute getNextToken(const cchar* source, uint& position) noexcept;
+	// Match the top of the parse stack against the handles in the grammar. Returns the number of the production or MaxNumberOfProductions
+	static constexpr uint match(const std::array<TokenWithAttribute, MaxCompileTimeParseStackSize>& parseStack, uint stackSize) noexcept;
+	// The complete compiler
+	constexpr void compile(const cchar* source) noexcept;
+	// Add a line of byte code. Returns false, if there is no more space
+	constexpr bool addByteCodeLine(Token operation, uint parameter1, uint parameter2, uint parameter3) noexcept;
+	// Run the program for the 64 input values blockIndex*64 ... blockIndex*64+63
+	constexpr TruthTableWord runBitSliced(uint blockIndex, std::array<TruthTableWord, MaxNumberOfCompileTimeByteCodeLines>& machineRegister) const noexcept;
+};
+
+
+
+// Scanner. Get the next token from the source
+constexpr TokenWithAttribute CompileTimeBooleanExpression::getNextToken(const cchar* source, uint& position) noexcept
+{
+	TokenWithAttribute result{};
+	// Eat white space
+	while ((' ' == source[position]) || ('\t' == source[position]) || ('\n' == source[position]) || ('\r' == source[position]) || ('\f' == source[position]) || ('\v' == source[position]))
+	{
+		++position;
+	}
+	const cchar c{ source[position] };
+	result.inputTerminalSymbol = c;
+	// End of string
+	if ('\0' == c)
+	{
+		result.token = Token::END;
+	}
+	else
+	{
+		// Lower case letter is an ID and upper case letter is a negated ID
+		if (('a' <= c) && ('z' >= c))
+		{
+			result.token = Token::ID;
+			result.sourceIndex = static_cast<uint>(c - 'a');
+		}
+		else if (('A' <= c) && ('Z' >= c))
+		{
+			result.token = Token::ID;
+			result.sourceIndex = static_cast<uint>(c - 'A' + 26);
+		}
+		else switch (c)
+		{
+		case '|':
+			// Check for double operator
+			if ('|' == source[position + 1U]) ++position;
+			result.token = Token::OR;
+			break;
+		case '+': result.token = Token::OR; break;
+		case '^': result.token = Token::XOR; break;
+		case '&':
+			// Check for double operator
+			if ('&' == source[position + 1U]) ++position;
+			result.token = Token::AND;
+			break;
+		case '*': result.token = Token::AND; break;
+		case '!': // Fallthrough
+		case '~': result.token = Token::NOT; break;
+		case '(': result.token = Token::BOPEN; break;
+		case ')': result.token = Token::BCLOSE; break;
+		default: result.token = Token::NONE; break;
+		}
+		++position;
+	}
+	return result;
+}
+
+
+// Match the top of the parse stack with the handles and look ahead symbols in the grammar. Same as Parser::match
+constexpr uint CompileTimeBooleanExpression::match(const std::array<TokenWithAttribute, MaxCompileTimeParseStackSize>& parseStack, uint stackSize) noexcept
+{
+	uint indexOfMatchedProduction{ static_cast<uint>(MaxNumberOfProductions) };
+	for (uint indexOfProduction = 0U; indexOfProduction < static_cast<uint>(MaxNumberOfProductions); ++indexOfProduction)
+	{
+		const Production& production{ grammarForBooleanExpressions[indexOfProduction] };
+		const uint lengthOfHandleIncludingLookahead{ (production.hasLookAhead ? 1U : 0U) + production.numberOfTokensInHandle };
+		if (stackSize >= lengthOfHandleIncludingLookahead)
+		{
+			uint stackElementToCompare{ stackSize - 1U };
+			// Check the look ahead symbol
+			bool matchFound{ !production.hasLookAhead };
+			if (production.hasLookAhead)
+			{
+				for (uint i = 0U; i < static_cast<uint>(MaxNumberOfTokensForLookAhead); ++i)
+				{
+					matchFound = matchFound || (parseStack[stackElementToCompare].token == production.lookAheadTerminalSymbol[i]);
+				}
+				--stackElementToCompare;
+			}
+			// And then the handle
+			for (uint indexInHandle = 0U; matchFound && (indexInHandle < production.numberOfTokensInHandle); ++indexInHandle)
+			{
+				matchFound = (parseStack[stackElementToCompare - indexInHandle].token == production.handle[indexInHandle]);
+			}
+			if (matchFound)
+			{
+				indexOfMatchedProduction = indexOfProduction;
+				break;
+			}
+		}
+	}
+	return indexOfMatchedProduction;
+}
+
+
+// Add one line of byte code
+constexpr bool CompileTimeBooleanExpression::addByteCodeLine(Token operation, uint parameter1, uint parameter2, uint parameter3) noexcept
+{
+	bool result{ false };
+	if (numberOfLines < MaxNumberOfCompileTimeByteCodeLines)
+	{
+		byteCode[numberOfLines].operation = operation;
+		byteCode[numberOfLines].parameter1 = static_cast<ByteCodeOperand>(parameter1);
+		byteCode[numberOfLines].parameter2 = static_cast<ByteCodeOperand>(parameter2);
+		byteCode[numberOfLines].parameter3 = static_cast<ByteCodeOperand>(parameter3);
+		++numberOfLines;
+		result = true;
+	}
+	return result;
+}
+
+
+// Scanner, shift match reduce parser and code generator. Same as the runtime compiler
+constexpr void CompileTimeBooleanExpression::compile(const cchar* source) noexcept
+{
+	std::array<TokenWithAttribute, MaxCompileTimeParseStackSize> parseStack{};
+	uint stackSize{ 0U };
+	uint position{ 0U };
+	// Next free register. Every value has its own register. The register number is stored in "sourceIndex" of an EXPR
+	uint nextRegister{ 0U };
+	// Bit field with used letters a-z
+	uint32 usedSymbols{ 0U };
+
+	bool ok{ nullptr != source };
+	bool doParse{ ok };
+	while (doParse)
+	{
+		// Shift
+		const TokenWithAttribute tokenWithAttribute{ getNextToken(source, position) };
+		if ((Token::NONE == tokenWithAttribute.token) || (stackSize >= MaxCompileTimeParseStackSize))
+		{
+			ok = false;
+			break;
+		}
+		parseStack[stackSize] = tokenWithAttribute;
+		++stackSize;
+
+		// Match and reduce as long as possible
+		uint indexOfMatchedProduction{ match(parseStack, stackSize) };
+		while (ok && (indexOfMatchedProduction < static_cast<uint>(MaxNumberOfProductions)))
+		{
+			const Production& production{ grammarForBooleanExpressions[indexOfMatchedProduction] };
+			// Top of handle, without look ahead symbol
+			const uint stackPointer{ stackSize - 1U - (production.hasLookAhead ? 1U : 0U) };
+			TokenWithAttribute newTokenWithAttribute{};
+			newTokenWithAttribute.token = Token::EXPR;
+
+			switch (production.operationIdentifier)
+			{
+			case Token::ID:
+				{
+					// Letter index. Will be converted to the bit position after parsing
+					const uint letterIndex{ parseStack[stackPointer].sourceIndex % MaxNumberOfCompileTimeSymbols };
+					usedSymbols |= bitMask[letterIndex];
+					ok = addByteCodeLine((parseStack[stackPointer].sourceIndex < MaxNumberOfCompileTimeSymbols) ? Token::ID : Token::IDNOT, letterIndex, nextRegister, 0U);
+					newTokenWithAttribute.sourceIndex = nextRegister++;
+				}
+				break;
+			case Token::OR:
+			case Token::XOR:
+			case Token::AND:
+				// 3 tokens: EXPR OP EXPR.  2 tokens: EXPR EXPR (concatenation)
+				ok = addByteCodeLine(production.operationIdentifier, parseStack[stackPointer + 1U - production.numberOfTokensInHandle].sourceIndex, parseStack[stackPointer].sourceIndex, nextRegister);
+				newTokenWithAttribute.sourceIndex = nextRegister++;
+				break;
+			case Token::NOT:
+				ok = addByteCodeLine(Token::NOT, parseStack[stackPointer].sourceIndex, nextRegister, 0U);
+				newTokenWithAttribute.sourceIndex = nextRegister++;
+				break;
+			case Token::BCLOSE:
+				// Brackets. Just copy the register of the inner expression
+				newTokenWithAttribute.sourceIndex = parseStack[stackPointer - 1U].sourceIndex;
+				break;
+			case Token::END:
+				ok = addByteCodeLine(Token::END, parseStack[stackPointer - 1U].sourceIndex, 0U, 0U);
+				newTokenWithAttribute.token = Token::END;
+				break;
+#pragma warning(suppress: 4061)
+#pragma warning(suppress: 4062)
+			default: ok = false; break;
+			}
+			// Reduce. Replace the handle with the new token and keep the look ahead symbol
+			const uint startOfHandle{ stackPointer + 1U - production.numberOfTokensInHandle };
+			parseStack[startOfHandle] = newTokenWithAttribute;
+			if (production.hasLookAhead)
+			{
+				parseStack[startOfHandle + 1U] = parseStack[stackPointer + 1U];
+			}
+			stackSize = startOfHandle + 1U + (production.hasLookAhead ? 1U : 0U);
+
+			indexOfMatchedProduction = match(parseStack, stackSize);
+		}
+
+		// Normal end, if everything has been reduced to END. Else a syntax error, if the source end was found
+		if (Token::END == parseStack[0].token)
+		{
+			doParse = false;
+		}
+		else if (Token::END == tokenWithAttribute.token)
+		{
+			ok = false;
+			doParse = false;
+		}
+		if (!ok) doParse = false;
+	}
+
+	if (ok)
+	{
+		// Compact the symbols. The alphabetically first letter is the most significant bit. Same as SymbolTable::compact
+		std::array<uint, MaxNumberOfCompileTimeSymbols> bitPosition{};
+		for (uint letterIndex = 0U; letterIndex < MaxNumberOfCompileTimeSymbols; ++letterIndex)
+		{
+			if (usedSymbols & bitMask[letterIndex]) ++numberOfVariables;
+		}
+		uint symbolCounter{ numberOfVariables };
+		for (uint letterIndex = 0U; letterIndex < MaxNumberOfCompileTimeSymbols; ++letterIndex)
+		{
+			if (usedSymbols & bitMask[letterIndex]) bitPosition[letterIndex] = --symbolCounter;
+		}
+		for (uint line = 0U; line < numberOfLines; ++line)
+		{
+			if ((Token::ID == byteCode[line].operation) || (Token::IDNOT == byteCode[line].operation))
+			{
+				byteCode[line].parameter1 = static_cast<ByteCodeOperand>(bitPosition[byteCode[line].parameter1]);
+			}
+		}
+	}
+	else
+	{
+		numberOfLines = 0U;
+		numberOfVariables = 0U;
+	}
+	valid = ok;
+}
+
+
+// Bit sliced evaluation of the program. Every register holds the results for 64 input values
+constexpr TruthTableWord CompileTimeBooleanExpression::runBitSliced(uint blockIndex, std::array<TruthTableWord, MaxNumberOfCompileTimeByteCodeLines>& machineRegister) const noexcept
+{
+	// Pattern of the input bits 0..5 over the 64 lanes of a word
+	constexpr std::array<TruthTableWord, NumberOfLaneBitsInTruthTableWord> laneBitPattern{ 0xAAAAAAAAAAAAAAAAULL, 0xCCCCCCCCCCCCCCCCULL, 0xF0F0F0F0F0F0F0F0ULL, 0xFF00FF00FF00FF00ULL, 0xFFFF0000FFFF0000ULL, 0xFFFFFFFF00000000ULL };
+	TruthTableWord result{ 0U };
+	for (uint line = 0U; line < numberOfLines; ++line)
+	{
+		const ByteCodeLine& bcl{ byteCode[line] };
+		switch (bcl.operation)
+		{
+		case Token::ID:
+		case Token::IDNOT:
+			{
+				// Higher input bits are constant within a block
+				TruthTableWord pattern{ (bcl.parameter1 < NumberOfLaneBitsInTruthTableWord) ? laneBitPattern[bcl.parameter1] :
+					(((blockIndex >> (bcl.parameter1 - NumberOfLaneBitsInTruthTableWord)) & 1U) ? ~null<TruthTableWord>() : null<TruthTableWord>()) };
+				machineRegister[bcl.parameter2] = (Token::IDNOT == bcl.operation) ? ~pattern : pattern;
+			}
+			break;
+		case Token::OR:		machineRegister[bcl.parameter3] = machineRegister[bcl.parameter1] | machineRegister[bcl.parameter2]; break;
+		case Token::XOR:	machineRegister[bcl.parameter3] = machineRegister[bcl.parameter1] ^ machineRegister[bcl.parameter2]; break;
+		case Token::AND:	machineRegister[bcl.parameter3] = machineRegister[bcl.parameter1] & machineRegister[bcl.parameter2]; break;
+		case Token::NOT:	machineRegister[bcl.parameter2] = ~machineRegister[bcl.parameter1]; break;
+		case Token::END:	result = machineRegister[bcl.parameter1]; break;
+#pragma warning(suppress: 4061)
+#pragma warning(suppress: 4062)
+		default: break;
+		}
+	}
+	return result;
+}
+
+
+// Self check at compile time
+static_assert(CompileTimeBooleanExpression("aB")(2U) && !CompileTimeBooleanExpression("aB")(1U), "Compile time evaluator: wrong mapping of variables to input bits");
+static_assert(CompileTimeBooleanExpression("a+b^c!(d+e)").isValid() && !CompileTimeBooleanExpression("a+").isValid(), "Compile time evaluator: parser error");
+static_assert(CompileTimeBooleanExpression("ab+ac+bc").truthTable<3U>().numberOfMinterms() == 4U, "Compile time evaluator: wrong truth table");
+
+
+#endif
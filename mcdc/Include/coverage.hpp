@@ -157,6 +157,18 @@
 // and applying the idempotence and Absorption laws by using STL-sets which are sorted and conatin unique elements
 // More details can be found in the module "petrick.*pp"
 //
+// Update: Multiplying out the CNF gives all covers and needs exponential memory. Now the minimum covers are
+// searched directly in the cyclic core with a branch and bound method (see branchandbound.hpp). The result is the same.
+// Petricks method can still be selected with option -petrick
+//
+// Update: With option -zdd all minimum covers are calculated as a zero-suppressed decision diagram (see zdd.hpp).
+// The product of the rows is stored in compact shared form. Useful, if there are very many minimum covers.
+// Only the cheapest of them (column cost function, e.g. fewest literals) are given back
+//
+// Update: The cyclic core is split into its connected components (rows, that are linked by common columns).
+// Each component is solved on its own in the thread pool. The minimum covers of the components are combined
+// at the end. So the exponential effort depends on the biggest component and not on the complete core
+//
 // As a result we get many product terms (DNFs) which all would fullfill the coverage of the minterms
 // We will select (the heuristic her is the shortes product terms) product terms and can build the minimum
 // solution for the coverage. This is deterministic.
@@ -182,13 +194,22 @@
 // Basically it is very simple, bit for the reader more compley than a 2 dimensional table
 //
 // In the below classes we use the term "table," to make the understanding a little bit easier
+//
+// Update: Additionally every row and every column has a dense bitset with one bit for every column (row).
+// A cell is dropped exactly then, when its row or its column is dropped. So the not dropped cells of a row are
+// its bitset AND the bitset of the not dropped columns (the live mask). With that, the check for dominance is a
+// word wise (first & live & ~second) == 0 and the check for an essential column is a population count. Before,
+// this was a linear search for every cell in the other vector. The bitsets are built at the start of the reduction
+// and again after rows and columns have been erased, because then the indices change.
 
 #include "types.hpp"
 #include "cloption.hpp"
+#include "dynamicbitset.hpp"
 
 #include <string>
 #include <functional>
 #include <any>
+#include <vector>
 
 
 using Index = uint;
@@ -249,6 +270,7 @@ struct TableCellVector
 	CellVectorHeader cellVectorHeader;	// Header
 	CellVector cell;					// Vector of Cells
 	bool dropped{ false };				// Indicator, if all cells in this Vecotr are dropped. Means, the complete row or column is dropped
+	DynamicBitset coverBit{};			// Dense form of the cells. Bit k is set, if there is a cell with cross reference k (dropped or not)
 };
 
 
@@ -285,6 +307,10 @@ using CheckForCoverFunction = std::function<bool(CellVectorHeader&, CellVectorHe
 // number. It is a from of left - right
 using BestCostFunction = std::function <sint(const TableCellVector& left, const TableCellVector& right)>;
 
+// Cost of a column. For example the number of literals of a prime implicant. If there are many minimum covers,
+// then only the cheapest are calculated with option -zdd. Without this function, all columns cost the same
+using ColumnCostFunction = std::function<uint(const CellVectorHeader& columnHeader)>;
+
 
 
 // Columns cover rows
@@ -325,6 +351,8 @@ public:
 	// This function can then help to decide, which to eliminate
 	void setBestCostFunctionForColumn(BestCostFunction bcf) { bestCostCalculatorForEqualImplicationColumn = bcf; }
 	void setBestCostFunctionForRow(BestCostFunction bcf) { bestCostCalculatorForEqualImplicationColumn = bcf; }
+	// Cost of the columns for the selection of the cheapest minimum covers
+	void setColumnCostFunction(ColumnCostFunction ccf) { columnCostCalculator = ccf; }
 
 	// Shows, how many cells are still in the table and not reduced. Can be used as complexity metrics
 	ulong countNotDroppedTableElements() noexcept;	
@@ -341,7 +369,22 @@ protected:
 	void findEssentialColumn();
 
 	// For table reduction. If one row or column implies another row or column, then we can eliminate one of them
-	bool checkForImplication(TableCellVector& first, TableCellVector& second);
+	// The live mask has a bit for every not dropped vector of the other dimension
+	static bool checkForImplication(const TableCellVector& first, const TableCellVector& second, const DynamicBitset& liveMask) noexcept { return second.coverBit.isSubsetOf(first.coverBit, liveMask); }
+
+	// Build the bitsets of all rows and columns from the cells
+	void buildBitMatrix();
+	// One bit for every not dropped row or column
+	static DynamicBitset getLiveMask(const TableVector& tableVector);
+
+	// The cyclic core may consist of independent components. Rows and columns of a component have no cell in common
+	// with other components. Returns the indices of the rows of every component
+	static std::vector<std::vector<std::size_t>> findComponents(const std::vector<DynamicBitset>& cyclicCoreRow);
+	// All minimum covers of one component. With Petricks method, the ZDD or branch and bound, as selected by the options
+	// The ZDD gives only the cheapest minimum covers. columnCost has the cost of every column or is empty
+	static ProductTermVector solveComponent(const std::vector<DynamicBitset>& cyclicCoreRow, const std::vector<std::size_t>& componentRow, const std::vector<uint>& columnCost);
+	// Every combination of one minimum cover from each component is a minimum cover of the complete cyclic core
+	static ProductTermVector combineComponentCovers(const std::vector<ProductTermVector>& componentCover);
 
 	// Finds a dominating row or columns. The last parameter says, if the dominating or the dominated row shall be eliminated
 	void findDominatingVector(TableVector& firstDimension, TableVector& secondDimension, const BestCostFunction& bcf, const bool dropOuterAndNotInner);
@@ -369,8 +412,8 @@ protected:
 	// Specialising for row or column
 	void eraseAllDroppedRows() { eraseAllDroppedTableCellVectors(tableRows, tableColumns); }
 	void eraseAllDroppedColumns() { eraseAllDroppedTableCellVectors(tableColumns, tableRows); }
-	// Erase everything redundant
-	void eraseAllDroppedCells() { eraseAllDroppedRows(); eraseAllDroppedColumns(); }
+	// Erase everything redundant. Indices have changed, so the bitsets must be built again
+	void eraseAllDroppedCells() { eraseAllDroppedRows(); eraseAllDroppedColumns(); buildBitMatrix(); }
 
 	// Check, if there are still entries in the table or if everything has be reduced
 	bool isTableEmpty() noexcept { return (null<TableVector::size_type>() == tableRows.size()) || (null<TableVector::size_type>() == tableColumns.size());	}
@@ -391,6 +434,8 @@ protected:
 	// Call back function pointers for best cost calculation in case of double rows or columns
 	BestCostFunction bestCostCalculatorForEqualImplicationColumn{};
 	BestCostFunction bestCostCalculatorForEqualImplicationRow{};
+	// Call back function for the cost of a column
+	ColumnCostFunction columnCostCalculator{};
 };
 
 
@@ -0,0 +1,154 @@
+// --------------------------------------------------------------------------------------------------------------------------------
+// License:	BSD-3-Clause
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Copyright 2019      Armin Montigny
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+// following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the 
+//    following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the 
+//    following disclaimer in the documentation and /or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or 
+//    promote products derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+
+
+#pragma once
+#ifndef DYNAMICBITSET_HPP
+#define DYNAMICBITSET_HPP
+
+//
+// A bitset with a size given at runtime
+//
+// Used for the dense representation of coverage tables. A row has one bit for every column and a column
+// has one bit for every row. Set operations like "is subset of" are then done word wise for 64 elements at once.
+// Unused bits in the last word are always 0. So counting and comparing can work on complete words.
+
+
+#include "types.hpp"
+#include "truthtable.hpp"
+
+#include <vector>
+
+
+class DynamicBitset
+{
+public:
+	DynamicBitset() = default;
+	explicit DynamicBitset(std::size_t numberOfBits) : word(numberOfWordsFor(numberOfBits), 0ULL), numberOfBits(numberOfBits) {}
+
+	std::size_t size() const noexcept { return numberOfBits; }
+
+	void set(std::size_t bit) noexcept { word[bit / BitsPerWord] |= (1ULL << (bit % BitsPerWord)); }
+	void reset(std::size_t bit) noexcept { word[bit / BitsPerWord] &= ~(1ULL << (bit % BitsPerWord)); }
+	bool test(std::size_t bit) const noexcept { return 0ULL != (word[bit / BitsPerWord] & (1ULL << (bit % BitsPerWord))); }
+
+	// Set all bits
+	void setAll() noexcept
+	{
+		for (ull& w : word) w = ~0ULL;
+		if (0U != (numberOfBits % BitsPerWord)) word.back() = (1ULL << (numberOfBits % BitsPerWord)) - 1ULL;
+	}
+
+	// Number of set bits
+	std::size_t count() const noexcept
+	{
+		std::size_t result{ 0U };
+		for (const ull w : word) result += numberOfSetBitsInTruthTableWord(w);
+		return result;
+	}
+	// Number of set bits in (this & mask)
+	std::size_t countAnd(const DynamicBitset& mask) const noexcept
+	{
+		std::size_t result{ 0U };
+		for (std::size_t w = 0U; w < word.size(); ++w) result += numberOfSetBitsInTruthTableWord(word[w] & mask.word[w]);
+		return result;
+	}
+	// Index of the lowest set bit in (this & mask). Returns size(), if there is none
+	std::size_t findFirstAnd(const DynamicBitset& mask) const noexcept
+	{
+		for (std::size_t w = 0U; w < word.size(); ++w)
+		{
+			const ull x{ word[w] & mask.word[w] };
+			if (0ULL != x) return w * BitsPerWord + indexOfLowestSetBitInTruthTableWord(x);
+		}
+		return numberOfBits;
+	}
+	// Check, if any bit is set
+	bool any() const noexcept
+	{
+		bool result{ false };
+		for (std::size_t w = 0U; (w < word.size()) && !result; ++w) result = (0ULL != word[w]);
+		return result;
+	}
+	// Check, if this and other have a common set bit
+	bool intersects(const DynamicBitset& other) const noexcept
+	{
+		bool result{ false };
+		for (std::size_t w = 0U; (w < word.size()) && !result; ++w) result = (0ULL != (word[w] & other.word[w]));
+		return result;
+	}
+	// Index of the next set bit, starting with bit. Returns size(), if there is none
+	std::size_t findNext(std::size_t bit) const noexcept
+	{
+		std::size_t result{ numberOfBits };
+		std::size_t w{ bit / BitsPerWord };
+		if (w < word.size())
+		{
+			ull x{ word[w] & (~0ULL << (bit % BitsPerWord)) };
+			while ((0ULL == x) && (++w < word.size())) x = word[w];
+			if (0ULL != x) result = w * BitsPerWord + indexOfLowestSetBitInTruthTableWord(x);
+		}
+		return result;
+	}
+
+	// Set operations
+	DynamicBitset& operator &=(const DynamicBitset& other) noexcept { for (std::size_t w = 0U; w < word.size(); ++w) word[w] &= other.word[w]; return *this; }
+	DynamicBitset& operator |=(const DynamicBitset& other) noexcept { for (std::size_t w = 0U; w < word.size(); ++w) word[w] |= other.word[w]; return *this; }
+	// this = this & ~other
+	DynamicBitset& andNot(const DynamicBitset& other) noexcept { for (std::size_t w = 0U; w < word.size(); ++w) word[w] &= ~other.word[w]; return *this; }
+
+	bool operator ==(const DynamicBitset& other) const noexcept { return (numberOfBits == other.numberOfBits) && (word == other.word); }
+	bool operator <(const DynamicBitset& other) const noexcept { return (numberOfBits < other.numberOfBits) || ((numberOfBits == other.numberOfBits) && (word < other.word)); }
+
+	// Check, if all bits of this are also set in other. (this & ~other) == 0
+	bool isSubsetOf(const DynamicBitset& other) const noexcept
+	{
+		bool result{ true };
+		for (std::size_t w = 0U; (w < word.size()) && result; ++w) result = (0ULL == (word[w] & ~other.word[w]));
+		return result;
+	}
+	// Check, if all bits of (this & mask) are also set in other. (this & mask & ~other) == 0
+	bool isSubsetOf(const DynamicBitset& other, const DynamicBitset& mask) const noexcept
+	{
+		bool result{ true };
+		for (std::size_t w = 0U; (w < word.size()) && result; ++w) result = (0ULL == (word[w] & mask.word[w] & ~other.word[w]));
+		return result;
+	}
+
+protected:
+	static constexpr std::size_t BitsPerWord{ 64U };
+	static std::size_t numberOfWordsFor(std::size_t bits) noexcept { return (bits + BitsPerWord - 1U) / BitsPerWord; }
+
+	std::vector<ull> word{};
+	std::size_t numberOfBits{ 0U };
+};
+
+
+#endif
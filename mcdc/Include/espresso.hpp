@@ -0,0 +1,158 @@
+// --------------------------------------------------------------------------------------------------------------------------------
+// License:	BSD-3-Clause
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Copyright 2019      Armin Montigny
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+// following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the 
+//    following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the 
+//    following disclaimer in the documentation and /or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or 
+//    promote products derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+
+
+#pragma once
+#ifndef ESPRESSO_HPP
+#define ESPRESSO_HPP
+
+//
+// Heuristic minimization of boolean expressions. Works similar to Espresso
+//
+// The exact method (Quine&  McCluskey and then Petrick for the prime implicant table) needs time and memory,
+// that grows with the number of prime implicants. For bigger boolean expressions with more than roughly 16 variables
+// this will not finish in a reasonable time. The heuristic method here does not calculate all prime implicants.
+// It works on a list of cubes (product terms, stored like a prime implicant with a term and a mask for
+// the eliminated variables) and improves this list in a loop:
+//
+// EXPAND:		Every cube is made as big as possible. Variables are eliminated from the cube, as long as all
+//				minterms of the bigger cube are still minterms of the boolean expression. The result is a prime implicant.
+//				The variable to eliminate next is selected, so that the cube covers as many minterms as possible,
+//				that are not yet or only once covered by other cubes. Then other cubes may become redundant
+// IRREDUNDANT:	Remove cubes, whose minterms are all covered by other cubes
+// REDUCE:		Make every cube as small as possible. It needs to cover only the minterms, that are not covered by
+//				any other cube. So the next EXPAND may grow the cube in a different direction
+//
+// The loop stops, if the number of cubes and literals does not get better any longer.
+// The start cover is built by expanding all minterms that are not yet covered.
+//
+// The off-set is not stored as a cube list. Since we have the complete packed truth table, we can check directly,
+// if a cube is an implicant. For each cube this is done word wise, 64 input values at once. A counter per input
+// value notes, how many cubes of the cover contain this input value. 
+//
+// The result is not guaranteed to be the minimum DNF. But it is mostly very close and can be calculated in seconds.
+// The heuristic method is used with the command line option -espresso or automatically for big boolean expressions
+
+
+#include "types.hpp"
+#include "symboltable.hpp"
+#include "truthtable.hpp"
+#include "quinemccluskey.hpp"
+
+#include <string>
+#include <unordered_map>
+
+
+class Espresso
+{
+public:
+	Espresso() = default;
+	Espresso(const Espresso&) = delete;
+	Espresso& operator =(const Espresso&) = delete;
+
+	// Same interface and same result format as for the Quine&  McCluskey method
+	std::string getMinimumDisjunctiveNormalForm(const TruthTable& truthTable, const SymbolTable& symbolTable, const std::string& source);
+	// The cubes of the resulting cover as strings. After EXPAND all of them are prime implicants
+	std::vector<std::string> getPrimeImplicants(const SymbolTable& symbolTable) const;
+
+	// Up to this size, the exact method can be used. For bigger boolean expressions the heuristic method is selected automatically
+	static constexpr uint MaxNumberOfVariablesForExactMinimization{ 16U };
+	static constexpr ull MaxNumberOfMintermsForExactMinimization{ 1ULL << 12 };
+	static bool isSelectedFor(const TruthTable& truthTable) noexcept 
+	{ 
+		return (truthTable.getNumberOfVariables() > MaxNumberOfVariablesForExactMinimization) && (truthTable.numberOfMinterms() > MaxNumberOfMintermsForExactMinimization);
+	}
+
+protected:
+	// A cube is a product term. Term and mask for the eliminated variables, exactly like a prime implicant
+	// The bits of eliminated variables are always 0 in the term
+	using CubeTermType = uint32_t;
+	using Cube = PrimeImplicantType<CubeTermType>;
+	using Cover = std::vector<Cube>;
+	static_assert(MaxNumberOfBitsForEvaluation <= std::numeric_limits<CubeTermType>::digits, "Cube term type too small");
+
+	// Stop the EXPAND, IRREDUNDANT, REDUCE loop after this number of iterations, even if it still improves
+	static constexpr uint MaxNumberOfIterations{ 16U };
+	// Cover counters are bytes. Bigger counts are stored in an overflow map
+	static constexpr uint8_t SaturatedCoverCount{ 0xFFU };
+
+	// Cost of a cover. Number of cubes and then number of literals. Less is better
+	using Cost = std::pair<uint, uint>;
+	Cost getCost() const;
+
+	// Build the start cover. Every not yet covered minterm is expanded to a prime implicant
+	void createInitialCover();
+	// Eliminate variables from a cube as long as it is an implicant. The minterms of the cube must already be counted
+	Cube expand(Cube cube);
+	// EXPAND for all cubes of the cover
+	void expandCover();
+	// Remove redundant cubes
+	void irredundant();
+	// Shrink all cubes to the minterms that only they cover
+	void reduce();
+
+	// Check, if all minterms of the cube are minterms of the boolean expression
+	bool isImplicant(const Cube& cube) const;
+	// Check, if all minterms of the cube are covered by at least one other cube
+	bool isRedundant(const Cube& cube) const;
+	// Rate a part, that would be added to a cube. Not covered minterms count most, then minterms covered by only one cube
+	ull gainForPart(const Cube& part) const;
+
+	// Call function(wordIndex, lanes) for all words of the truth table that contain minterms of the cube
+	// lanes has a bit set for every input value in this word, that belongs to the cube. Stops, if function returns false
+	template <typename Function>
+	void forEachWordOfCube(const Cube& cube, Function function) const;
+	// Call function(minterm) for all minterms of the cube
+	template <typename Function>
+	void forEachMintermOfCube(const Cube& cube, Function function) const;
+
+	// Count one more or one less cube for an input value. Keep the bit sets in sync
+	void incrementCoverCount(CubeTermType minterm);
+	void decrementCoverCount(CubeTermType minterm);
+
+	// The boolean expression
+	const TruthTable* truthTable{ nullptr };
+	uint numberOfVariables{ 0U };
+	// All bits for variables of the boolean expression
+	CubeTermType allVariables{ 0U };
+
+	// The current list of cubes
+	Cover cover{};
+
+	// Number of cubes in the cover, that contain an input value
+	std::vector<uint8_t> coverCount{};
+	std::unordered_map<CubeTermType, uint> coverCountOverflow{};
+	// Same layout as the truth table. Input values covered by at least one and by at least two cubes
+	TruthTableWordStream coveredOnce{};
+	TruthTableWordStream coveredTwice{};
+};
+
+
+#endif
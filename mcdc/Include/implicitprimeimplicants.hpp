@@ -0,0 +1,152 @@
+// --------------------------------------------------------------------------------------------------------------------------------
+// License:	BSD-3-Clause
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Copyright 2019      Armin Montigny
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+// following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the 
+//    following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the 
+//    following disclaimer in the documentation and /or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or 
+//    promote products derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+
+
+#pragma once
+#ifndef IMPLICITPRIMEIMPLICANTS_HPP
+#define IMPLICITPRIMEIMPLICANTS_HPP
+
+//
+// Calculation of prime implicants directly from the boolean expression. Without truth table
+//
+// The normal way is: Evaluate the boolean expression for all 2^n input values, store the minterms in
+// the truth table and then find the prime implicants with the Quine&  McCluskey method.
+// For decisions with many conditions, but only a few product terms, this is a huge waste of time.
+//
+// Here the object code of the compiler is "executed" symbolically. Every machine register holds a list of
+// cubes (product terms) instead of a boolean value. The cubes are stored like prime implicants, with a term and
+// a mask for the eliminated variables.
+//
+// LOAD:	One cube with one literal
+// OR:		Union of the 2 cube lists
+// AND:		Intersection of all pairs of cubes
+// NOT:		Complement with the Shannon expansion. Split on a variable, complement both cofactors and combine them
+// XOR:		a^b = a!b + !ab
+//
+// After each operation, cubes that are contained in other cubes are removed (absorption law).
+//
+// The result is a disjunctive normal form of the boolean expression. All prime implicants are then calculated
+// with the method of Tison. For every variable, all consensus terms for this variable are added and all
+// contained cubes are removed. After one run over all variables, the cube list contains exactly the prime implicants.
+//
+// Consensus: The cubes xA and !xB have the consensus AB (if AB is not empty).
+//
+// For the minimum DNF, a cover is selected from the prime implicants. First the essential prime implicants,
+// then prime implicants with few literals. A prime implicant is not needed, if it is covered by the other ones.
+// This is checked with a recursive tautology check of the cofactors. Also here, no truth table is needed.
+// The result is an irredundant cover, but not guaranteed to be a minimum.
+//
+// Some boolean expressions (for example long XOR chains) have an exponential number of cubes. If the cube lists
+// become too big, the calculation is stopped and the normal way with the truth table is used.
+//
+// The implicit calculation is used with the command line option -ipi or automatically for big boolean expressions
+
+
+#include "types.hpp"
+#include "codegenerator.hpp"
+#include "symboltable.hpp"
+#include "quinemccluskey.hpp"
+
+#include <string>
+#include <vector>
+
+
+class ImplicitPrimeImplicants
+{
+public:
+	ImplicitPrimeImplicants() = default;
+	ImplicitPrimeImplicants(const ImplicitPrimeImplicants&) = delete;
+	ImplicitPrimeImplicants& operator =(const ImplicitPrimeImplicants&) = delete;
+
+	// Calculate the prime implicants from the object code of the compiler. Returns false, if the cube lists got too big
+	bool calculate(ObjectCode objectCode);
+
+	// Use the result of calculate
+	uint getNumberOfPrimeImplicants() const noexcept { return narrow_cast<uint>(primeImplicant.size()); }
+	// Boolean expression is always false
+	bool isContradiction() const noexcept { return primeImplicant.empty(); }
+	// Boolean expression is always true. Then the only prime implicant is the cube without literals
+	bool isTautology() const noexcept { return (1U == primeImplicant.size()) && (allVariables == primeImplicant.front().mask); }
+
+	// Select a cover from the prime implicants. Same result format as for the Quine&  McCluskey method
+	std::string getMinimumDisjunctiveNormalForm(const SymbolTable& symbolTable, const std::string& source);
+	// All prime implicants as strings
+	std::vector<std::string> getPrimeImplicants(const SymbolTable& symbolTable) const;
+
+	// Without the command line option, the implicit calculation will be tried for more than this number of variables
+	static constexpr uint MaxNumberOfVariablesForTruthTable{ 16U };
+	static bool isSelectedFor(uint numberOfVariables) noexcept;
+
+protected:
+	// Same representation as a prime implicant. Term and mask for the eliminated variables
+	// The bits of eliminated variables are always 0 in the term
+	using CubeTermType = uint32_t;
+	using Cube = PrimeImplicantType<CubeTermType>;
+	using Cover = std::vector<Cube>;
+
+	// Stop, if a cube list gets bigger than this
+	static constexpr std::size_t MaxNumberOfCubes{ 1U << 13 };
+
+	// The operations of the virtual machine on cube lists
+	Cover literal(CubeTermType variable, bool negated) const;
+	Cover unionOf(const Cover& lhs, const Cover& rhs);
+	Cover intersectionOf(const Cover& lhs, const Cover& rhs);
+	Cover complementOf(const Cover& cover);
+
+	// Remove all cubes, that are contained in another cube
+	static Cover absorb(Cover cover);
+	// Cofactor for a variable with value 0 or 1. The variable is eliminated from the remaining cubes
+	static Cover cofactorOf(const Cover& cover, CubeTermType variable, bool value);
+	// Variable, that is used in the most cubes. Variables in both polarities are preferred. 0 if there is none
+	CubeTermType splittingVariable(const Cover& cover, bool binateOnly) const;
+
+	// All prime implicants with the method of Tison
+	void calculatePrimeImplicants(Cover cover);
+
+	// Check, if the cover is always true
+	bool isTautologyCover(const Cover& cover) const;
+	// Check, if the cube is completely contained in the union of the cubes of the cover
+	bool isCoveredBy(const Cube& cube, const Cover& cover) const;
+
+	// Number of literals in a cube
+	uint numberOfLiterals(const Cube& cube) const noexcept { return numberOfVariables - narrow_cast<uint>(numberOfSetBits(cube.mask)); }
+
+	uint numberOfVariables{ 0U };
+	// All bits for variables of the boolean expression. A cube with this mask is always true
+	CubeTermType allVariables{ 0U };
+	// A cube list was bigger than the limit
+	bool cubeLimitExceeded{ false };
+
+	// Resulting prime implicants
+	Cover primeImplicant{};
+};
+
+
+#endif
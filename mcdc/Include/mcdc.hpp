@@ -171,12 +171,25 @@ struct McdcIndependencePair
 class Mcdc
 {
 public:
+	// The brute force search stores 2^n evaluated ASTs and compares all 2^(2n-1) test pairs. This is only done for
+	// boolean expressions with up to this number of conditions. More conditions need option -forcemcdc
+	static constexpr uint MaxNumberOfConditionsForMcdc{ 16U };
+	// Check the number of conditions. If the search for test pairs is skipped, then a message is shown
+	static bool isSelectedFor(uint numberOfConditions);
+
 	// Brute force search for MCDC test pairs
 	void findMcdcIndependencePairs(VirtualMachineForAST& ast);
 
 	// Select the test set as a result of the brute force search
 	void generateTestSets();
 
+	// One or more test sets. A test set is a set of test values
+	using TestSets = std::set<std::set<uint>>;
+	// The test sets selected by generateTestSets
+	const TestSets& getTestSets() const noexcept { return resultingTestSets; }
+	// Show test sets, that have been calculated before (result cache), without searching for test pairs
+	void printTestSets(VirtualMachineForAST& ast, const TestSets& allTestSets);
+
 protected:
 
 	// SHort and understandable names for internal data structures
@@ -200,9 +213,15 @@ protected:
 
 
 	// Main worker horse
-	// Check if a Test pair is MCDC
+	// Check if a Test pair is MCDC. Does not use any member. So it can be called from many tasks in parallel
 	std::pair<McdcType, cchar> getMcdcType(AST& astInfluencingTree);
 
+	// The search for test pairs runs in the thread pool in blocks of outer test values
+	// A block has not more than this number of test pairs (memory for the results)
+	static constexpr uint MaxNumberOfTestPairsPerBlock{ 1U << 22 };
+	// And we want more tasks than threads, so that the thread pool can balance the load
+	static constexpr uint NumberOfOuterTestValuesPerThread{ 4U };
+
 
 	// Print evaluated and calculated "best" test sets
 	void printResult(const std::set<TestSet>& allTestSets, std::ostream& os);
@@ -255,6 +274,8 @@ protected:
 
 	// For output display purposes
 	VirtualMachineForAST astUsedForMcdcCalculation{};
+	// Result of generateTestSets
+	TestSets resultingTestSets{};
 };
 
 
@@ -62,6 +62,13 @@
 // This programm implements multithreading. But this is basically a meaningless approach
 // Even running on 8 threads, you can do 3 variables more. And then?
 // So, no further effort on runtime speed optimization
+//
+// Update: The virtual machine has now a bit sliced mode. 64 input values will be evaluated
+// in one run of the program. The result is a packed truth table (one bit per input value),
+// which is then converted to the minterm vector. This is more than an order of magnitude faster.
+//
+// Update: The result is now the packed truth table itself (see truthtable.hpp). It can be iterated like
+// a container of minterms, but needs only one bit per input value.
 // 
 // The resulting Mintermvector and the gathered Symbols will be used by other program
 // Parts for further evaluation.
@@ -70,6 +77,7 @@
 #include "compiler.hpp"
 #include "virtualmachine.hpp"
 #include "symboltable.hpp"
+#include "truthtable.hpp"
 
 
 
@@ -89,12 +97,16 @@ public:
 	MintermCalculator& operator =(const MintermCalculator&&) = delete;
 
 	// This function is made public, becuase we want to know, if the syntax of the boolean expression is OK.
-	bool runCompiler() { objectCode.clear(); compilerResultOK = compiler(); return compilerResultOK; }
-	// Calculate all minterms
-	MintermVector calculate();
+	bool runCompiler() { objectCode.clear(); compilerResultOK = compileAndOptimize(); return compilerResultOK; }
+	// Calculate the truth table. The set bits are the minterms
+	const TruthTable& calculate();
+	// The packed truth table, calculated by the last call to calculate(). Bit k of word w is the result for input w*64+k
+	const TruthTable& getTruthTable() const noexcept { return truthTable; }
 	
 	// Return the symbol table. Important to know the number of symbols and for print purposes
 	SymbolTable getSymbolTable() { return objectCode.symbolTable; }
+	// The object code from the compiler. Can be evaluated also without virtual machine
+	const ObjectCode& getObjectCode() const noexcept { return objectCode; }
 	uint getNumberOfBooleanVariables() noexcept { return numberOfBooleanVariables; }
 
 protected:
@@ -107,9 +119,17 @@ protected:
 
 	// Depending on available threads and number of variables, ranges can be calculated
 	MintermRangeVector calculateMintermRanges(uint numberOfRanges, uint upperBound);
+	// Ranges for the thread pool. A range has at least this number of truth table words (64 input values each)
+	static constexpr uint MinimumNumberOfWordsPerRange{ 64U };
+	// We want more ranges than threads, so that the thread pool can balance the load
+	static constexpr uint NumberOfRangesPerThread{ 4U };
 	
-	// This is the working horse. Run the virtual machine and calculate results
-	MintermVector calculateAsThread(MintermRange mt, ObjectCode objectCode);
+	// This is the working horse. Run the virtual machine in bit sliced mode and calculate results. Runs as a task in the thread pool
+	// The range is given in truth table words (blocks of 64 input values)
+	TruthTableWordStream calculateAsThread(MintermRange mt, ObjectCode objectCode);
+
+	// Run the compiler and then the optimizer for the object code (if not switched off with option -noopt)
+	bool compileAndOptimize();
 
 	// The resulting object code from the compiler
 	// This is the input for the loader of the virtual machine
@@ -123,6 +143,9 @@ protected:
 	// Number of varaibles in the boolean expression
 	uint numberOfBooleanVariables{ 0U };
 
+	// Packed result of the bit sliced virtual machine
+	TruthTable truthTable{};
+
 	// Result of compilation. If false, then the boolean expression has a syntax error
 	bool compilerResultOK{ false };
 
@@ -132,7 +155,7 @@ protected:
 };
 
 // Show the truth table on the basis of calculated Minterms and the Symboltable
-extern void printTruthTable(const std::string& source, MintermVector& mintermVector, const SymbolTable& symbolTable);
+extern void printTruthTable(const std::string& source, const TruthTable& truthTable, const SymbolTable& symbolTable);
 
 
 #endif
\ No newline at end of file
@@ -0,0 +1,117 @@
+// --------------------------------------------------------------------------------------------------------------------------------
+// License:	BSD-3-Clause
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Copyright 2019      Armin Montigny
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+// following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the 
+//    following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the 
+//    following disclaimer in the documentation and /or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or 
+//    promote products derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+
+
+#pragma once
+#ifndef MULTIOUTPUT_HPP
+#define MULTIOUTPUT_HPP
+
+//
+// Multi output minimization
+//
+// The guards of a state machine transition table are many boolean expressions with the same conditions.
+// If every guard is minimized on its own, then the same product term may be calculated again and again.
+// Here all boolean expressions are minimized together. A product term, that is used by more than one
+// boolean expression, is counted only once.
+//
+// The method is the Quine&  McCluskey method with output tags (see PrimeImplicantType):
+// - Every minterm gets a tag with one set bit for every boolean expression, for which it is a minterm
+// - 2 terms can be combined, if they differ in one variable and if they have at least one common output.
+//   The new term gets the common outputs as tag
+// - A term is only marked as combined, if the new term has the same tag. Otherwise the term is still
+//   needed for some of its outputs
+// - All not marked terms are the multi output prime implicants
+//
+// The prime implicant table has one row for every minterm of every boolean expression. A prime implicant
+// covers the rows of all outputs in its tag. So the coverage will prefer prime implicants, that can be 
+// shared between boolean expressions. Afterwards, for every single boolean expression, the not needed 
+// prime implicants are removed.
+//
+// All boolean expressions are evaluated for the same variables. These are all variables, that are used
+// in any of the boolean expressions. In the command line the boolean expressions are separated by ';' (option -mo)
+
+
+#include "types.hpp"
+#include "quinemccluskey.hpp"
+
+#include <string>
+#include <vector>
+#include <limits>
+#include <ostream>
+
+
+class MultiOutputQuineMcluskey
+{
+public:
+	MultiOutputQuineMcluskey() = default;
+	MultiOutputQuineMcluskey(const MultiOutputQuineMcluskey&) = delete;
+	MultiOutputQuineMcluskey& operator =(const MultiOutputQuineMcluskey&) = delete;
+
+	// Minimize all boolean expressions together. All truth tables must be calculated for the given symbol table
+	// Returns a minimum DNF for every boolean expression
+	std::vector<std::string> getMinimumDisjunctiveNormalForms(const std::vector<TruthTable>& truthTable, const SymbolTable& symbolTable);
+
+	// Number of different product terms in all resulting DNFs
+	uint getNumberOfProductTerms() const noexcept { return narrow_cast<uint>(selectedPrimeImplicant.size()); }
+
+	// There is one bit in the output tag for every boolean expression
+	static constexpr uint MaxNumberOfOutputs{ narrow_cast<uint>(std::numeric_limits<OutputTagType>::digits) };
+
+protected:
+	using TermType = uint32_t;
+	using PrimeImplicant = PrimeImplicantType<TermType>;
+	using PrimeImplicantVector = std::vector<PrimeImplicant>;
+	static_assert(MaxNumberOfBitsForEvaluation <= std::numeric_limits<TermType>::digits, "Term type too small");
+
+	// Quine&  McCluskey method with output tags
+	void calculatePrimeImplicants(const std::vector<TruthTable>& truthTable);
+	// Solve the coverage problem for all outputs together
+	void selectPrimeImplicants(const std::vector<TruthTable>& truthTable, const SymbolTable& symbolTable, std::ostream& os);
+	// The selected prime implicants, that are really needed for one output, as DNF
+	std::string getMinimumDisjunctiveNormalFormForOutput(uint output, const SymbolTable& symbolTable) const;
+
+	uint numberOfLiterals(const PrimeImplicant& primeImplicant) const noexcept { return numberOfVariables - narrow_cast<uint>(numberOfSetBits(primeImplicant.mask)); }
+	static bool isCoveredBy(TermType minterm, const PrimeImplicant& primeImplicant) noexcept { return (minterm & ~primeImplicant.mask) == primeImplicant.term; }
+
+	uint numberOfVariables{ 0U };
+	// All bits for variables of the boolean expressions
+	TermType allVariables{ 0U };
+	// All multi output prime implicants
+	PrimeImplicantVector primeImplicant{};
+	// The result of the coverage
+	PrimeImplicantVector selectedPrimeImplicant{};
+};
+
+
+// Split the given boolean expressions (separated by ';'), minimize them together and calculate the MCDC test sets for each
+void evaluateMultipleOutputs(const std::string& booleanExpressions);
+
+
+#endif
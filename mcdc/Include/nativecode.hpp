@@ -0,0 +1,112 @@
+// --------------------------------------------------------------------------------------------------------------------------------
+// License:	BSD-3-Clause
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Copyright 2019      Armin Montigny
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+// following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the 
+//    following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the 
+//    following disclaimer in the documentation and /or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or 
+//    promote products derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+
+
+#pragma once
+#ifndef NATIVECODE_HPP
+#define NATIVECODE_HPP
+
+//
+// Native code for boolean expressions (JIT Compiler)
+//
+// The byte code of the virtual machine is translated into x86-64 machine code. The machine code
+// is written into an executable memory page and can then be called like a normal function:
+//
+//		bool function(uint32_t inputValue)
+//
+// Machine registers of the virtual machine are mapped to CPU registers. Only if there are more machine
+// registers than available CPU registers, the rest will be stored on the stack.
+//
+// On other architectures or if no executable memory can be allocated, nothing will be compiled and
+// the caller must use the interpreter. Please check with "isAvailable()"
+
+
+#include "types.hpp"
+#include "bytecode.hpp"
+
+#include <cstdint>
+#include <cstddef>
+
+// Native code can only be generated for x86-64
+#if defined(_M_X64) || defined(__x86_64__)
+#define MCDC_NATIVE_CODE_X86_64
+#endif
+
+// Check at compile time, if native code can be generated for this architecture
+constexpr bool nativeCodeIsSupported() noexcept
+{
+#if defined(MCDC_NATIVE_CODE_X86_64)
+	return true;
+#else
+	return false;
+#endif
+}
+
+
+class NativeCodeForBooleanExpressions
+{
+public:
+	// Signature of the generated function
+	using NativeFunction = bool(*)(uint32_t);
+
+	NativeCodeForBooleanExpressions() noexcept {}
+	NativeCodeForBooleanExpressions(const NativeCodeForBooleanExpressions&) = delete;
+	NativeCodeForBooleanExpressions(NativeCodeForBooleanExpressions&&) = delete;
+	NativeCodeForBooleanExpressions& operator =(const NativeCodeForBooleanExpressions&) = delete;
+	NativeCodeForBooleanExpressions& operator =(NativeCodeForBooleanExpressions&&) = delete;
+	~NativeCodeForBooleanExpressions() noexcept { release(); }
+
+	// Translate the byte code to machine code. Returns false, if that is not possible on this machine
+	bool compile(const ByteCodeProgram& byteCodeProgram, uint numberOfMachineRegisters);
+
+	// Check, if native code could be generated
+	bool isAvailable() const noexcept { return nullptr != nativeFunction; }
+	// Get the generated function. nullptr if not available
+	NativeFunction getFunction() const noexcept { return nativeFunction; }
+	// Call the generated function. Must only be used, if isAvailable() is true
+	bool operator()(uint32_t inputValue) const { return nativeFunction(inputValue); }
+
+	// Size of the generated machine code in bytes
+	std::size_t codeSize() const noexcept { return nativeCodeSize; }
+
+protected:
+	// Free the executable memory
+	void release() noexcept;
+
+	// The executable memory page(s) with the machine code
+	void* executableMemory{ nullptr };
+	std::size_t executableMemorySize{ 0U };
+	std::size_t nativeCodeSize{ 0U };
+	// Pointer to the start of the machine code
+	NativeFunction nativeFunction{ nullptr };
+};
+
+
+#endif
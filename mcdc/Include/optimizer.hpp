@@ -0,0 +1,106 @@
+// --------------------------------------------------------------------------------------------------------------------------------
+// License:	BSD-3-Clause
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Copyright 2019      Armin Montigny
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+// following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the 
+//    following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the 
+//    following disclaimer in the documentation and /or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or 
+//    promote products derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+
+
+#pragma once
+#ifndef OPTIMIZER_HPP
+#define OPTIMIZER_HPP
+
+//
+// Optimizer for the object code of the virtual machine
+//
+// The code generator creates straight line code without any optimization. So a variable will be loaded
+// several times, double negations are in the code and identical sub expressions will be calculated again.
+// The optimizer runs after the compiler and before the loader of the virtual machine. It does:
+//
+// - Common sub expression elimination. Every operation gets a value number. Identical operations 
+//   with identical operands (also swapped operands for the commutative OR, XOR, AND) result in the same value
+// - NOT folding. NOT(NOT x) --> x,  NOT(L a) --> LN a,  NOT(LN a) --> L a. And also: x AND x --> x, x OR x --> x
+// - Dead register elimination. Only values that are needed for the result will be generated
+// - Register coalescing. New register allocation. A register is free after the last use of its value.
+//   The destination of an operation may be one of its source registers
+//
+// The result is equivalent object code with the same symbol table
+
+
+#include "types.hpp"
+#include "codegenerator.hpp"
+
+#include <map>
+#include <tuple>
+#include <vector>
+
+
+class OptimizerForVM
+{
+public:
+	explicit OptimizerForVM(ObjectCode& objectCodeToOptimize) noexcept : objectCode(objectCodeToOptimize) {}
+	OptimizerForVM() = delete;
+	OptimizerForVM(const OptimizerForVM&) = delete;
+	OptimizerForVM(const OptimizerForVM&&) = delete;
+	OptimizerForVM& operator =(const OptimizerForVM&) = delete;
+	OptimizerForVM& operator =(const OptimizerForVM&&) = delete;
+
+	// Optimize the object code. The object code will be replaced by the optimized version
+	void optimize();
+
+	// Some statistics
+	uint getNumberOfOpCodesBefore() const noexcept { return numberOfOpCodesBefore; }
+	uint getNumberOfOpCodesAfter() const noexcept { return numberOfOpCodesAfter; }
+
+protected:
+	// One value in the program. The result of an operation. For ID and IDNOT the operand is the index of the variable
+	// For all other operations, the operands are value numbers
+	struct Value
+	{
+		Token operation{ Token::NONE };
+		uint operand1{ 0U };
+		uint operand2{ 0U };
+	};
+
+	// Get the number for a value. If the same value was already calculated, its number will be returned (CSE)
+	uint getValueNumber(Token operation, uint operand1, uint operand2);
+	// Get the number for the negated value. With folding of NOT operations
+	uint getNegatedValueNumber(uint valueNumber);
+
+	// Object code that will be optimized
+	ObjectCode& objectCode;
+
+	// All values in the program, in the order of their calculation
+	std::vector<Value> value;
+	// Lookup table for common sub expression elimination
+	std::map<std::tuple<Token, uint, uint>, uint> valueNumberForOperation;
+
+	uint numberOfOpCodesBefore{ 0U };
+	uint numberOfOpCodesAfter{ 0U };
+};
+
+
+#endif
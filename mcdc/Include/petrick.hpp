@@ -101,18 +101,60 @@
 // for identical product terms. They will also not be allowed by using a stl::set
 //
 // The whole complicated algroithm can so be implemented with only a very few lines of code.
+//
+// Update: The sets of sets grow very fast and the absorption law (X + XY = X) was not applied. So the intermediate
+// DNFs were full of product terms, that can never be a minimum result. Now
+// - a product term is a bitset with one bit per variable. All product terms of one calculation have the same width
+// - after every multiplication of a clause, all product terms, that contain another product term, are removed (absorption)
+// - the clauses are multiplied in the order of their size. Small clauses first. So the DNF grows slowly
+// - a greedy cover gives an upper bound for the size of the minimum product terms. Longer product terms are removed
+// The result is the same: All product terms with the minimum number of variables
+//
+// Update: With option -petricktree the clauses are not multiplied one after the other, but in a balanced tree.
+// (C1 C2 C3 C4) = (C1 C2)(C3 C4). The multiplication is associative. So both halves are calculated independently,
+// the first half in another task of the thread pool. Every sub product is reduced by absorption and the upper bound
+// before it is merged. Big merges are split in blocks of product terms and also calculated in parallel
 
  
 
 #include "types.hpp"
+#include "dynamicbitset.hpp"
+
+#include <vector>
 
 
 class PetricksMethod
 {
 public:
+	// multiplyInParallel: Multiply the clauses in a balanced tree on the thread pool (option -petricktree)
+	explicit PetricksMethod(bool multiplyInParallel = false) noexcept : multiplyInParallel(multiplyInParallel) {}
+
 	// Functors operator
 	ProductTermVector operator()(const CNF& cnf);
 protected:
+	// Ranges with less clauses are multiplied sequentially in one task
+	static constexpr std::size_t MinimumNumberOfClausesPerTask{ 4U };
+	// Merges with less product terms on the left side are not split in blocks
+	static constexpr std::size_t MinimumNumberOfProductTermsPerBlock{ 256U };
+
+	const bool multiplyInParallel;
+
+	// A product term as bitset and a DNF as vector of such product terms
+	using BitProductTerm = DynamicBitset;
+	using BitDNF = std::vector<BitProductTerm>;
+
+	// Multiply a DNF with a clause of the CNF (distributive law)
+	static BitDNF multiply(const BitDNF& dnf, const BitDNF& clause);
+	// Remove double product terms, product terms longer than upperBound and product terms, that contain another product term
+	static void applyAbsorption(BitDNF& dnf, std::size_t upperBound);
+	// Multiply the clauses [first, last) one after the other
+	static BitDNF multiplySequential(const std::vector<BitDNF>& clause, std::size_t first, std::size_t last, std::size_t upperBound);
+	// Multiply the clauses [first, last) in a balanced tree. Sub products are calculated in parallel
+	static BitDNF multiplyTree(const std::vector<BitDNF>& clause, std::size_t first, std::size_t last, std::size_t upperBound);
+	// Multiply 2 sub products. Blocks of the left side are multiplied in parallel
+	static BitDNF multiplyParallel(const BitDNF& left, const BitDNF& right, std::size_t upperBound);
+	// Number of variables in a greedy selected product term, that satisfies all clauses
+	static std::size_t calculateUpperBound(const std::vector<BitDNF>& clause);
 };
 
 #endif // !PETRIC_HPP
@@ -91,13 +91,27 @@
 // (Prime implancts that are always needed to make the boolean expression true), or
 // try to find a minimum covergae set of prime implicants that make the boolean 
 // expression true.
+//
+// Term width
+//
+// Minterms and masks are stored in unsigned integers with one bit per boolean variable.
+// The narrower the integer, the smaller the reduction tables and the faster the comparisons.
+// So the complete algorithm is implemented as a template on the term type and is instantiated
+// for 16, 32 and 64 bit terms. The class QuineMcluskey selects the narrowest term width
+// that can hold all variables of the boolean expression at runtime.
+// Small decisions with up to 16 conditions use the 16 bit version.
 
 
 
 #include "types.hpp"
 #include "symboltable.hpp"
+#include "truthtable.hpp"
 #include "coverage.hpp"
 
+#include <limits>
+#include <string>
+#include <algorithm>
+
 
 
 // Prime Implicant
@@ -114,84 +128,153 @@
 // in the Prime implicant entry. 
 // If you want to show / print the prime implicant you nust use the information from the
 // symbol table. The mask will only contain set bits for existing variables. 
+//
+// If several boolean expressions are minimized together (multi output minimization, see multioutput.hpp),
+// then a prime implicant can be used for more than one boolean expression. The output tag has a set bit
+// for every boolean expression, for which the prime implicant is an implicant. For one boolean expression it is not used (0)
+using OutputTagType = uint32_t;
+
+template <typename TermType>
 struct PrimeImplicantType
 {
-	MinTermType term;	// Minterm
-	MinTermType mask;	// Position od deleted variables
+	TermType term;	// Minterm
+	TermType mask;	// Position od deleted variables
+	OutputTagType outputTag;	// Bit k: Implicant of boolean expression k. Only for multi output minimization
 
 	// Creation of Prime Implicants
-	PrimeImplicantType() noexcept : term(null<MinTermType>()), mask(null<MinTermType>()) {}
-	PrimeImplicantType(MinTermType t, MinTermType m) noexcept : term(t), mask(m) {}
+	PrimeImplicantType() noexcept : term(null<TermType>()), mask(null<TermType>()), outputTag(0U) {}
+	PrimeImplicantType(TermType t, TermType m) noexcept : term(t), mask(m), outputTag(0U) {}
+	PrimeImplicantType(TermType t, TermType m, OutputTagType ot) noexcept : term(t), mask(m), outputTag(ot) {}
 
 	// Conevrt Prime Implicant to a string. Use symbol table as described above
 	std::string toString(const SymbolTable& symbolTable) const;
 };
 
 // The prime imlicants will be stored in a std::set. This needs a compare function. Here we define the Functor for it
+template <typename TermType>
 struct PrimeImplicantTypeCompare
 {
-	bool operator() (const PrimeImplicantType& lhs, const PrimeImplicantType& rhs) const noexcept
+	bool operator() (const PrimeImplicantType<TermType>& lhs, const PrimeImplicantType<TermType>& rhs) const noexcept
 	{
-		return ((lhs.term < rhs.term) || ((lhs.term == rhs.term) && (lhs.mask < rhs.mask)));
+		return ((lhs.term < rhs.term) || ((lhs.term == rhs.term) && ((lhs.mask < rhs.mask) || ((lhs.mask == rhs.mask) && (lhs.outputTag < rhs.outputTag)))));
 	}
 };
 
 // Type Definition. Set of Prime Implicants. In such a set all found prime implicants can be stored
-using PrimeImplicantSet = std::set<PrimeImplicantType, PrimeImplicantTypeCompare>;
+template <typename TermType>
+using PrimeImplicantSet = std::set<PrimeImplicantType<TermType>, PrimeImplicantTypeCompare<TermType>>;
 
 
 
 
 
 
-// Implementation of the Quine and McCluskey method
-class QuineMcluskey
+// Implementation of the Quine and McCluskey method for one term width
+// TermType is an unsigned integer with one bit per boolean variable. See explanation above
+template <typename TermType>
+class QuineMcluskeyForTermWidth
 {
+	static_assert(std::is_unsigned<TermType>::value, "Term type must be an unsigned integer");
+
 public:
-	QuineMcluskey();
-	
-	std::string getMinimumDisjunctiveNormalForm(MintermVector& mv, const SymbolTable& symbolTable, const std::string& source);
+	explicit QuineMcluskeyForTermWidth(bool processLowerAndUpperMintermOnlyForTable) noexcept : processLowerAndUpperMintermOnly(processLowerAndUpperMintermOnlyForTable) {}
+	QuineMcluskeyForTermWidth() = delete;
+
+	std::string getMinimumDisjunctiveNormalForm(const TruthTable& truthTable, const SymbolTable& symbolTable, const std::string& source);
+	// All prime implicants found by the last call to getMinimumDisjunctiveNormalForm, as strings
+	std::vector<std::string> getPrimeImplicants(const SymbolTable& symbolTable) const;
+
+	// Maximum number of boolean variables that fit into the term type
+	static constexpr uint MaxNumberOfBooleanVariables{ narrow_cast<uint>(std::numeric_limits<TermType>::digits) };
 
 protected:
 
+	// The source minterms for printout purposes
+	using MintermSetForTermWidth = std::set<TermType>;
+
 	// One row in a reduction table (for one bit count and one reuction loop)
 	struct TableEntry
 	{
-		MinTermType mintermLower;	// The minterm and a the same time the minterm range for 2 combined minterms
-		MinTermType mintermUpper;	// Upper part for 2 combined minterms
-		MinTermType maskForEliminatedBit;	// What bits (in minterm lower) have beem eliminated by implication method
-		mutable bool matchFound;	// QM algorithm tries to apply implication law. If 2 fittings terms are found, they will be marked
+		TermType mintermLower;	// The minterm and a the same time the minterm range for 2 combined minterms
+		TermType mintermUpper;	// Upper part for 2 combined minterms
+		TermType maskForEliminatedBit;	// What bits (in minterm lower) have beem eliminated by implication method
+		bool matchFound;	// QM algorithm tries to apply implication law. If 2 fittings terms are found, they will be marked
 
 		// As described above. We are using an optimzed method for showing the source of absobed minterms
 		// We can show all minterms (based on program options, and which is not needed for functionality)
-		MintermSet matchedMinterm; // List of all source minterms. Functionality wise, only the upper and the lower are needed
+		MintermSetForTermWidth matchedMinterm; // List of all source minterms. Functionality wise, only the upper and the lower are needed
 
 		// Selection of constructors
-		TableEntry(MinTermType mtl, MinTermType mtu, MinTermType mfe) : mintermLower(mtl), mintermUpper(mtu), maskForEliminatedBit(mfe), matchFound(false), matchedMinterm() {}
-		TableEntry(MinTermType mtl, MinTermType mtu, MinTermType mfe, MintermSet& ms) : mintermLower(mtl), mintermUpper(mtu), maskForEliminatedBit(mfe), matchFound(false), matchedMinterm(ms) {}
-		TableEntry(MinTermType mtl, MinTermType mtu, MinTermType mfe, MintermSet &&ms) : mintermLower(mtl), mintermUpper(mtu), maskForEliminatedBit(mfe), matchFound(false), matchedMinterm(ms) {}
+		TableEntry(TermType mtl, TermType mtu, TermType mfe) : mintermLower(mtl), mintermUpper(mtu), maskForEliminatedBit(mfe), matchFound(false), matchedMinterm() {}
+		TableEntry(TermType mtl, TermType mtu, TermType mfe, MintermSetForTermWidth& ms) : mintermLower(mtl), mintermUpper(mtu), maskForEliminatedBit(mfe), matchFound(false), matchedMinterm(ms) {}
+		TableEntry(TermType mtl, TermType mtu, TermType mfe, MintermSetForTermWidth &&ms) : mintermLower(mtl), mintermUpper(mtu), maskForEliminatedBit(mfe), matchFound(false), matchedMinterm(ms) {}
 		TableEntry() noexcept : mintermLower(0U), mintermUpper(0U), maskForEliminatedBit(0U), matchFound(false), matchedMinterm() {}
 
 		// for std::unique function
 		bool operator == (const TableEntry& other) const noexcept { return (maskForEliminatedBit == other.maskForEliminatedBit) && (mintermLower == other.mintermLower) && (mintermUpper == other.mintermUpper); }
 	};
 
-	// Functor for sorting TableEntry in a vector
+	// Functor for sorting TableEntry in a vector. Rows with the same mask will be consecutive
+	// mintermUpper is always mintermLower | maskForEliminatedBit. So it need not to be compared
 	struct TableEntryCompare
 	{
-		bool operator() (const TableEntry& lhs, const TableEntry& rhs) noexcept
+		bool operator() (const TableEntry& lhs, const TableEntry& rhs) const noexcept
 		{
-			return (lhs.mintermLower < rhs.mintermLower) || ((lhs.mintermLower == rhs.mintermLower) && (lhs.mintermUpper < rhs.mintermUpper));
+			return (lhs.maskForEliminatedBit < rhs.maskForEliminatedBit) || ((lhs.maskForEliminatedBit == rhs.maskForEliminatedBit) && (lhs.mintermLower < rhs.mintermLower));
 		}
 	};
 
 	// We group rows of TableEntrys by bit counts
-	using TableForBitCount = std::vector<TableEntry>;
+	// Rows with a different mask can never be combined. So the rows of one bit count are additionally
+	// grouped in buckets with the same mask. The rows are sorted by mask and term and stored in one flat vector
+	// An offset table notes, where a bucket starts. Comparisons are only done between buckets with the same mask
+	struct TableForBitCount
+	{
+		// All rows. Sorted by mask and term
+		std::vector<TableEntry> row{};
+		// Bucket b consists of the rows bucketStart[b] ... bucketStart[b+1]-1. The last element is the number of rows
+		std::vector<uint> bucketStart{};
+
+		uint size() const noexcept { return narrow_cast<uint>(row.size()); }
+		uint numberOfBuckets() const noexcept { return bucketStart.empty() ? 0U : narrow_cast<uint>(bucketStart.size() - 1U); }
+		TermType maskOfBucket(uint bucket) const { return row[bucketStart[bucket]].maskForEliminatedBit; }
+
+		// Sort the rows, erase duplicates and build the offset table
+		void sortAndBuildBuckets()
+		{
+			std::sort(row.begin(), row.end(), TableEntryCompare());
+			row.erase(std::unique(row.begin(), row.end()), row.end());
+			bucketStart.clear();
+			for (uint r = 0U; r < size(); ++r)
+			{
+				if ((0U == r) || (row[r].maskForEliminatedBit != row[r - 1U].maskForEliminatedBit))
+				{
+					bucketStart.push_back(r);
+				}
+			}
+			bucketStart.push_back(size());
+		}
+
+		// Find the bucket with the given mask. Returns the number of buckets, if there is none
+		uint findBucket(TermType mask) const
+		{
+			uint result{ numberOfBuckets() };
+			const std::vector<uint>::const_iterator bucketEnd{ bucketStart.begin() + result };
+			const std::vector<uint>::const_iterator bucket{ std::lower_bound(bucketStart.begin(), bucketEnd, mask, [this](uint start, TermType m) { return row[start].maskForEliminatedBit < m; }) };
+			if ((bucketEnd != bucket) && (mask == row[*bucket].maskForEliminatedBit))
+			{
+				result = narrow_cast<uint>(bucket - bucketStart.begin());
+			}
+			return result;
+		}
+	};
 
 
 	// Tried "set" and "unordered_set", but "vector" with "sort" and "unique" is fastest solution
 	// And there are many (up to number of variables) tables with TableEntry per bit count
+	// A term can have 0 ... MaxNumberOfBooleanVariables set bits
 	using BitsAndMinTerms = std::vector<TableForBitCount>;
+	static constexpr uint NumberOfTablesForBitCount{ MaxNumberOfBooleanVariables + 1U };
 	// And for each reduction stage there is a table of the above tables
 	using ReductionTable = std::vector<BitsAndMinTerms>;
 
@@ -203,21 +286,17 @@ protected:
 
 	// Multi reduction stages reduction tables
 	ReductionTable reductionTable;
+	// Keep all stages for the printout. Otherwise only the current and the next stage need memory
+	bool retainReductionTables{ true };
 	// Resulting prime implicants
-	PrimeImplicantSet primeImplicantSetResult;
+	PrimeImplicantSet<TermType> primeImplicantSetResult;
 
 
 	// Take a list with all minterms and fill initial table. Grouped by number of bits for each minterm entry
-	void initiate(MintermVector& mv);
+	void initiate(const TruthTable& truthTable);
 	// Find the prime implicants. Reduce boolean expression
 	void reduce();
 
-	// Compare all elements of 2 tables with several TableEntrys (rows). One table with bitcount u and the other table with bitcount l (=u-1)
-	void compareTwoEntries(TableForBitCount& upper, TableForBitCount& lower, TableForBitCount& output);
-
-	// Compare a range of tables with each 2 tables with all elements of 2 tables with several TableEntrys (rows). One table with bitcount u and the other table with bitcount l (=u-1)
-	void compareFromBitCountUpperToBitCountLower(uint indexReductionTableColumn, uint IndexUpper, uint IndexLower);
-
 	// Check if we found all primeimplcants or if there are tables where we still need to do comparisons
 	bool checkIfFurtherEvaluationNecessary(uint indexReductionTableColumn);
 
@@ -228,31 +307,83 @@ protected:
 
 	// After a reduction round (Apllying the implication law
 	void collectPrimeImplicants(uint indexReductionTableColumn);
+	// Free the rows of a stage, that is no longer needed
+	void releaseReductionTable(uint indexReductionTableColumn);
 
-	void initializeCoverageForPrimeImplicants(Coverage& coverageForPrimeImplicants, MintermVector& mv, const SymbolTable& symbolTable);
+	void initializeCoverageForPrimeImplicants(Coverage& coverageForPrimeImplicants, const TruthTable& truthTable, const SymbolTable& symbolTable);
 
 
 
 	// Since programm runtime grows geometrically with the number of variables, we will use
-	// multi threading to reduce the calculation time
+	// the thread pool to reduce the calculation time
 	// Quine&  McCluskey reduction works on presorted tables. Presorted by number of bits in the minterms.
 	// SInce we want to apply the absorption law, we compare Minterm entries which just on different
 	// Setting of a varibale. On positive and one negated.
-	// We can use multi threading to calculate different blocks of Mintemrs with specific number of set bits
-	// So a bit count range is for example 0 through 4
-	using BitCountRange = std::pair<uint, uint>;
-
-	// A bit count range vector stores all bit counts for all minterms for the whole expression
-	// No overlap. NUmber of bits for the minterms of a boolean expression follow the standard binomial distribution
-	// We try to follow this approach. For 14 varaibles we will get the following BitCountRanges for 
-	// a system iwth 8 threads:  
-	// 1,3   3,5   5,6   6,7   7,8   8,9   9,11   11,14 
-	// This will help to speed up operations
-	using BitCountRangeVector = std::vector<BitCountRange>;
-	BitCountRangeVector calculateBoundsForMultiThreading(uint upper, uint lower);
+	// Every bucket (same bit count u and same mask) is an independent unit of work. Its partners can only
+	// be in the bucket with the same mask in the table with bit count u-1. So one task searches partners
+	// for the rows of one bucket. Big buckets are split into blocks of rows
+	// A row of the table with bit count u-1 is searched by the tasks for bit count u and it is itself in a block
+	// of a task for bit count u-1. So tasks never write to the tables. Each task writes only to its own result and
+	// marks found matches in its own bitmaps. After all tasks are done, the bitmaps are merged into the tables in the
+	// order of the tasks. So the result is always the same, independent of the number of threads
+	struct ComparisonTask
+	{
+		uint indexUpper;		// Bit count of the upper table
+		uint firstRowUpper;		// Block of rows in one bucket of the upper table
+		uint lastRowUpper;
+		uint firstRowLower;		// Bucket with the same mask in the lower table
+		uint lastRowLower;
+		std::vector<TableEntry> output;	// Result of this task. Will be merged into the next reduction table
+		std::vector<bool> matchFoundUpper;	// Marks for the rows firstRowUpper ... lastRowUpper-1
+		std::vector<bool> matchFoundLower;	// Marks for the rows firstRowLower ... lastRowLower-1
+		ull numberOfComparisons;	// Number of searched partners. For option -stats
+	};
+	// Compare the block of rows of the task in the table with bit count u with the bucket in the table with bitcount u-1
+	// The combined terms will be appended to the output of the task. Matches are marked in the bitmaps of the task
+	void compareTwoEntries(const TableForBitCount& upper, const TableForBitCount& lower, ComparisonTask& comparisonTask);
+	// After all tasks are done: Mark the rows, for which a match has been found
+	void mergeMatchFound(uint indexReductionTableColumn, const ComparisonTask& comparisonTask);
+	// A task should work on at least this number of rows
+	static constexpr uint MinimumNumberOfRowsPerTask{ 1U << 10 };
 
 	// Print the calculated reduction tables. SOurce is only for output purposes. Source is not needed for any calculation
-	void printReductionTable(const SymbolTable& symbolTable, const std::string& source);
+	void printReductionTable(std::ostream& os, const SymbolTable& symbolTable, const std::string& source);
+};
+
+// These term widths are instantiated in quinemccluskey.cpp
+extern template struct PrimeImplicantType<uint16_t>;
+extern template struct PrimeImplicantType<uint32_t>;
+extern template struct PrimeImplicantType<uint64_t>;
+extern template class QuineMcluskeyForTermWidth<uint16_t>;
+extern template class QuineMcluskeyForTermWidth<uint32_t>;
+extern template class QuineMcluskeyForTermWidth<uint64_t>;
+
+
+
+// Implementation of the Quine and McCluskey method
+// Selects the narrowest term width for the number of variables in the symbol table
+// and delegates the work to the corresponding QuineMcluskeyForTermWidth
+// For big boolean expressions, or if selected with -espresso, the heuristic method is used instead (see espresso.hpp)
+class QuineMcluskey
+{
+public:
+	QuineMcluskey();
+
+	std::string getMinimumDisjunctiveNormalForm(const TruthTable& truthTable, const SymbolTable& symbolTable, const std::string& source);
+	// The prime implicants of the last minimization. For the heuristic method, these are the cubes of the resulting cover
+	const std::vector<std::string>& getPrimeImplicants() const noexcept { return primeImplicants; }
+	// Name of the method, that calculated the last minimization. Exact Quine and McCluskey or heuristic Espresso
+	const std::string& getNameOfMinimizer() const noexcept { return nameOfMinimizer; }
+
+protected:
+	// Show all source minterms in the reduction tables or only the lower and upper (option -sfqmt)
+	bool processLowerAndUpperMintermOnly{ true };
+	// Use the heuristic method for all boolean expressions (option -espresso)
+	bool useHeuristicMinimization{ false };
+	// Prime implicants of the last minimization, as strings
+	std::vector<std::string> primeImplicants{};
+	// Name of the method used for the last minimization
+	std::string nameOfMinimizer{};
 };
 
 
@@ -0,0 +1,136 @@
+// --------------------------------------------------------------------------------------------------------------------------------
+// License:	BSD-3-Clause
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Copyright 2019      Armin Montigny
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+// following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the 
+//    following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the 
+//    following disclaimer in the documentation and /or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or 
+//    promote products derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+
+
+#pragma once
+#ifndef RESULTCACHE_HPP
+#define RESULTCACHE_HPP
+
+//
+// Persistent cache for results
+//
+// In automatic test environments the same boolean expressions are evaluated again and again.
+// The expensive parts (truth table, Quine&  McCluskey, search for MCDC test pairs) give always
+// the same result for the same boolean expression and the same options. So the results are 
+// stored in a file and will be reused in the next run.
+//
+// The key is the boolean expression without white space plus all options, which have an influence 
+// on the result (-bse, -umdnf, -nomcdc, -espresso, -ipi, -onecover, -forcemcdc). The key cannot be the truth table, because
+// we want to avoid its calculation. And the MCDC test pairs depend on the structure of the boolean 
+// expression and not only on its truth table. The key is hashed (FNV-1a, 64 bit), but the complete
+// key is stored as well. So hash collisions are detected.
+//
+// The file is opened memory mapped for reading. New results are appended at the end of the file. 
+// Existing records are never changed. Layout (all numbers in native byte order):
+//
+// File identification "MCDCRC01"
+// Records:  magic number, size of data, hash, data
+// Data:     key, minimum DNF, prime implicants, test sets
+//
+// Strings have a 32 bit length followed by the characters. Lists have a 32 bit number of elements. 
+// An incomplete record at the end of the file (program aborted while writing) is ignored and will be
+// overwritten with the next new record. The file is not locked. Please do not write to the same 
+// cache file from parallel running programs.
+
+
+#include "types.hpp"
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <set>
+#include <unordered_map>
+
+
+// The cached results for one boolean expression
+struct ResultCacheEntry
+{
+	// Minimum DNF from the Quine&  McCluskey method (or the heuristic method)
+	std::string minimumDisjunctiveNormalForm{};
+	// All prime implicants
+	std::vector<std::string> primeImplicants{};
+	// One or more resulting MCDC test sets. Empty, if MCDC has not been calculated (option -nomcdc)
+	std::set<std::set<uint>> testSets{};
+};
+
+
+class ResultCache
+{
+public:
+	// Open or create the cache file
+	explicit ResultCache(const std::string& cacheFileName);
+	ResultCache() = delete;
+	ResultCache(const ResultCache&) = delete;
+	ResultCache& operator =(const ResultCache&) = delete;
+	~ResultCache() { unmapFile(); }
+
+	// Build the key for a boolean expression. Uses the current program options
+	static std::string createKey(const std::string& source);
+
+	// Look for a stored result. Returns false, if there is none
+	bool find(const std::string& key, ResultCacheEntry& resultCacheEntry) const;
+	// Append a new result to the cache file. Returns false, if the file could not be written
+	bool add(const std::string& key, const ResultCacheEntry& resultCacheEntry);
+
+protected:
+	// Every cache file starts with this
+	static constexpr char FileIdentification[]{ "MCDCRC01" };
+	static constexpr std::size_t FileIdentificationSize{ sizeof(FileIdentification) - 1U };
+	// Every record starts with this
+	static constexpr uint32_t RecordMagicNumber{ 0x4D435243U };
+	// Magic number, size of data and hash
+	static constexpr std::size_t RecordHeaderSize{ 2U * sizeof(uint32_t) + sizeof(uint64_t) };
+
+	// FNV-1a hash for the key
+	static uint64_t hashOf(const std::string& key) noexcept;
+
+	// Map the complete file into memory (read only) and build the index for the records
+	void mapFile();
+	void unmapFile() noexcept;
+
+	// Decode the data of one record. Returns false, if the data are corrupt
+	bool readRecord(std::size_t offset, std::string& key, ResultCacheEntry& resultCacheEntry) const;
+
+	// Name of the cache file
+	std::string fileName;
+	// The memory mapped file
+	const uint8_t* mappedData{ nullptr };
+	std::size_t mappedSize{ 0U };
+	// Size of the file part with complete records
+	std::size_t validSize{ 0U };
+	// The file exists, but is not a cache file. We will not touch it
+	bool foreignFile{ false };
+	// Hash --> offset of the record data in the file
+	std::unordered_multimap<uint64_t, std::size_t> recordIndex{};
+};
+
+
+#endif
@@ -0,0 +1,96 @@
+// --------------------------------------------------------------------------------------------------------------------------------
+// License:	BSD-3-Clause
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Copyright 2019      Armin Montigny
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+// following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the 
+//    following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the 
+//    following disclaimer in the documentation and /or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or 
+//    promote products derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+
+
+#pragma once
+#ifndef SIMDKERNEL_HPP
+#define SIMDKERNEL_HPP
+
+//
+// Kernels for the bit sliced evaluation of boolean expressions
+//
+// The virtual machine can run a program in bit sliced mode. Every machine register is then
+// a 64 bit word and holds the result for 64 consecutive input values. 
+//
+// With SIMD instructions, we can do even more. An AVX2 register has 256 bit, an AVX-512 register 512 bit.
+// So one pass through the program evaluates 256 or 512 input values.
+//
+// Not all CPUs support AVX2 or AVX-512. So the kernel will be selected at runtime (once, on first usage) 
+// via CPUID. If nothing is available or we are not on an x86-64 machine, then the scalar 64 bit
+// kernel is used.
+//
+// All kernels produce the same result: A packed truth table. Bit k of truth table word w is the
+// result of the boolean expression for input value w*64+k
+
+
+#include "types.hpp"
+#include "bytecode.hpp"
+
+#include <array>
+#include <vector>
+
+
+// On x86-64 we can use SIMD intrinsics
+#if defined(_M_X64) || defined(__x86_64__)
+#define MCDC_SIMD_X86_64
+#endif
+
+
+// Pattern of the lower 6 bits of the input value over 64 consecutive input values.
+// Bit k of laneBitPattern[b] is bit b of the value k.
+constexpr std::array<TruthTableWord, NumberOfLaneBitsInTruthTableWord> laneBitPattern =
+{
+	0xAAAAAAAAAAAAAAAAULL, 0xCCCCCCCCCCCCCCCCULL, 0xF0F0F0F0F0F0F0F0ULL,
+	0xFF00FF00FF00FF00ULL, 0xFFFF0000FFFF0000ULL, 0xFFFFFFFF00000000ULL
+};
+
+
+// Available kernels
+enum class SimdKernel : uint8_t
+{
+	Scalar,		// 64 input values per pass
+	AVX2,		// 256 input values per pass
+	AVX512		// 512 input values per pass
+};
+
+// Best kernel for the CPU that we are running on. Will be checked only once
+SimdKernel selectedSimdKernel() noexcept;
+// For output purposes
+const cchar* simdKernelName(SimdKernel simdKernel) noexcept;
+
+
+// Evaluate the byte code program in bit sliced mode for the truth table words firstWord ... lastWord-1
+// numberOfRegisters is the number of needed machine registers, numberOfLiterals the number of boolean variables
+// The result will be written to truthTable[0] ... truthTable[lastWord-firstWord-1]
+void runBitSlicedKernel(SimdKernel simdKernel, const ByteCodeProgram& byteCodeProgram, uint numberOfRegisters, uint numberOfLiterals,
+						uint firstWord, uint lastWord, TruthTableWord* truthTable);
+
+
+#endif
@@ -0,0 +1,148 @@
+// --------------------------------------------------------------------------------------------------------------------------------
+// License:	BSD-3-Clause
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Copyright 2019      Armin Montigny
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+// following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the 
+//    following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the 
+//    following disclaimer in the documentation and /or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or 
+//    promote products derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+
+
+#pragma once
+#ifndef STATISTICS_HPP
+#define STATISTICS_HPP
+
+//
+// Machine readable statistics and timing for all stages (option -stats "filename")
+//
+// The text dumps show, what has been calculated. But they do not show, where the time and the memory go.
+// With option -stats, every stage of the program notes down some counters and its run time.
+// At the end of the program everything is written as JSON to the given file.
+//
+// A stage is started by creating a StageTimer. Its lifetime is the measured time. Wall clock time and
+// CPU time (of the complete process, so including all worker threads of the thread pool) are recorded.
+// Counters are simple numbers. A series is a list of numbers, for example one value per reduction round.
+// Stages can be nested, e.g. the coverage of the prime implicant table is part of the Quine&  McCluskey method.
+// All stages are listed in the order of their start.
+//
+// Counters are only updated by the thread that owns the stage. Parallel tasks count locally and the
+// results are added after the tasks are done. If the option is not selected, nothing is recorded.
+//
+// Example for the output:
+//
+// { "stages": [ { "name": "MintermCalculator", "wallClockTime": 0.00123, "cpuTime": 0.00156,
+//                 "counter": { "vmWordInstructions": 32, "minterms": 11 } }, ... ] }
+
+
+#include "types.hpp"
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <chrono>
+#include <ctime>
+#include <ostream>
+#include <utility>
+#include <mutex>
+
+
+// Counters and times for one stage
+struct StageStatistics
+{
+	std::string name{};
+	// Times in seconds
+	double wallClockTime{ 0.0 };
+	double cpuTime{ 0.0 };
+	// Named counters and series. In the order of their first use
+	std::vector<std::pair<std::string, ull>> counter{};
+	std::vector<std::pair<std::string, std::vector<ull>>> series{};
+	// False for the dummy stage, that is used, if statistics are not enabled. Then nothing is stored
+	bool isRecorded{ true };
+
+	// Add a value to a counter. The counter is created with 0, if it does not exist
+	void add(const std::string& counterName, ull value);
+	// Append a value to a series. The series is created, if it does not exist
+	void append(const std::string& seriesName, ull value);
+};
+
+
+class Statistics
+{
+public:
+	Statistics() = default;
+	Statistics(const Statistics&) = delete;
+	Statistics& operator =(const Statistics&) = delete;
+
+	// Statistics are only recorded, if the option -stats is selected
+	bool isEnabled() const noexcept { return enabled; }
+	void enable() noexcept { enabled = true; }
+
+	// Create a new stage. The reference is valid for the lifetime of the statistics. Can be called from worker threads
+	StageStatistics& addStage(const std::string& name);
+
+	// Write all stages as JSON
+	void writeJson(std::ostream& os) const;
+	// Write all stages as JSON to the file given with option -stats. Returns false, if the file could not be written
+	bool writeJsonFile(const std::string& fileName) const;
+
+protected:
+	bool enabled{ false };
+	// A deque does not move its elements. So references to stages stay valid
+	std::deque<StageStatistics> stage{};
+	// Stages may be created by tasks in the thread pool. Each stage itself is used only by the thread, that created it
+	std::mutex mutexForStage{};
+	// If statistics are not enabled, all counters go to this dummy
+	StageStatistics notRecorded{ "", 0.0, 0.0, {}, {}, false };
+
+	friend class StageTimer;
+};
+
+// The one process wide statistics
+extern Statistics& statistics();
+
+
+// Measure the time for one stage. Start in the constructor and stop in the destructor
+class StageTimer
+{
+public:
+	explicit StageTimer(const std::string& name);
+	StageTimer() = delete;
+	StageTimer(const StageTimer&) = delete;
+	StageTimer& operator =(const StageTimer&) = delete;
+	~StageTimer();
+
+	// The statistics for this stage. Use it to update counters
+	StageStatistics& operator()() noexcept { return stageStatistics; }
+
+protected:
+	// CPU time of the process (all threads) in seconds
+	static double processCpuTime() noexcept;
+
+	StageStatistics& stageStatistics;
+	const std::chrono::steady_clock::time_point wallClockStart;
+	const double cpuTimeStart;
+};
+
+
+#endif
@@ -0,0 +1,186 @@
+// --------------------------------------------------------------------------------------------------------------------------------
+// License:	BSD-3-Clause
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Copyright 2019      Armin Montigny
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+// following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the 
+//    following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the 
+//    following disclaimer in the documentation and /or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or 
+//    promote products derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+
+
+#pragma once
+#ifndef THREADPOOL_HPP
+#define THREADPOOL_HPP
+
+//
+// Work stealing thread pool
+//
+// All parallel parts of the program (calculation of the truth table, Quine&  McCluskey reduction
+// and the search for MCDC test pairs) submit their work as small tasks to one process wide thread pool.
+// Threads are created only once. Before there was a std::async for every range and every reduction round.
+//
+// Every worker thread has its own task queue. New tasks from a worker are put into its own queue.
+// Tasks from other threads are distributed round robin over all queues.
+// A worker takes tasks from the back of its own queue (last in first out, still hot in the cache).
+// If its own queue is empty, it steals tasks from the front of the other queues.
+// So, if one task is much bigger than the others, then the other workers will simply do the rest.
+// This is much better than a fixed distribution of equal ranges to a fixed number of threads.
+//
+// A thread, that waits for the result of a task, does not sleep, but executes other pending tasks.
+// With that, tasks can submit and wait for subtasks without the danger of a dead lock.
+//
+// The number of threads is given with the command line option -threads. The default is
+// the number of hardware threads of the machine.
+
+
+#include "types.hpp"
+
+#include <thread>
+#include <future>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <chrono>
+#include <type_traits>
+
+
+class ThreadPool
+{
+public:
+	// Create the pool and start numberOfWorkerThreads worker threads. At least one thread will be started
+	explicit ThreadPool(uint numberOfWorkerThreads);
+	ThreadPool() = delete;
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator =(const ThreadPool&) = delete;
+	// Finish all pending tasks and stop the worker threads
+	~ThreadPool();
+
+	// Number of worker threads
+	uint getNumberOfThreads() const noexcept { return narrow_cast<uint>(worker.size()); }
+
+	// Submit a function for asynchronous execution. The result can be taken from the returned future
+	template <typename Function>
+	std::future<std::invoke_result_t<std::decay_t<Function>>> submit(Function&& function);
+
+	// Wait until the future is ready. The waiting thread executes other pending tasks in the meantime
+	template <typename T>
+	void wait(const std::future<T>& future);
+
+	// Call function(i) for all i in [first, last). Blocks of grainSize indices form one task. Returns, when all are done
+	template <typename Function>
+	void parallelFor(uint first, uint last, uint grainSize, Function&& function);
+
+protected:
+	using Task = std::function<void()>;
+
+	// One task queue per worker. Owner works on the back, thieves on the front
+	struct TaskQueue
+	{
+		std::mutex mutex;
+		std::deque<Task> task;
+	};
+	std::vector<std::unique_ptr<TaskQueue>> taskQueue;
+
+	// The worker threads
+	std::vector<std::thread> worker;
+
+	// Sleeping workers will be woken up, if there are new tasks or if the pool is destroyed
+	std::mutex mutexForSleep;
+	std::condition_variable conditionForWakeUp;
+	std::atomic<uint> numberOfPendingTasks{ 0U };
+	bool stopWorker{ false };
+
+	// Tasks from threads outside the pool are distributed round robin
+	std::atomic<uint> nextQueueForSubmit{ 0U };
+
+	// Put a task into a queue and wake up a sleeping worker
+	void push(Task&& task);
+	// Take one task from the own queue or steal from others and execute it. Returns false, if there was nothing to do
+	bool tryToRunOneTask();
+	// Main loop of a worker thread
+	void workerLoop(uint indexOfQueue);
+};
+
+
+// The one process wide thread pool. It will be created with the first call
+extern ThreadPool& threadPool();
+
+
+
+// --------------------------------------------------------------------------------------------------------------------------------
+// Template implementations
+
+template <typename Function>
+std::future<std::invoke_result_t<std::decay_t<Function>>> ThreadPool::submit(Function&& function)
+{
+	using ResultType = std::invoke_result_t<std::decay_t<Function>>;
+	// std::function must be copyable. A packaged_task is not. So we share it
+	std::shared_ptr<std::packaged_task<ResultType()>> packagedTask{ std::make_shared<std::packaged_task<ResultType()>>(std::forward<Function>(function)) };
+	std::future<ResultType> result{ packagedTask->get_future() };
+	push([packagedTask]() { (*packagedTask)(); });
+	return result;
+}
+
+template <typename T>
+void ThreadPool::wait(const std::future<T>& future)
+{
+	while (std::future_status::ready != future.wait_for(std::chrono::seconds(0)))
+	{
+		// Help the other workers. If there is nothing to do, then wait a little bit
+		if (!tryToRunOneTask())
+		{
+			static_cast<void>(future.wait_for(std::chrono::microseconds(100)));
+		}
+	}
+}
+
+template <typename Function>
+void ThreadPool::parallelFor(uint first, uint last, uint grainSize, Function&& function)
+{
+	if (0U == grainSize)
+	{
+		grainSize = 1U;
+	}
+	std::vector<std::future<void>> futures;
+	for (uint blockStart = first; blockStart < last; blockStart += grainSize)
+	{
+		const uint blockEnd{ ((last - blockStart) > grainSize) ? (blockStart + grainSize) : last };
+		futures.push_back(submit([&function, blockStart, blockEnd]() { for (uint i = blockStart; i < blockEnd; ++i) { function(i); } }));
+	}
+	// Wait for all tasks. The tasks use the function. So first wait for all, then rethrow exceptions from a task
+	for (const std::future<void>& future : futures)
+	{
+		wait(future);
+	}
+	for (std::future<void>& future : futures)
+	{
+		future.get();
+	}
+}
+
+
+#endif
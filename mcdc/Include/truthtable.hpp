@@ -0,0 +1,152 @@
+// --------------------------------------------------------------------------------------------------------------------------------
+// License:	BSD-3-Clause
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Copyright 2019      Armin Montigny
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+// following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the 
+//    following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the 
+//    following disclaimer in the documentation and /or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or 
+//    promote products derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+
+
+#pragma once
+#ifndef TRUTHTABLE_HPP
+#define TRUTHTABLE_HPP
+
+//
+// Packed truth table for a boolean expression
+//
+// The result of a boolean expression for all possible input values is stored as one bit per input value.
+// Bit k of word w is the result for input value w*64+k. So a complete truth table for 16 variables needs
+// only 8 KiB. A vector with all minterms would need up to 512 KiB.
+//
+// Minterms are the input values, for which the boolean expression is true. They are the set bits (the on-set)
+// in the truth table. The truth table offers:
+//
+// - Iteration over the on-set in ascending order. So it can be used like a (sorted) container of minterms
+// - Number of minterms (population count)
+// - rank: Number of minterms less than a given input value
+// - select: Get the n-th minterm
+// - Checks for contradiction (no minterm at all) and tautology (all input values are minterms)
+//
+// For fast rank and select, a directory with the number of minterms before each word is stored.
+
+
+#include "types.hpp"
+
+#include <iterator>
+
+
+// Number of set bits in a truth table word
+constexpr uint numberOfSetBitsInTruthTableWord(TruthTableWord x) noexcept
+{
+	x = x - ((x >> 1U) & 0x5555555555555555ULL);
+	x = (x & 0x3333333333333333ULL) + ((x >> 2U) & 0x3333333333333333ULL);
+	x = (x + (x >> 4U)) & 0x0F0F0F0F0F0F0F0FULL;
+	return static_cast<uint>((x * 0x0101010101010101ULL) >> 56U);
+}
+
+// Position of the lowest set bit in a truth table word. Word must not be 0
+constexpr uint indexOfLowestSetBitInTruthTableWord(TruthTableWord x) noexcept
+{
+	return numberOfSetBitsInTruthTableWord((x & (~x + 1ULL)) - 1ULL);
+}
+
+
+class TruthTable
+{
+public:
+	TruthTable() : numberOfVariables(0U), word(1U, 0ULL), numberOfMintermsBeforeWord(1U, 0U) {}
+	// Create a truth table from packed words. Unused bits (less than 6 variables) must be 0
+	TruthTable(uint numberOfBooleanVariables, TruthTableWordStream&& packedWords);
+
+	// Number of boolean variables of the boolean expression
+	uint getNumberOfVariables() const noexcept { return numberOfVariables; }
+	// Number of possible input values. 2^numberOfVariables
+	ull numberOfInputValues() const noexcept { return 1ULL << numberOfVariables; }
+	// The packed words
+	const TruthTableWordStream& getWords() const noexcept { return word; }
+
+	// Result of the boolean expression for the given input value
+	bool operator[](ull inputValue) const noexcept { return null<TruthTableWord>() != (word[static_cast<std::size_t>(inputValue >> NumberOfLaneBitsInTruthTableWord)] & (1ULL << (inputValue & (NumberOfLanesInTruthTableWord - 1U)))); }
+
+	// Number of minterms. The population count of the truth table
+	ull numberOfMinterms() const noexcept { return numberOfMintermsBeforeWord.back(); }
+	// Boolean expression is always false
+	bool isContradiction() const noexcept { return 0ULL == numberOfMinterms(); }
+	// Boolean expression is always true
+	bool isTautology() const noexcept { return numberOfInputValues() == numberOfMinterms(); }
+
+	// Number of minterms that are less than the given input value
+	ull rank(ull inputValue) const noexcept;
+	// Get the minterm with the given index (0 is the smallest minterm). index must be less than numberOfMinterms()
+	MinTermNumber select(ull index) const noexcept;
+
+	// Convert to a vector with all minterms in ascending order
+	MintermVector toMintermVector() const;
+
+
+	// Iterator over the on-set. Delivers the minterms in ascending order
+	class const_iterator
+	{
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = MinTermNumber;
+		using difference_type = std::ptrdiff_t;
+		using pointer = const MinTermNumber*;
+		using reference = MinTermNumber;
+
+		const_iterator(const TruthTableWordStream& wordsOfTruthTable, std::size_t startWord) noexcept : words(&wordsOfTruthTable), wordIndex(startWord) { skipEmptyWords(); }
+
+		MinTermNumber operator*() const noexcept { return narrow_cast<MinTermNumber>((wordIndex << NumberOfLaneBitsInTruthTableWord) + indexOfLowestSetBitInTruthTableWord(remainingBits)); }
+		const_iterator& operator++() noexcept { remainingBits &= remainingBits - 1ULL; if (null<TruthTableWord>() == remainingBits) { ++wordIndex; skipEmptyWords(); } return *this; }
+		const_iterator operator++(int) noexcept { const_iterator result{ *this }; ++(*this); return result; }
+		bool operator==(const const_iterator& other) const noexcept { return (wordIndex == other.wordIndex) && (remainingBits == other.remainingBits); }
+		bool operator!=(const const_iterator& other) const noexcept { return !(*this == other); }
+
+	protected:
+		// Go to the next word with a set bit
+		void skipEmptyWords() noexcept
+		{
+			remainingBits = null<TruthTableWord>();
+			while ((wordIndex < words->size()) && (null<TruthTableWord>() == (remainingBits = (*words)[wordIndex]))) ++wordIndex;
+		}
+		const TruthTableWordStream* words;
+		std::size_t wordIndex;
+		// Bits in the current word, which have not yet been visited
+		TruthTableWord remainingBits{ null<TruthTableWord>() };
+	};
+
+	const_iterator begin() const noexcept { return const_iterator(word, 0U); }
+	const_iterator end() const noexcept { return const_iterator(word, word.size()); }
+
+protected:
+	uint numberOfVariables;
+	// The packed results
+	TruthTableWordStream word;
+	// Directory for rank and select. Element w is the number of minterms in the words 0..w-1. Last element is the total
+	std::vector<ull> numberOfMintermsBeforeWord;
+};
+
+
+#endif
@@ -80,8 +80,11 @@ using NumberOfBitsCountType = uint;
 
 // Depending on the maximum number of boolean variables we want to allow in our boolean
 // expressions, we define types that fit and have a minimum width
+// The scanner knows 26 different letters (a-z). So 26 is the natural limit
+// Please note: The Quine & McCluskey reduction uses its own, exact term widths (16, 32 or 64 bit).
+// The width is selected at runtime, depending on the number of variables (see quinemccluskey.hpp)
 
-#define MAX_NUMBER_OF_BOOLEAN_VARIABLES 16U
+#define MAX_NUMBER_OF_BOOLEAN_VARIABLES 26U
 
 #if (MAX_NUMBER_OF_BOOLEAN_VARIABLES < 9U)
 
@@ -94,16 +97,6 @@ using NumberOfBitsCountType = uint;
 
 	using BooleanVariable = uint_fast8_t;
 
-	// Number of set bits in an unsigned integer type
-	constexpr NumberOfBitsCountType numberOfSetBits(MinTermType x)
-	{
-		x = x - ((x >> 1)&  0x55);
-		x = (x&  0x33) + ((x >> 2)&  0x33);
-		x = (x + (x >> 4))&  0x0F;
-		return static_cast<NumberOfBitsCountType>(x&  0x3F);
-}
-
-
 #elif (MAX_NUMBER_OF_BOOLEAN_VARIABLES < 17U)
 
 	constexpr sint MaxNumberOfBitsForEvaluation{ 16 };
@@ -115,22 +108,38 @@ using NumberOfBitsCountType = uint;
 	using MaxTermType = uint_fast16_t;
 
 	using BooleanVariable = uint_fast16_t;
-	
-	// Number of set bits in an unsigned integer type
-	constexpr NumberOfBitsCountType numberOfSetBits(MinTermType x)
-	{
-		x = x - ((x >> 1) & 0x5555);
-		x = (x&  0x3333) + ((x >> 2)&  0x3333);
-		x = (x + (x >> 4)) & 0x0F0F;
-		x = x + (x >> 8);
-		return narrow_cast<NumberOfBitsCountType>(x&  0x003F);
-	}
+
+#elif (MAX_NUMBER_OF_BOOLEAN_VARIABLES < 27U)
+
+	// All letters of the alphabet can be used
+	constexpr sint MaxNumberOfBitsForEvaluation{ 26 };
+
+	using MinTermNumber = uint_fast32_t;
+	using MinTermType = uint_fast32_t;
+
+	using MaxTermNumber = uint_fast32_t;
+	using MaxTermType = uint_fast32_t;
+
+	using BooleanVariable = uint_fast32_t;
 
 #else
 	#error Too many Variables
 #endif
 
 
+// Number of set bits in an unsigned integer type with up to 64 bits
+template <typename T>
+constexpr NumberOfBitsCountType numberOfSetBits(T value) noexcept
+{
+	static_assert(std::is_integral<T>::value && (sizeof(T) <= sizeof(uint64_t)), "Only for integer types with up to 64 bits");
+	uint64_t x{ static_cast<uint64_t>(value) };
+	x = x - ((x >> 1) & 0x5555555555555555ULL);
+	x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+	x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+	return narrow_cast<NumberOfBitsCountType>((x * 0x0101010101010101ULL) >> 56);
+}
+
+
 
 
 using RowIndex = uint;
@@ -154,9 +163,19 @@ using CNF = std::vector<DNF>;
 
 
 
+// Number of threads for the thread pool, if the number of hardware threads cannot be determined
 constexpr uint numberOfThreads{ 8U };
 
 
+// A truth table can be stored packed. One bit per input combination.
+// Bit k of word w is the result for the input value w*64+k
+using TruthTableWord = uint64_t;
+using TruthTableWordStream = std::vector<TruthTableWord>;
+constexpr uint NumberOfLanesInTruthTableWord{ 64U };
+// Number of input bits that can be expressed within one truth table word (2^6 = 64)
+constexpr uint NumberOfLaneBitsInTruthTableWord{ 6U };
+
+
 // There are max 26 charachters in the latin alphabeth. So, 32 bits is always sufficient
 constexpr sint MaxNumberOfBitmasksForMaskingBooleanInput{ 32 };
 
@@ -54,10 +54,31 @@
 // a truth table. But only the minterms will be stored later.
 //
 // This is a boolean machine
+//
+// The loader creates 2 representations of the program. The original one, where each opcode is a std::function
+// and a dense byte code (see bytecode.hpp). The byte code is interpreted in a simple switch loop. This
+// is much faster, because there is no indirect type erased call per instruction. The std::function program
+// is kept as a reference implementation and can be executed with runReference
+//
+// Additionally there is a bit sliced execution mode. Here every machine register is a 64 bit word
+// and one run of the program evaluates 64 consecutive input values at once. A load of a boolean variable
+// fills the register with the pattern that this variable has over the 64 input values of the block.
+// OR, XOR, AND and NOT are then simple word operations. The result is a packed part of the truth table:
+// Bit k in the resulting word is the result for input value blockIndex*64+k
+// For evaluating many blocks, SIMD kernels (AVX2, AVX-512) will be used, if the CPU supports them
+//
+// For evaluating many arbitrary input values, there is a batch mode. 64 input values will be transposed
+// into bit sliced literal words and then the program is run once for all of them. The results are packed bits.
+//
+// On x86-64 the byte code is furthermore translated to native machine code (see nativecode.hpp).
+// runNative calls this generated function. If native code is not available, the interpreter is used
+// The translation needs executable memory. So it is done with the first call of runNative and not in load
 
 
 #include "types.hpp"
 #include "codegenerator.hpp"
+#include "simdkernel.hpp"
+#include "nativecode.hpp"
 
 #include <functional> 
 
@@ -71,10 +92,32 @@ class VirtualMachineForBooleanExpressions
 
 public:
 	// The virtual machin loads the object code and creates an executable programm. 
-	void load(ObjectCode& objectCode, const  std::string& source);	// source is for debug purposes only
+	// source is for debug purposes only. The listing of the program can be switched off
+	void load(ObjectCode& objectCode, const  std::string& source, bool showListing = true);
 	
-	// Run the executable code with an input source value of sv
+	// Run the executable code with an input source value of sv. The byte code interpreter is used
 	bool run(uint sv);
+	// Same as run, but with the original std::function based reference implementation
+	bool runReference(uint sv);
+	// Same as run, but with the generated native machine code. Falls back to the interpreter, if there is no native code
+	bool runNative(uint sv) { compileNativeCode(); return nativeCode.isAvailable() ? nativeCode(sv) : run(sv); }
+	// Check, if native code could be generated for the loaded program
+	bool isNativeCodeAvailable() { compileNativeCode(); return nativeCode.isAvailable(); }
+
+	// Bit sliced mode: Run the executable code for the 64 input values blockIndex*64 ... blockIndex*64+63
+	// Bit k of the result is the result for input value blockIndex*64+k. Unused lanes (less than 6 variables) are 0
+	TruthTableWord runBitSliced(uint blockIndex);
+	// Run the bit sliced program for all possible input values and return the complete packed truth table
+	TruthTableWordStream runBitSlicedForAllInputs();
+	// Run the bit sliced program for the truth table words firstWord ... lastWord-1
+	TruthTableWordStream runBitSlicedForRange(uint firstWord, uint lastWord);
+	// Batch mode: Evaluate numberOfInputs arbitrary input values. Bit k of resultBits[w] is the result for inputs[w*64+k]
+	// resultBits must have space for (numberOfInputs+63)/64 words. Unused bits in the last word are 0
+	void runBatch(const uint32_t* inputs, std::size_t numberOfInputs, TruthTableWord* resultBits);
+	// Same, but with vectors
+	TruthTableWordStream runBatch(const std::vector<uint32_t>& inputs);
+	// Number of 64 bit blocks needed to hold the complete truth table
+	uint numberOfTruthTableWords() const noexcept { return (numberOfLiterals > NumberOfLaneBitsInTruthTableWord) ? (1U << (numberOfLiterals - NumberOfLaneBitsInTruthTableWord)) : 1U; }
 
 
 protected:
@@ -85,6 +128,18 @@ protected:
 
 	// Machine registers for storing intermediate calculation results
 	std::vector<MachineRegisterType> machineRegister;
+	// The dense byte code program. Used for the interpreter and the bit sliced mode
+	ByteCodeProgram byteCodeProgram;
+	// Number of machine registers needed by the program
+	uint numberOfMachineRegisters{ 0U };
+	// Working memory for the batch mode. Transposed input values and machine registers with 64 lanes
+	TruthTableWordStream batchLiteral{};
+	TruthTableWordStream batchMachineRegister{};
+	// The byte code program, translated to native machine code. Only, if it is used
+	NativeCodeForBooleanExpressions nativeCode;
+	bool nativeCodeIsCompiled{ false };
+	// Translate the loaded byte code to native machine code, if not yet done
+	void compileNativeCode();
 
 	// When the program is run, then the value in this variable will be used as input and mapped to the boolean variables
 	uint32 sourceValue{ null<uint32>() };
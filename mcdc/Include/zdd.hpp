@@ -0,0 +1,171 @@
+// --------------------------------------------------------------------------------------------------------------------------------
+// License:	BSD-3-Clause
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Copyright 2019      Armin Montigny
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+// following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the 
+//    following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the 
+//    following disclaimer in the documentation and /or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or 
+//    promote products derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+
+
+#pragma once
+#ifndef ZDD_HPP
+#define ZDD_HPP
+//
+// Zero-suppressed binary decision diagram (ZDD) for families of sets and a cover solver based on it
+//
+// Petricks method (see petrick.hpp) multiplies out the CNF of a cyclic core to an explicit DNF. Every product
+// term is stored on its own. If there are millions of minimum covers, then this does not fit into the memory.
+// A ZDD stores a family of sets (here: sets of column indices) as a directed acyclic graph. Equal sub families are
+// stored only once. So a huge number of sets can be represented with a small number of nodes.
+//
+// Every node has a variable (a column index), a low and a high child:
+//   - low:  all sets of the family, that do not contain the variable
+//   - high: all sets of the family, that contain the variable (without the variable itself)
+// There are 2 terminal nodes. Empty: the empty family {}. Base: the family with only the empty set {{}}
+// On every path from the root to a terminal, the variables are strictly increasing.
+// A node, whose high child is Empty, is never created (zero suppression). And every node exists only once (unique table).
+//
+// The operations needed for the covering problem are:
+//   - unite:        F + G           all sets of F and of G
+//   - join:         F * G           all unions f u g with f in F and g in G. This is the multiplication of a CNF
+//   - restrictSize: all sets of F with at most n elements
+//   - minimumSize:  the size of the smallest set in F
+//   - minimumCost:  the subfamily of the cheapest sets, if every variable has a cost (weighted shortest path)
+//   - count and enumerate the sets. Enumeration is in lexicographical order and can stop after n sets
+// Results of the recursive operations are cached. Nodes are never deleted, as long as the Zdd object lives.
+//
+// ZddCovering builds the product of all rows of a cyclic core. A row is the family of the single columns,
+// that cover it. After every multiplication, all sets, that are longer than the minimum cover, are removed.
+// The size of the minimum cover is calculated before with the branch and bound solver (only one cover, which is fast).
+// So the final ZDD contains exactly all minimum covers. Only the cheapest of them (for example the ones with the fewest
+// literals) are selected in the ZDD and only these are enumerated, at most MaxNumberOfCovers. The number of all minimum
+// covers is only counted. So the complete list of minimum covers is never built.
+
+#include "types.hpp"
+#include "dynamicbitset.hpp"
+
+#include <vector>
+#include <unordered_map>
+#include <limits>
+
+
+class Zdd
+{
+public:
+	// A node is an index into the node table
+	using Node = uint;
+
+	// The terminal nodes. Empty family {} and family with the empty set {{}}
+	static constexpr Node Empty{ 0U };
+	static constexpr Node Base{ 1U };
+
+	Zdd();
+
+	// The family {{variable}}
+	Node single(uint variable) { return getNode(variable, Empty, Base); }
+
+	// Family operations
+	Node unite(Node f, Node g);
+	Node join(Node f, Node g);
+	Node restrictSize(Node f, uint maxSize);
+	// Number of elements of the smallest set in the family. NoSet for the empty family
+	uint minimumSize(Node f);
+	// All sets of the family, where the sum of the costs of their variables is minimal. cost[v] is the cost of variable v
+	Node minimumCost(Node f, const std::vector<uint>& cost);
+	// Number of sets in the family
+	ull count(Node f);
+	// The first sets of the family in lexicographical order (like a std::set<ProductTerm>). At most maxNumberOfSets
+	void enumerate(Node f, std::vector<ProductTerm>& result, std::size_t maxNumberOfSets) const;
+
+	// Number of nodes in the node table (including the terminals)
+	std::size_t numberOfNodes() const noexcept { return node.size(); }
+
+	// Result of minimumSize for the empty family
+	static constexpr uint NoSet{ std::numeric_limits<uint>::max() };
+
+protected:
+	// Variable of the terminal nodes. Larger than all real variables. So terminals are always at the bottom
+	static constexpr uint TerminalVariable{ std::numeric_limits<uint>::max() };
+
+	struct NodeType
+	{
+		uint variable;
+		Node low;
+		Node high;
+	};
+
+	// Get the node from the unique table, or create it. Applies the zero suppression rule
+	Node getNode(uint variable, Node low, Node high);
+
+	// Key for the unique table and the caches. 2 values packed into one
+	static ull makeKey(uint first, uint second) noexcept { return (static_cast<ull>(first) << 32U) | static_cast<ull>(second); }
+
+	// Cost of the cheapest set in the family. NoCost for the empty family. Uses cacheCost
+	ull calculateMinimumCost(Node f, const std::vector<uint>& cost);
+	// Recursive part of minimumCost
+	Node selectMinimumCost(Node f, const std::vector<uint>& cost);
+	static constexpr ull NoCost{ std::numeric_limits<ull>::max() };
+
+	// Recursive part of enumerate
+	void enumerate(Node f, ProductTerm& productTerm, std::vector<ProductTerm>& result, std::size_t maxNumberOfSets) const;
+
+	// The node table. Index 0 and 1 are the terminals
+	std::vector<NodeType> node;
+
+	// Unique table: (variable, low, high) --> node. The variable is the key of the outer map
+	std::vector<std::unordered_map<ull, Node>> uniqueTable;
+
+	// Caches for the operations
+	std::unordered_map<ull, Node> cacheUnite;
+	std::unordered_map<ull, Node> cacheJoin;
+	std::unordered_map<ull, Node> cacheRestrictSize;
+	std::unordered_map<Node, uint> cacheMinimumSize;
+	std::unordered_map<Node, ull> cacheCount;
+	// Only valid for the cost vector of the current call of minimumCost
+	std::unordered_map<Node, ull> cacheCost;
+	std::unordered_map<Node, Node> cacheMinimumCost;
+};
+
+
+
+class ZddCovering
+{
+public:
+	// Not more covers are given back
+	static constexpr std::size_t MaxNumberOfCovers{ 1024U };
+
+	// columnCost: Cost of every column. For example the number of literals of a prime implicant. Empty: all columns cost the same
+	explicit ZddCovering(const std::vector<uint>& columnCost = {}) : columnCost(columnCost) {}
+
+	// Functor operator. Rows of the table. Bit c in a row: Column c covers the row. All rows have the same number of bits (the number of columns)
+	// Returns the cheapest of the minimum covers as sets of column indices, sorted like the result of Petricks method
+	ProductTermVector operator()(const std::vector<DynamicBitset>& tableRow);
+
+protected:
+	std::vector<uint> columnCost;
+};
+
+
+#endif
@@ -0,0 +1,235 @@
+// --------------------------------------------------------------------------------------------------------------------------------
+// License:	BSD-3-Clause
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Copyright 2019      Armin Montigny
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+// following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the 
+//    following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the 
+//    following disclaimer in the documentation and /or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or 
+//    promote products derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+
+
+
+// Benchmark for the virtual machine
+//
+// The virtual machine has a byte code interpreter and a reference implementation, 
+// which calls a std::function for every opcode. And there is the bit sliced mode, the batch mode and the native machine code.
+// This benchmark compiles boolean expressions and runs all implementations for all possible input values.
+// The results are compared and the runtime is shown.
+// The object code is optimized (if not switched off with -noopt). The reference result is always
+// calculated with the unoptimized object code. So also the optimizer will be checked.
+//
+// The boolean expressions are read from an option file. All "-s" options will be used,
+// also those, that are commented out. So the typical "options.txt" can be used as a test set.
+
+
+#include "benchmark.hpp"
+#include "compiler.hpp"
+#include "virtualmachine.hpp"
+#include "optimizer.hpp"
+#include "cloption.hpp"
+#include "truthtable.hpp"
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+
+
+// Read all boolean expressions given with option "-s" from an option file. Also commented lines will be read
+std::vector<std::string> readBooleanExpressionsFromOptionFile(const std::string& optionFileName)
+{
+	std::vector<std::string> booleanExpressions;
+	std::ifstream optionFile(optionFileName);
+	if (!optionFile)
+	{
+		std::cerr << "Error: Cannot open option file: '" << optionFileName << "'\n";
+	}
+	else
+	{
+		std::string line;
+		while (std::getline(optionFile, line))
+		{
+			// Look for the option "-s" followed by white space and a quoted string
+			const std::string::size_type positionOption{ line.find("-s ") };
+			if (std::string::npos != positionOption)
+			{
+				// Everything before the option must be white space or comment characters
+				if (line.find_first_not_of(" \t#") >= positionOption)
+				{
+					const std::string::size_type positionStart{ line.find('"', positionOption) };
+					const std::string::size_type positionEnd{ (std::string::npos == positionStart) ? std::string::npos : line.find('"', positionStart + 1U) };
+					if (std::string::npos != positionEnd)
+					{
+						std::string booleanExpression{ line.substr(positionStart + 1U, positionEnd - positionStart - 1U) };
+						// The placeholder in the description of the options is not a boolean expression
+						if ("boolean expression" != booleanExpression)
+						{
+							booleanExpressions.push_back(booleanExpression);
+						}
+					}
+				}
+			}
+		}
+	}
+	return booleanExpressions;
+}
+
+
+// Run the benchmark for all boolean expressions in the given option file and show the results
+void benchmarkVirtualMachine(const std::string& optionFileName)
+{
+	using Clock = std::chrono::steady_clock;
+	// We want at least so many evaluations for each implementation. Small expressions will be repeated
+	constexpr uint minimumNumberOfEvaluations{ 1U << 20U };
+
+	const std::vector<std::string> booleanExpressions{ readBooleanExpressionsFromOptionFile(optionFileName) };
+
+	std::cout << "\n------------------ Benchmark virtual machine. Boolean expressions from option file '" << optionFileName << "'\n\n";
+	std::cout << "Kernel for bit sliced mode: " << simdKernelName(selectedSimdKernel()) << "\n";
+	std::cout << "Native code:                " << (nativeCodeIsSupported() ? "x86-64" : "not supported (interpreter is used)") << "\n\n";
+	std::cout << std::left << std::setw(6) << "Vars" << std::setw(8) << "Opcodes" << std::setw(8) << "Opt" << std::right << std::setw(16) << "Reference ns" << std::setw(16) << "Byte code ns"
+		<< std::setw(10) << "Speedup" << std::setw(16) << "Bit sliced ns" << std::setw(16) << "Native ns" << std::setw(16) << "Batch ns" << std::setw(10) << "Result" << "   Boolean expression\n";
+	std::cout << std::string(138, '-') << '\n';
+
+	for (std::string booleanExpression : booleanExpressions)
+	{
+		// Compile the boolean expression
+		ObjectCode objectCode;
+		CompilerForVM compiler(booleanExpression, objectCode);
+		if (!compiler())
+		{
+			std::cout << "Syntax error in boolean expression '" << booleanExpression << "'\n";
+			continue;
+		}
+		const uint numberOfVariables{ objectCode.symbolTable.numberOfSymbols() };
+		if (numberOfVariables > static_cast<uint>(MaxNumberOfBitsForEvaluation))
+		{
+			std::cout << "Too many boolean variables in boolean expression '" << booleanExpression << "'\n";
+			continue;
+		}
+		// Keep the unoptimized object code as reference
+		ObjectCode objectCodeUnoptimized{ objectCode };
+		const uint numberOfOpCodesUnoptimized{ narrow_cast<uint>(objectCode.opCode.size()) };
+		if (!programOption.option[ProgramOption::noopt].optionSelected)
+		{
+			OptimizerForVM optimizerForVM(objectCode);
+			optimizerForVM.optimize();
+		}
+		// Load it into the virtual machine. We do not want to see the listing
+		VirtualMachineForBooleanExpressions vm;
+		vm.load(objectCode, booleanExpression, false);
+		VirtualMachineForBooleanExpressions vmUnoptimized;
+		vmUnoptimized.load(objectCodeUnoptimized, booleanExpression, false);
+		const uint numberOfInputValues{ 1U << numberOfVariables };
+		const uint numberOfRepetitions{ (numberOfInputValues < minimumNumberOfEvaluations) ? (minimumNumberOfEvaluations / numberOfInputValues) : 1U };
+		const double numberOfEvaluations{ static_cast<double>(numberOfRepetitions) * numberOfInputValues };
+
+		// All input values for the batch mode
+		std::vector<uint32_t> batchInput(numberOfInputValues);
+		for (uint inputValue = 0U; inputValue < numberOfInputValues; ++inputValue) batchInput[inputValue] = inputValue;
+
+		// First check, if all implementations calculate the same result
+		const TruthTableWordStream truthTable{ vm.runBitSlicedForAllInputs() };
+		const TruthTableWordStream batchResult{ vm.runBatch(batchInput) };
+		bool resultOK{ true };
+		for (uint inputValue = 0U; inputValue < numberOfInputValues; ++inputValue)
+		{
+			const bool resultBitSliced{ null<TruthTableWord>() != (truthTable[inputValue >> NumberOfLaneBitsInTruthTableWord] & (1ULL << (inputValue & (NumberOfLanesInTruthTableWord - 1U)))) };
+			const bool resultBatch{ null<TruthTableWord>() != (batchResult[inputValue >> NumberOfLaneBitsInTruthTableWord] & (1ULL << (inputValue & (NumberOfLanesInTruthTableWord - 1U)))) };
+			const bool resultReference{ vmUnoptimized.runReference(inputValue) };
+			resultOK = resultOK && (resultReference == vm.runReference(inputValue)) && (resultReference == vm.run(inputValue)) && (resultReference == resultBitSliced) && (resultReference == resultBatch) && (resultReference == vm.runNative(inputValue));
+		}
+
+		// Reference implementation with std::function
+		uint countReference{ 0U };
+		Clock::time_point start{ Clock::now() };
+		for (uint repetition = 0U; repetition < numberOfRepetitions; ++repetition)
+		{
+			for (uint inputValue = 0U; inputValue < numberOfInputValues; ++inputValue)
+			{
+				if (vm.runReference(inputValue)) ++countReference;
+			}
+		}
+		const double durationReference{ std::chrono::duration<double, std::nano>(Clock::now() - start).count() };
+
+		// Byte code interpreter
+		uint countByteCode{ 0U };
+		start = Clock::now();
+		for (uint repetition = 0U; repetition < numberOfRepetitions; ++repetition)
+		{
+			for (uint inputValue = 0U; inputValue < numberOfInputValues; ++inputValue)
+			{
+				if (vm.run(inputValue)) ++countByteCode;
+			}
+		}
+		const double durationByteCode{ std::chrono::duration<double, std::nano>(Clock::now() - start).count() };
+
+		// Bit sliced mode
+		uint countBitSliced{ 0U };
+		start = Clock::now();
+		for (uint repetition = 0U; repetition < numberOfRepetitions; ++repetition)
+		{
+			for (const TruthTableWord word : vm.runBitSlicedForAllInputs())
+			{
+				countBitSliced += numberOfSetBitsInTruthTableWord(word);
+			}
+		}
+		const double durationBitSliced{ std::chrono::duration<double, std::nano>(Clock::now() - start).count() };
+
+		// Native machine code
+		uint countNative{ 0U };
+		start = Clock::now();
+		for (uint repetition = 0U; repetition < numberOfRepetitions; ++repetition)
+		{
+			for (uint inputValue = 0U; inputValue < numberOfInputValues; ++inputValue)
+			{
+				if (vm.runNative(inputValue)) ++countNative;
+			}
+		}
+		const double durationNative{ std::chrono::duration<double, std::nano>(Clock::now() - start).count() };
+
+		// Batch mode
+		uint countBatch{ 0U };
+		TruthTableWordStream batchResultBits(batchResult.size(), 0ULL);
+		start = Clock::now();
+		for (uint repetition = 0U; repetition < numberOfRepetitions; ++repetition)
+		{
+			vm.runBatch(batchInput.data(), batchInput.size(), batchResultBits.data());
+			for (const TruthTableWord word : batchResultBits)
+			{
+				countBatch += numberOfSetBitsInTruthTableWord(word);
+			}
+		}
+		const double durationBatch{ std::chrono::duration<double, std::nano>(Clock::now() - start).count() };
+
+		resultOK = resultOK && (countReference == countBatch) && (countReference == countByteCode) && (countReference == countBitSliced) && (countReference == countNative);
+
+		// Show result. Time per evaluation of one input value
+		std::cout << std::left << std::setw(6) << numberOfVariables << std::setw(8) << numberOfOpCodesUnoptimized << std::setw(8) << objectCode.opCode.size() << std::right << std::fixed << std::setprecision(2)
+			<< std::setw(16) << (durationReference / numberOfEvaluations) << std::setw(16) << (durationByteCode / numberOfEvaluations)
+			<< std::setw(10) << (durationReference / durationByteCode) << std::setw(16) << (durationBitSliced / numberOfEvaluations) << std::setw(16) << (durationNative / numberOfEvaluations) << std::setw(16) << (durationBatch / numberOfEvaluations)
+			<< std::setw(10) << (resultOK ? "OK" : "MISMATCH") << "   " << booleanExpression << '\n';
+	}
+	std::cout << "\n\n";
+}
@@ -0,0 +1,253 @@
+// --------------------------------------------------------------------------------------------------------------------------------
+// License:	BSD-3-Clause
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Copyright 2019      Armin Montigny
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+// following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the 
+//    following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the 
+//    following disclaimer in the documentation and /or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or 
+//    promote products derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+
+
+// Exact solver for the unate covering problem with branch and bound. See branchandbound.hpp
+
+#include "branchandbound.hpp"
+#include "statistics.hpp"
+
+#include <algorithm>
+
+
+// Functor operator. Search the minimum covers for the given table
+ProductTermVector BranchAndBoundCovering::operator()(const std::vector<DynamicBitset>& tableRow)
+{
+	// Time and size of the search tree for option -stats
+	StageTimer stageTimer("BranchAndBound");
+
+	ProductTermVector result;
+	if (!tableRow.empty())
+	{
+		const std::size_t numberOfRows{ tableRow.size() };
+		const std::size_t numberOfColumns{ tableRow[0].size() };
+
+		// Rows as given and the transposed table with columns
+		rowBit = tableRow;
+		columnBit.assign(numberOfColumns, DynamicBitset(numberOfRows));
+		DynamicBitset liveColumn(numberOfColumns);
+		for (std::size_t row = 0U; row < numberOfRows; ++row)
+		{
+			for (std::size_t column = rowBit[row].findNext(0U); column < numberOfColumns; column = rowBit[row].findNext(column + 1U))
+			{
+				columnBit[column].set(row);
+			}
+			liveColumn |= rowBit[row];
+		}
+		DynamicBitset liveRow(numberOfRows);
+		liveRow.setAll();
+
+		// Every cover is better than this
+		bestNumberOfColumns = numberOfColumns + 1U;
+		minimumCover.clear();
+		numberOfNodes = 0ULL;
+
+		std::vector<uint> selectedColumn;
+		search(liveRow, liveColumn, selectedColumn);
+
+		// The set is sorted. So the order is the same as for Petricks method
+		result.assign(minimumCover.begin(), minimumCover.end());
+
+		stageTimer().add("rows", numberOfRows);
+		stageTimer().add("columns", numberOfColumns);
+		stageTimer().add("nodes", numberOfNodes);
+		stageTimer().add("minimumCoverSize", minimumCover.empty() ? 0U : bestNumberOfColumns);
+		stageTimer().add("minimumCovers", minimumCover.size());
+	}
+	return result;
+}
+
+
+// One node in the search tree. Reduce, check the bound and then branch over the columns of the row with the fewest columns
+void BranchAndBoundCovering::search(DynamicBitset liveRow, DynamicBitset liveColumn, std::vector<uint>& selectedColumn)
+{
+	++numberOfNodes;
+	const std::size_t numberOfSelectedColumnsBefore{ selectedColumn.size() };
+
+	if (reduce(liveRow, liveColumn, selectedColumn))
+	{
+		if (!liveRow.any())
+		{
+			// All rows are covered. This is a cover
+			if (isCandidate(selectedColumn.size()))
+			{
+				// Better than everything so far. Forget the old covers
+				if (selectedColumn.size() < bestNumberOfColumns)
+				{
+					bestNumberOfColumns = selectedColumn.size();
+					minimumCover.clear();
+				}
+				ProductTerm productTerm;
+				for (const uint column : selectedColumn)
+				{
+					productTerm.insert(narrow_cast<BooleanVariable>(column));
+				}
+				minimumCover.insert(std::move(productTerm));
+			}
+		}
+		else if (isCandidate(selectedColumn.size() + lowerBound(liveRow, liveColumn)))
+		{
+			// Branch over the row with the fewest columns. So there are the fewest branches
+			std::size_t branchRow{ liveRow.findNext(0U) };
+			std::size_t fewestColumns{ rowBit[branchRow].countAnd(liveColumn) };
+			for (std::size_t row = liveRow.findNext(branchRow + 1U); row < liveRow.size(); row = liveRow.findNext(row + 1U))
+			{
+				const std::size_t numberOfColumns{ rowBit[row].countAnd(liveColumn) };
+				if (numberOfColumns < fewestColumns)
+				{
+					fewestColumns = numberOfColumns;
+					branchRow = row;
+				}
+			}
+
+			DynamicBitset branchColumn{ rowBit[branchRow] };
+			branchColumn &= liveColumn;
+			for (std::size_t column = branchColumn.findNext(0U); column < branchColumn.size(); column = branchColumn.findNext(column + 1U))
+			{
+				// Select the column. All its rows are covered
+				DynamicBitset nextLiveRow{ liveRow };
+				nextLiveRow.andNot(columnBit[column]);
+				DynamicBitset nextLiveColumn{ liveColumn };
+				nextLiveColumn.reset(column);
+
+				selectedColumn.push_back(narrow_cast<uint>(column));
+				search(std::move(nextLiveRow), std::move(nextLiveColumn), selectedColumn);
+				selectedColumn.pop_back();
+
+				// All covers with this column have been found. The next branches do not use it
+				liveColumn.reset(column);
+			}
+		}
+	}
+	selectedColumn.resize(numberOfSelectedColumnsBefore);
+}
+
+
+// Reduce the table of a node, until nothing changes any longer
+bool BranchAndBoundCovering::reduce(DynamicBitset& liveRow, DynamicBitset& liveColumn, std::vector<uint>& selectedColumn)
+{
+	bool isFeasible{ true };
+	bool isChanged{ true };
+	while (isFeasible && isChanged)
+	{
+		isChanged = false;
+
+		// Essential columns. A row with only one allowed column
+		for (std::size_t row = liveRow.findNext(0U); (row < liveRow.size()) && isFeasible; row = liveRow.findNext(row + 1U))
+		{
+			const std::size_t numberOfColumns{ rowBit[row].countAnd(liveColumn) };
+			if (0U == numberOfColumns)
+			{
+				// This row can never be covered in this sub tree
+				isFeasible = false;
+			}
+			else if (1U == numberOfColumns)
+			{
+				const std::size_t column{ rowBit[row].findFirstAnd(liveColumn) };
+				selectedColumn.push_back(narrow_cast<uint>(column));
+				liveRow.andNot(columnBit[column]);
+				liveColumn.reset(column);
+				isChanged = true;
+			}
+		}
+
+		if (isFeasible)
+		{
+			// Columns, that cover no row any longer, are not needed
+			for (std::size_t column = liveColumn.findNext(0U); column < liveColumn.size(); column = liveColumn.findNext(column + 1U))
+			{
+				if (!columnBit[column].intersects(liveRow))
+				{
+					liveColumn.reset(column);
+				}
+			}
+
+			// Dominating rows. If all columns of row2 are also in row1, then row1 is covered, whenever row2 is covered
+			for (std::size_t row1 = liveRow.findNext(0U); row1 < liveRow.size(); row1 = liveRow.findNext(row1 + 1U))
+			{
+				for (std::size_t row2 = liveRow.findNext(0U); row2 < liveRow.size(); row2 = liveRow.findNext(row2 + 1U))
+				{
+					if ((row1 != row2) && rowBit[row2].isSubsetOf(rowBit[row1], liveColumn))
+					{
+						liveRow.reset(row1);
+						isChanged = true;
+						break;
+					}
+				}
+			}
+
+			// Dominated columns. If all rows of column1 are also in column2, then column2 can always be used instead of column1
+			// This removes equal cost alternatives. So it is only done, if one minimum cover is sufficient
+			if (!searchAllMinimumCovers)
+			{
+				for (std::size_t column1 = liveColumn.findNext(0U); column1 < liveColumn.size(); column1 = liveColumn.findNext(column1 + 1U))
+				{
+					for (std::size_t column2 = liveColumn.findNext(0U); column2 < liveColumn.size(); column2 = liveColumn.findNext(column2 + 1U))
+					{
+						if ((column1 != column2) && columnBit[column1].isSubsetOf(columnBit[column2], liveRow))
+						{
+							liveColumn.reset(column1);
+							isChanged = true;
+							break;
+						}
+					}
+				}
+			}
+		}
+	}
+	return isFeasible;
+}
+
+
+// Greedy independent set of rows. Rows with few columns first. No 2 rows of the set have a common column
+// So every row of the set needs its own column
+uint BranchAndBoundCovering::lowerBound(const DynamicBitset& liveRow, const DynamicBitset& liveColumn) const
+{
+	std::vector<std::pair<std::size_t, std::size_t>> numberOfColumnsAndRow;
+	for (std::size_t row = liveRow.findNext(0U); row < liveRow.size(); row = liveRow.findNext(row + 1U))
+	{
+		numberOfColumnsAndRow.emplace_back(rowBit[row].countAnd(liveColumn), row);
+	}
+	std::sort(numberOfColumnsAndRow.begin(), numberOfColumnsAndRow.end());
+
+	uint result{ 0U };
+	DynamicBitset usedColumn(liveColumn.size());
+	for (const std::pair<std::size_t, std::size_t>& ncr : numberOfColumnsAndRow)
+	{
+		DynamicBitset column{ rowBit[ncr.second] };
+		column &= liveColumn;
+		if (!column.intersects(usedColumn))
+		{
+			usedColumn |= column;
+			++result;
+		}
+	}
+	return result;
+}
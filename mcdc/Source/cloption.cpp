@@ -178,6 +178,24 @@
 
 // Any 3.7 option switches on the respective 3.8 options
 
+
+// ---------------------------------------------------------------
+// 4. Performance related Options
+
+// -bvm "filename"			Benchmark the virtual machine. Compare byte code interpreter and reference implementation for all boolean expressions in option file "filename"
+// -noopt					Do not optimize the object code for the virtual machine
+// -threads n				Number of worker threads for all parallel calculations. Default (or 0) is the number of hardware threads
+// -espresso				Use the heuristic (Espresso like) minimizer instead of Quine&McCluskey. Is selected automatically for big boolean expressions
+// -ipi						Calculate the prime implicants directly from the boolean expression without truth table. Is selected automatically for big boolean expressions
+// -cache "filename"		Store results in the cache file "filename" and reuse them, if the same boolean expression is evaluated again with the same options
+// -mo						Minimize several boolean expressions together with shared prime implicants. The boolean expressions in -s are separated by ';'
+// -stats "filename"		Write statistics and timing for all stages (minterm calculation, Quine&McCluskey, coverage, MCDC) as JSON to file "filename"
+// -petrick				Use Petricks method for the cyclic core of a coverage table instead of branch and bound
+// -onecover				Search only one minimum cover for the cyclic core of a coverage table. Is faster, if there are many minimum covers
+// -petricktree			Petricks method: Multiply the clauses in a balanced tree in parallel on all worker threads
+// -zdd					Use a zero-suppressed decision diagram for the cyclic core of a coverage table. For many minimum covers
+// -forcemcdc				Search MCDC test pairs also for boolean expressions with more than 16 conditions. Needs exponential time and memory
+
 //
 // if an explicit filename is given, it will always be used in favour auf a automatic generated file name.
 // Means, if "f" and "a" suffix are both present, suffix "f" will be used.
@@ -604,6 +622,21 @@ void ProgramOption::setDefaultOptions()
 	option.emplace_back(CommandLineOption(58, "-pmcsfauto", "", true));
 	option.emplace_back(CommandLineOption(59, "-pmcsfautoa", "testcoveragesets.txt", false));
 
+	// 4. Performance related options
+	option.emplace_back(CommandLineOption(60, "-bvm", "options.txt", true));
+	option.emplace_back(CommandLineOption(61, "-noopt", "", false));
+	option.emplace_back(CommandLineOption(62, "-threads", "0", true));
+	option.emplace_back(CommandLineOption(63, "-espresso", "", false));
+	option.emplace_back(CommandLineOption(64, "-ipi", "", false));
+	option.emplace_back(CommandLineOption(65, "-cache", "", true));
+	option.emplace_back(CommandLineOption(66, "-mo", "", false));
+	option.emplace_back(CommandLineOption(67, "-stats", "statistics.json", true));
+	option.emplace_back(CommandLineOption(68, "-petrick", "", false));
+	option.emplace_back(CommandLineOption(69, "-onecover", "", false));
+	option.emplace_back(CommandLineOption(70, "-petricktree", "", false));
+	option.emplace_back(CommandLineOption(71, "-zdd", "", false));
+	option.emplace_back(CommandLineOption(72, "-forcemcdc", "", false));
+
 }
 
 
@@ -866,6 +899,23 @@ void ProgramOption::evaluateCommandLine()
 		indexBeginOutputOptions += 5;
 	}
 
+	// All options behind the output option groups are single options and not organized in groups
+	for (uint index = pmcsfautoa + 1U; index < option.size(); ++index)
+	{
+		optionIdString = option[index].optionIdentificationString;
+		clvi = std::find_if(commandLineString.begin(), commandLineString.end(), [&](const OptionWithParameter& owp) noexcept{ return (optionIdString == owp.groupOptionString); });
+		if (commandLineString.end() != clvi)
+		{
+			// Valid option found. Set flag to active
+			option[index].optionSelected = true;
+			// If existing copy also the parameter
+			if (!clvi->parameter.empty())
+			{
+				option[index].optionParameterString = clvi->parameter;
+			}
+		}
+	}
+
 
 
 
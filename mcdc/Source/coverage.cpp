@@ -182,10 +182,16 @@
 
 #include "coverage.hpp"
 #include "petrick.hpp"
+#include "branchandbound.hpp"
+#include "zdd.hpp"
+#include "statistics.hpp"
+#include "threadpool.hpp"
 
 #include <algorithm>
+#include <limits>
 #include <iostream>
 #include <iomanip>
+#include <set>
 
 
 
@@ -296,38 +302,21 @@ void Coverage::setCellAsCover(Index row, Index column)
 // Try to find such column. If so, store it and delete related columns and rows
 void Coverage::findEssentialColumn()
 {
+	// The not dropped cells of a row are the cells in not dropped columns
+	DynamicBitset liveColumn{ getLiveMask(tableColumns) };
 	// Check all rows, if it is covered by one column only
 	for (TableCellVector& tcv : tableRows)
 	{
 		// Do only something, if the row is still active
-		if (!tcv.dropped)
+		// If there is only 1 Covering Column, then the column is essential. It has to be in all coverage sets
+		if (!tcv.dropped && (1U == tcv.coverBit.countAnd(liveColumn)))
 		{
-			// Counter for columns that cover that row
-			uint columnCoverageCounter{ 0 };
-			// Here we store the last evaluated column in the row vector. This value is taken from the
-			// crossReference entry that denotes the column
-			Index lastEvaluatedNotDroppedColumn{ 0 };
-			// Iterate through all table cells for this row
-			for (const TableCell &tc : tcv.cell)
-			{
-				// Only if cell is still active
-				if (!tc.dropped)
-				{
-					// Remember the column. The crossReference of a row points to the column
-					lastEvaluatedNotDroppedColumn = tc.crossReference;
-					// We found a new covering column. Count it
-					++columnCoverageCounter;
-					
-				}
-			}
-			// If there is only 1 Covering Column, then the column is essential. It has to be in all coverage sets
-			if (1 == columnCoverageCounter)
-			{
-				// Store essential column
-				essentialColumn.insert(tableColumns[lastEvaluatedNotDroppedColumn].cellVectorHeader);
-				// Drop covered rows and columns
-				dropColumnAndAllRowsInColumn(lastEvaluatedNotDroppedColumn);
-			}
+			const Index column{ narrow_cast<Index>(tcv.coverBit.findFirstAnd(liveColumn)) };
+			// Store essential column
+			essentialColumn.insert(tableColumns[column].cellVectorHeader);
+			// Drop covered rows and columns
+			dropColumnAndAllRowsInColumn(column);
+			liveColumn.reset(column);
 		}
 	}
 }
@@ -367,6 +356,8 @@ void Coverage::findDominatingVector(TableVector &firstDimension, TableVector &se
 	// Here we will collect which vectors shall be dropped (can be rows, can be columns)
 	// The actual "dropping" will be done afterwards
 	std::set<Index> vectorsToDrop;
+	// Vectors are dropped only at the end. So the not dropped vectors of the other dimension do not change in the loop
+	const DynamicBitset liveMask{ getLiveMask(secondDimension) };
 	// Go through all rows/columns
 	for (Index outer = 0; outer < firstDimension.size(); ++outer)
 	{
@@ -380,8 +371,8 @@ void Coverage::findDominatingVector(TableVector &firstDimension, TableVector &se
 				if (!firstDimension[inner].dropped)
 				{
 					// CHeck, who implies whowm. Maybe right to left or left to right
-					const bool outerImpliesInner{ checkForImplication(firstDimension[outer], firstDimension[inner]) };
-					const bool innerImpliesOuter{ checkForImplication(firstDimension[inner], firstDimension[outer])};
+					const bool outerImpliesInner{ checkForImplication(firstDimension[outer], firstDimension[inner], liveMask) };
+					const bool innerImpliesOuter{ checkForImplication(firstDimension[inner], firstDimension[outer], liveMask) };
 					sint bestCostFUnctionResult{ 0 };
 					// If both vectors are equal and a best cost function is existing then
 					if (outerImpliesInner && innerImpliesOuter && bcf)
@@ -444,47 +435,179 @@ ulong Coverage::countNotDroppedTableElements() noexcept
 	return counter;
 }
 
-// One vector may imply the other vector. One row/coulmn may imply the other row/column
-bool  Coverage::checkForImplication( TableCellVector &first,  TableCellVector &second)
+// Build the dense bitsets for all rows and columns. A row has a bit for every column and vice versa
+void Coverage::buildBitMatrix()
+{
+	for (TableCellVector& tcv : tableRows)
+	{
+		tcv.coverBit = DynamicBitset(tableColumns.size());
+		for (const TableCell& tc : tcv.cell)
+		{
+			tcv.coverBit.set(tc.crossReference);
+		}
+	}
+	for (TableCellVector& tcv : tableColumns)
+	{
+		tcv.coverBit = DynamicBitset(tableRows.size());
+		for (const TableCell& tc : tcv.cell)
+		{
+			tcv.coverBit.set(tc.crossReference);
+		}
+	}
+}
+
+
+// A bit for every not dropped row or column. A cell is dropped, if its row or its column is dropped
+// So the not dropped cells of a vector are its bitset AND the live mask of the other dimension
+DynamicBitset Coverage::getLiveMask(const TableVector& tableVector)
+{
+	DynamicBitset liveMask(tableVector.size());
+	for (Index index = 0; index < tableVector.size(); ++index)
+	{
+		if (!tableVector[index].dropped)
+		{
+			liveMask.set(index);
+		}
+	}
+	return liveMask;
+}
+
+
+// Rows with a common column belong to the same component. Grow a component, until no other row has a column in it
+std::vector<std::vector<std::size_t>> Coverage::findComponents(const std::vector<DynamicBitset>& cyclicCoreRow)
 {
-	// We assume Implication
-	bool result{ true };
-	// Now we iterate over the cells of a complete row or column
-	for (Index riFirst = 0; riFirst < first.cell.size() && result; ++riFirst)
+	std::vector<std::vector<std::size_t>> component;
+	std::vector<bool> isAssigned(cyclicCoreRow.size(), false);
+	for (std::size_t startRow = 0U; startRow < cyclicCoreRow.size(); ++startRow)
 	{
-		// If this has been dropped, then we need to check the other side 
-		// This (left) dropped and other side (second) is covering (and not dropped) means: No implication   
-		if (first.cell[riFirst].dropped)
+		if (!isAssigned[startRow])
 		{
-			TableCellCIterator tci{ std::find_if(second.cell.begin(), second.cell.end(), [first, riFirst](const TableCell & tc) { return tc.crossReference == first.cell[riFirst].crossReference; }) };
-			if ((second.cell.end() != tci) && (!tci->dropped))
+			std::vector<std::size_t> componentRow{ startRow };
+			isAssigned[startRow] = true;
+			DynamicBitset componentColumn{ cyclicCoreRow[startRow] };
+			bool componentGrew{ true };
+			while (componentGrew)
 			{
-				result = false;
+				componentGrew = false;
+				for (std::size_t row = startRow + 1U; row < cyclicCoreRow.size(); ++row)
+				{
+					if (!isAssigned[row] && cyclicCoreRow[row].intersects(componentColumn))
+					{
+						componentRow.push_back(row);
+						isAssigned[row] = true;
+						componentColumn |= cyclicCoreRow[row];
+						componentGrew = true;
+					}
+				}
 			}
+			std::sort(componentRow.begin(), componentRow.end());
+			component.push_back(std::move(componentRow));
 		}
 	}
+	return component;
+}
+
 
-	// Do next loop only if implication has not yet been evaluated as false
-	// Check from the viewpoint of the parameter second
-	for (Index riSecond = 0; riSecond < second.cell.size() && result; ++riSecond)
+// The sub table of the component has only the columns used by its rows. So the solver works on a small table
+// The resulting covers are translated back to the column indices of the complete table
+ProductTermVector Coverage::solveComponent(const std::vector<DynamicBitset>& cyclicCoreRow, const std::vector<std::size_t>& componentRow, const std::vector<uint>& columnCost)
+{
+	DynamicBitset componentColumn(cyclicCoreRow[componentRow[0]].size());
+	for (const std::size_t row : componentRow)
 	{
-		// if the right side (second) is not dropped
-		if (!second.cell[riSecond].dropped)
+		componentColumn |= cyclicCoreRow[row];
+	}
+	std::vector<std::size_t> originalColumn;
+	for (std::size_t column = componentColumn.findNext(0U); column < componentColumn.size(); column = componentColumn.findNext(column + 1U))
+	{
+		originalColumn.push_back(column);
+	}
+	std::vector<DynamicBitset> subTableRow(componentRow.size(), DynamicBitset(originalColumn.size()));
+	for (std::size_t subColumn = 0U; subColumn < originalColumn.size(); ++subColumn)
+	{
+		for (std::size_t subRow = 0U; subRow < componentRow.size(); ++subRow)
+		{
+			if (cyclicCoreRow[componentRow[subRow]].test(originalColumn[subColumn]))
+			{
+				subTableRow[subRow].set(subColumn);
+			}
+		}
+	}
+
+	ProductTermVector subCover;
+	if (programOption.option[ProgramOption::petrick].optionSelected)
+	{
+		// Initialize Input for Petricks method
+		// Build a conjunctive normal form CNF. One maxterm for each row with the columns, that cover the row
+		CNF cnf;
+		for (const DynamicBitset& row : subTableRow)
 		{
-			// Check the left side (first)
-			TableCellCIterator tci{ std::find_if(first.cell.begin(), first.cell.end(), [second, riSecond](const TableCell & tc) { return tc.crossReference == second.cell[riSecond].crossReference; }) };
-			// If there is nothing in that row or column and if the first is dropped
-			// Then no implication
-			if ((first.cell.end() == tci) || (tci->dropped))
+			DNF dnf;
+			for (std::size_t column = row.findNext(0U); column < row.size(); column = row.findNext(column + 1U))
 			{
-				result = false;
+				dnf.insert(ProductTerm{ narrow_cast<BooleanVariable>(column) });
 			}
+			cnf.push_back(dnf);
+		}
+		PetricksMethod petricksMethod(programOption.option[ProgramOption::petricktree].optionSelected);
+		subCover = petricksMethod(cnf);
+	}
+	else if (programOption.option[ProgramOption::zdd].optionSelected && !programOption.option[ProgramOption::onecover].optionSelected)
+	{
+		// The cheapest minimum covers with a ZDD (option -zdd). One cover is found faster by branch and bound
+		std::vector<uint> subColumnCost;
+		for (std::size_t subColumn = 0U; (subColumn < originalColumn.size()) && !columnCost.empty(); ++subColumn)
+		{
+			subColumnCost.push_back(columnCost[originalColumn[subColumn]]);
 		}
+		ZddCovering zddCovering(subColumnCost);
+		subCover = zddCovering(subTableRow);
+	}
+	else
+	{
+		// Search all minimum covers or only one (option -onecover)
+		BranchAndBoundCovering branchAndBoundCovering(!programOption.option[ProgramOption::onecover].optionSelected);
+		subCover = branchAndBoundCovering(subTableRow);
+	}
+
+	ProductTermVector result;
+	for (const ProductTerm& productTerm : subCover)
+	{
+		ProductTerm cover;
+		for (const BooleanVariable subColumn : productTerm)
+		{
+			cover.insert(narrow_cast<BooleanVariable>(originalColumn[subColumn]));
+		}
+		result.push_back(std::move(cover));
 	}
 	return result;
 }
 
 
+// The components have no common columns. A minimum cover of the complete core is the union of one minimum cover
+// of every component. So all minimum covers are all combinations. Sorted like the result of Petricks method
+ProductTermVector Coverage::combineComponentCovers(const std::vector<ProductTermVector>& componentCover)
+{
+	ProductTermVector combinedCover{ ProductTerm{} };
+	for (const ProductTermVector& cover : componentCover)
+	{
+		ProductTermVector nextCombinedCover;
+		for (const ProductTerm& productTermLeftSide : combinedCover)
+		{
+			for (const ProductTerm& productTermRightSide : cover)
+			{
+				ProductTerm productTerm{ productTermLeftSide };
+				productTerm.insert(productTermRightSide.begin(), productTermRightSide.end());
+				nextCombinedCover.push_back(std::move(productTerm));
+			}
+		}
+		combinedCover = std::move(nextCombinedCover);
+	}
+	const std::set<ProductTerm> sortedCover(combinedCover.begin(), combinedCover.end());
+	return ProductTermVector(sortedCover.begin(), sortedCover.end());
+}
+
+
 // Physically delete or row or a column. Only one.
 // Rows/columns can be dropped (marked as obsolete), but are then still part of the table
 // This function will erase them from the vector
@@ -527,21 +650,42 @@ void Coverage::eraseTableCellVector(TableVector &firstDimension, TableVector &se
 }
 
 // Go through all rows/columns in a table. Erase all rows/columns including contained cells
+// Erasing one vector after the other would need a pass over all cells of the other dimension for each erased vector.
+// So first the new index for every remaining vector is calculated, and then all cells are corrected in one pass
 void  Coverage::eraseAllDroppedTableCellVectors(TableVector &firstDimension, TableVector &secondDimension)
 {
-	// Iterate over complete table
-	TableVector::size_type index{ firstDimension.size() };
-	if (null< TableVector::size_type>() < index)
+	// New index of each vector. Erased vectors get this value
+	constexpr Index Erased{ std::numeric_limits<Index>::max() };
+	std::vector<Index> newIndex(firstDimension.size(), Erased);
+	Index numberOfRemainingVectors{ 0 };
+	for (Index index = 0; index < firstDimension.size(); ++index)
+	{
+		if (!firstDimension[index].dropped && (null<CellVector::size_type>() != firstDimension[index].cell.size()))
+		{
+			newIndex[index] = numberOfRemainingVectors++;
+		}
+	}
+	if (numberOfRemainingVectors != firstDimension.size())
 	{
-		do
+		// Erase the cells referencing an erased vector and correct the cross references of all others
+		for (TableCellVector& tcv : secondDimension)
+		{
+			CellVector::iterator cellEnd{ std::remove_if(tcv.cell.begin(), tcv.cell.end(), [&newIndex, Erased](const TableCell& tc) noexcept { return Erased == newIndex[tc.crossReference]; }) };
+			tcv.cell.erase(cellEnd, tcv.cell.end());
+			for (TableCell& tc : tcv.cell)
+			{
+				tc.crossReference = newIndex[tc.crossReference];
+			}
+		}
+		// Erase the vectors. The remaining vectors keep their order
+		for (Index index = 0; index < firstDimension.size(); ++index)
 		{
-			--index;
-			if (firstDimension[index].dropped ||
-				(null<CellVector::size_type>() == firstDimension[index].cell.size()))
+			if ((Erased != newIndex[index]) && (newIndex[index] != index))
 			{
-				eraseTableCellVector(firstDimension, secondDimension, narrow_cast<Index>(index));
+				firstDimension[newIndex[index]] = std::move(firstDimension[index]);
 			}
-		} while (index != 0);
+		}
+		firstDimension.resize(numberOfRemainingVectors);
 	}
 }
 
@@ -573,6 +717,11 @@ CoverageResult Coverage::getCoverageResultWithoutReduction()
 
 CoverageResult Coverage::reduce(std::ostream& os)
 {
+	// Time and counters for option -stats
+	StageTimer stageTimer("Coverage");
+	stageTimer().add("rows", tableRows.size());
+	stageTimer().add("columns", tableColumns.size());
+
 	// We compare the number of dropped cell before an operation and after an operation
 	// to detect, if something could be reduced or not
 	ulong oldNumberOfNoneDroppedCells{ 0 };
@@ -581,6 +730,9 @@ CoverageResult Coverage::reduce(std::ostream& os)
 	// Simply count the reduction loops and display the number
 	uint reductionLoopCounter{ 1 };
 
+	// The dense bitsets for the reduction operations
+	buildBitMatrix();
+
 	// Show header and initial full table
 	os << "------------------ Analysis of coverage and reduction\n\n";
 	printTable(os);
@@ -687,6 +839,8 @@ CoverageResult Coverage::reduce(std::ostream& os)
 		newNumberOfNoneDroppedCells = countNotDroppedTableElements();
 
 	} while ((null<ulong>() != newNumberOfNoneDroppedCells) && (newNumberOfNoneDroppedCells != oldNumberOfNoneDroppedCells));
+	stageTimer().add("reductionLoops", reductionLoopCounter - 1U);
+	stageTimer().add("essentialColumns", essentialColumn.size());
 
 
 	// All conventional reduction operation performed
@@ -695,36 +849,54 @@ CoverageResult Coverage::reduce(std::ostream& os)
 	{
 		os << "\n\n------------------ Could not reduce Tables further.   Cyclic Core Left\n";
 		printTable(os);
-		os << "------------------ Using Petricks Method to Calculate Coverage Sets\n";
-
+		if (programOption.option[ProgramOption::petrick].optionSelected)
+		{
+			os << "------------------ Using Petricks Method to Calculate Coverage Sets\n";
+		}
+		else if (programOption.option[ProgramOption::zdd].optionSelected && !programOption.option[ProgramOption::onecover].optionSelected)
+		{
+			os << "------------------ Using Zero-Suppressed Decision Diagram to Calculate Coverage Sets\n";
+		}
+		else
+		{
+			os << "------------------ Using Branch and Bound to Calculate Coverage Sets\n";
+		}
 
-		// Initialize Input for Petricks method
-		// Build a conjunctive normal form CNF
-		CNF cnf;
-		// Fill maxterm with Primimplicnats that cover a minterm
-		// Iterate over rows
-		for (Index indexRow = 0; indexRow < tableRows.size(); ++indexRow)
+		// The cyclic core as rows of bits. Only cells in not dropped columns
+		const DynamicBitset liveColumn{ getLiveMask(tableColumns) };
+		std::vector<DynamicBitset> cyclicCoreRow;
+		for (const TableCellVector& tcv : tableRows)
 		{
-			if (!tableRows[indexRow].dropped)
+			if (!tcv.dropped)
 			{
-				// A conjunctive form is a conjunction of disjunctive forms (product terms)
-				DNF dnf;
-				for (Index indexColumn = 0; indexColumn < tableRows[indexRow].cell.size(); ++indexColumn)
-				{
-					// Combine the index of columns that cover a row to a product term
-					ProductTerm productTerm;
-					productTerm.insert(tableRows[indexRow].cell[indexColumn].crossReference);
-					dnf.insert(productTerm);
-				}
-				cnf.push_back(dnf);
+				cyclicCoreRow.push_back(tcv.coverBit);
+				cyclicCoreRow.back() &= liveColumn;
 			}
 		}
 
-		// Instantiate Petricks Method
-
-		PetricksMethod petricksMethod;
-		// And evaluate the result
-		coverageSet = petricksMethod(cnf);
+		// The cyclic core often consists of independent blocks without common rows or columns
+		// Each block is solved on its own and in parallel. The effort depends then on the biggest block
+		const std::vector<std::vector<std::size_t>> component{ findComponents(cyclicCoreRow) };
+		std::vector<uint> columnCost;
+		if (columnCostCalculator)
+		{
+			for (const TableCellVector& tcv : tableColumns)
+			{
+				columnCost.push_back(columnCostCalculator(tcv.cellVectorHeader));
+			}
+		}
+		if (component.size() > 1U)
+		{
+			os << "------------------ Cyclic Core consists of " << component.size() << " independent components\n";
+		}
+		std::vector<ProductTermVector> componentCover(component.size());
+		threadPool().parallelFor(0U, narrow_cast<uint>(component.size()), 1U, [&cyclicCoreRow, &component, &componentCover, &columnCost](uint index)
+		{
+			componentCover[index] = solveComponent(cyclicCoreRow, component[index], columnCost);
+		});
+		coverageSet = combineComponentCovers(componentCover);
+		stageTimer().add("cyclicCoreRows", cyclicCoreRow.size());
+		stageTimer().add("cyclicCoreComponents", component.size());
 
 	}
 
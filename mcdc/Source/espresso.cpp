@@ -0,0 +1,435 @@
+// --------------------------------------------------------------------------------------------------------------------------------
+// License:	BSD-3-Clause
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Copyright 2019      Armin Montigny
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+// following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the 
+//    following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the 
+//    following disclaimer in the documentation and /or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or 
+//    promote products derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+
+
+// Heuristic minimization of boolean expressions. Please see the description in espresso.hpp
+
+
+#include "espresso.hpp"
+#include "cloption.hpp"
+#include "statistics.hpp"
+
+#include <algorithm>
+#include <iostream>
+
+
+namespace
+{
+	// Lanes in a truth table word, where bit j of the lane index is set
+	constexpr std::array<TruthTableWord, NumberOfLaneBitsInTruthTableWord> lanesWithIndexBitSet
+	{
+		0xAAAAAAAAAAAAAAAAULL, 0xCCCCCCCCCCCCCCCCULL, 0xF0F0F0F0F0F0F0F0ULL,
+		0xFF00FF00FF00FF00ULL, 0xFFFF0000FFFF0000ULL, 0xFFFFFFFF00000000ULL
+	};
+
+	// Number of eliminated variables in a cube
+	inline uint numberOfEliminatedVariables(const PrimeImplicantType<uint32_t>& cube) noexcept { return narrow_cast<uint>(numberOfSetBits(cube.mask)); }
+}
+
+
+
+// Main interface. Run the heuristic and build the DNF string
+std::string Espresso::getMinimumDisjunctiveNormalForm(const TruthTable& truthTableForMinimization, const SymbolTable& symbolTable, const std::string& source)
+{
+	// Time and counters for option -stats
+	StageTimer stageTimer("Espresso");
+
+	truthTable = &truthTableForMinimization;
+	numberOfVariables = truthTable->getNumberOfVariables();
+	allVariables = narrow_cast<CubeTermType>((1ULL << numberOfVariables) - 1ULL);
+
+	// Reset the cover and the counters
+	cover.clear();
+	coverCount.assign(static_cast<std::size_t>(truthTable->numberOfInputValues()), 0U);
+	coverCountOverflow.clear();
+	coveredOnce.assign(truthTable->getWords().size(), null<TruthTableWord>());
+	coveredTwice.assign(truthTable->getWords().size(), null<TruthTableWord>());
+
+	// Start cover with prime implicants and without redundant cubes
+	createInitialCover();
+	stageTimer().add("initialCubes", cover.size());
+	irredundant();
+
+	// Improve, as long as it gets better
+	Cost bestCost{ getCost() };
+	Cover bestCover{ cover };
+	uint numberOfIterations{ 0U };
+	while (numberOfIterations < MaxNumberOfIterations)
+	{
+		++numberOfIterations;
+		reduce();
+		expandCover();
+		irredundant();
+
+		const Cost cost{ getCost() };
+		if (!(cost < bestCost))
+		{
+			break;
+		}
+		bestCost = cost;
+		bestCover = cover;
+	}
+	cover = std::move(bestCover);
+	stageTimer().add("variables", numberOfVariables);
+	stageTimer().add("iterations", numberOfIterations);
+	stageTimer().add("terms", bestCost.first);
+	stageTimer().add("literals", bestCost.second);
+
+	// Build minimum disjunctive normal form, as a string. Same format and order of terms as for Quine&  McCluskey
+	std::vector<std::string> termString;
+	for (const Cube& cube : cover)
+	{
+		termString.push_back(cube.toString(symbolTable));
+	}
+	std::sort(termString.begin(), termString.end());
+	std::string minimumDisjunctiveNormalForm;
+	for (const std::string& ts : termString)
+	{
+		if (!minimumDisjunctiveNormalForm.empty())
+		{
+			minimumDisjunctiveNormalForm += "+";
+		}
+		minimumDisjunctiveNormalForm += ts;
+	}
+
+	// Output control is the same as for the result of the prime implicant table
+	const bool predicateForOutputToFile{ (symbolTable.numberOfSymbols() > 5) };
+	OutStreamSelection outStreamSelection(ProgramOption::ppirtc, predicateForOutputToFile);
+	std::ostream& os{ outStreamSelection() };
+
+	os << "\n\n\n------------------ Heuristic (Espresso like) minimization for boolean expression:\n\n'" << source << "'\n\n";
+	os << "Number of terms: " << bestCost.first << "   Number of literals: " << bestCost.second << "   Iterations: " << numberOfIterations << "\n";
+	os << "\n\n------------------ Minimum DNF:\n\n" << minimumDisjunctiveNormalForm << "\n\n------------------\n\n";
+	return minimumDisjunctiveNormalForm;
+}
+
+
+// The cubes as strings, for example for the result cache
+std::vector<std::string> Espresso::getPrimeImplicants(const SymbolTable& symbolTable) const
+{
+	std::vector<std::string> result;
+	for (const Cube& cube : cover)
+	{
+		result.push_back(cube.toString(symbolTable));
+	}
+	return result;
+}
+
+
+// Number of cubes and number of literals in the cover
+Espresso::Cost Espresso::getCost() const
+{
+	uint numberOfLiterals{ 0U };
+	for (const Cube& cube : cover)
+	{
+		numberOfLiterals += numberOfVariables - numberOfEliminatedVariables(cube);
+	}
+	return Cost(narrow_cast<uint>(cover.size()), numberOfLiterals);
+}
+
+
+
+// -----------------------------------------
+// The steps of the heuristic
+
+
+// Go through the truth table. If a minterm is not yet covered, then it is expanded to a prime implicant
+// Expanding adds the new minterms to the cover counters. So we need to check again after each expansion
+void Espresso::createInitialCover()
+{
+	const TruthTableWordStream& word{ truthTable->getWords() };
+	for (std::size_t wordIndex = 0U; wordIndex < word.size(); ++wordIndex)
+	{
+		TruthTableWord notCovered{ word[wordIndex] & ~coveredOnce[wordIndex] };
+		while (null<TruthTableWord>() != notCovered)
+		{
+			const CubeTermType minterm{ narrow_cast<CubeTermType>((wordIndex << NumberOfLaneBitsInTruthTableWord) + indexOfLowestSetBitInTruthTableWord(notCovered)) };
+			incrementCoverCount(minterm);
+			cover.push_back(expand(Cube(minterm, 0U)));
+			notCovered = word[wordIndex] & ~coveredOnce[wordIndex];
+		}
+	}
+}
+
+
+// Eliminate one variable after the other, as long as the cube is an implicant
+// Eliminating a variable doubles the cube. The new part is the cube with this variable inverted
+// From all possible variables, we take the one with the best gain for the new part
+Espresso::Cube Espresso::expand(Cube cube)
+{
+	bool variableEliminated{ true };
+	while (variableEliminated)
+	{
+		variableEliminated = false;
+		CubeTermType bestVariable{ 0U };
+		ull bestGain{ 0ULL };
+
+		// Try all variables, that are still in the cube
+		CubeTermType remainingVariables{ static_cast<CubeTermType>(allVariables & ~cube.mask) };
+		while (remainingVariables)
+		{
+			const CubeTermType variable{ static_cast<CubeTermType>(remainingVariables & (~remainingVariables + 1U)) };
+			remainingVariables = static_cast<CubeTermType>(remainingVariables ^ variable);
+
+			const Cube part(static_cast<CubeTermType>(cube.term ^ variable), cube.mask);
+			if (isImplicant(part))
+			{
+				const ull gain{ gainForPart(part) };
+				if (!variableEliminated || (gain > bestGain))
+				{
+					variableEliminated = true;
+					bestVariable = variable;
+					bestGain = gain;
+				}
+			}
+		}
+		if (variableEliminated)
+		{
+			// Count the new minterms and make the cube bigger
+			forEachMintermOfCube(Cube(static_cast<CubeTermType>(cube.term ^ bestVariable), cube.mask), [this](CubeTermType minterm) { incrementCoverCount(minterm); });
+			cube = Cube(static_cast<CubeTermType>(cube.term & ~bestVariable), static_cast<CubeTermType>(cube.mask | bestVariable));
+		}
+	}
+	return cube;
+}
+
+
+// Expand all cubes. Small cubes first, they have the best chance to grow
+void Espresso::expandCover()
+{
+	std::stable_sort(cover.begin(), cover.end(), [](const Cube& lhs, const Cube& rhs) noexcept { return numberOfEliminatedVariables(lhs) < numberOfEliminatedVariables(rhs); });
+	for (Cube& cube : cover)
+	{
+		cube = expand(cube);
+	}
+}
+
+
+// Remove cubes, where all minterms are covered by other cubes
+// Small cubes are checked first. So we keep the big ones with few literals
+void Espresso::irredundant()
+{
+	std::stable_sort(cover.begin(), cover.end(), [](const Cube& lhs, const Cube& rhs) noexcept { return numberOfEliminatedVariables(lhs) < numberOfEliminatedVariables(rhs); });
+	Cover irredundantCover;
+	for (const Cube& cube : cover)
+	{
+		if (isRedundant(cube))
+		{
+			forEachMintermOfCube(cube, [this](CubeTermType minterm) { decrementCoverCount(minterm); });
+		}
+		else
+		{
+			irredundantCover.push_back(cube);
+		}
+	}
+	cover = std::move(irredundantCover);
+}
+
+
+// Shrink every cube to the smallest cube, that contains all minterms, that are covered by no other cube
+// Big cubes first. Every reduction changes the counters for the following cubes
+void Espresso::reduce()
+{
+	std::stable_sort(cover.begin(), cover.end(), [](const Cube& lhs, const Cube& rhs) noexcept { return numberOfEliminatedVariables(lhs) > numberOfEliminatedVariables(rhs); });
+	Cover reducedCover;
+	for (const Cube& cube : cover)
+	{
+		// Build the smallest cube containing all minterms that are covered only once. So by this cube
+		// Bits, that are set in all these minterms, are set in the term. Bits, that differ, will be eliminated
+		bool hasOwnMinterm{ false };
+		CubeTermType allSet{ allVariables };
+		CubeTermType anySet{ 0U };
+		forEachWordOfCube(cube, [this, &hasOwnMinterm, &allSet, &anySet](std::size_t wordIndex, TruthTableWord lanes)
+		{
+			const TruthTableWord ownMinterms{ lanes & coveredOnce[wordIndex] & ~coveredTwice[wordIndex] };
+			if (null<TruthTableWord>() != ownMinterms)
+			{
+				hasOwnMinterm = true;
+				// Upper bits come from the word index, the lower bits from the lane index
+				CubeTermType allSetInWord{ narrow_cast<CubeTermType>(wordIndex << NumberOfLaneBitsInTruthTableWord) };
+				CubeTermType anySetInWord{ allSetInWord };
+				for (uint laneBit = 0U; laneBit < NumberOfLaneBitsInTruthTableWord; ++laneBit)
+				{
+					if (null<TruthTableWord>() == (ownMinterms & ~lanesWithIndexBitSet[laneBit])) allSetInWord |= (1U << laneBit);
+					if (null<TruthTableWord>() != (ownMinterms & lanesWithIndexBitSet[laneBit])) anySetInWord |= (1U << laneBit);
+				}
+				allSet &= allSetInWord;
+				anySet |= anySetInWord;
+			}
+			return true;
+		});
+
+		if (hasOwnMinterm)
+		{
+			const Cube reducedCube(static_cast<CubeTermType>(allSet & allVariables), static_cast<CubeTermType>((allSet ^ anySet) & allVariables));
+			if ((reducedCube.term != cube.term) || (reducedCube.mask != cube.mask))
+			{
+				// Minterms outside of the reduced cube are no longer covered by this cube
+				forEachMintermOfCube(cube, [this, &reducedCube](CubeTermType minterm) 
+				{ 
+					if (static_cast<CubeTermType>(minterm & ~reducedCube.mask) != reducedCube.term) decrementCoverCount(minterm);
+				});
+			}
+			reducedCover.push_back(reducedCube);
+		}
+		else
+		{
+			// Other cubes took over all minterms of this cube
+			forEachMintermOfCube(cube, [this](CubeTermType minterm) { decrementCoverCount(minterm); });
+		}
+	}
+	cover = std::move(reducedCover);
+}
+
+
+
+// -----------------------------------------
+// Helper funcions
+
+
+// All minterms of the cube must be set in the truth table
+bool Espresso::isImplicant(const Cube& cube) const
+{
+	const TruthTableWordStream& word{ truthTable->getWords() };
+	bool result{ true };
+	forEachWordOfCube(cube, [&word, &result](std::size_t wordIndex, TruthTableWord lanes)
+	{
+		result = (lanes == (word[wordIndex] & lanes));
+		return result;
+	});
+	return result;
+}
+
+// All minterms of the cube must be covered at least twice. Once by the cube itself and once by another cube
+bool Espresso::isRedundant(const Cube& cube) const
+{
+	bool result{ true };
+	forEachWordOfCube(cube, [this, &result](std::size_t wordIndex, TruthTableWord lanes)
+	{
+		result = (lanes == (coveredTwice[wordIndex] & lanes));
+		return result;
+	});
+	return result;
+}
+
+// Minterms, that are not covered yet, are most important. Then minterms covered by only one other cube
+// Covering them may make the other cube redundant
+ull Espresso::gainForPart(const Cube& part) const
+{
+	ull numberOfNotCovered{ 0ULL };
+	ull numberOfCoveredOnce{ 0ULL };
+	forEachWordOfCube(part, [this, &numberOfNotCovered, &numberOfCoveredOnce](std::size_t wordIndex, TruthTableWord lanes)
+	{
+		numberOfNotCovered += numberOfSetBitsInTruthTableWord(lanes & ~coveredOnce[wordIndex]);
+		numberOfCoveredOnce += numberOfSetBitsInTruthTableWord(lanes & coveredOnce[wordIndex] & ~coveredTwice[wordIndex]);
+		return true;
+	});
+	return (numberOfNotCovered << 32U) | numberOfCoveredOnce;
+}
+
+
+// The lower 6 bits of a minterm are the lane in a truth table word, the upper bits are the word index
+// The eliminated lower bits give the lanes, the eliminated upper bits give the words of the cube
+// All subsets of a mask are enumerated with s = (s - mask) & mask. Starting with 0 and ending with 0
+template <typename Function>
+void Espresso::forEachWordOfCube(const Cube& cube, Function function) const
+{
+	constexpr CubeTermType laneBits{ NumberOfLanesInTruthTableWord - 1U };
+	const CubeTermType laneTerm{ static_cast<CubeTermType>(cube.term & laneBits) };
+	const CubeTermType laneMask{ static_cast<CubeTermType>(cube.mask & laneBits) };
+	TruthTableWord lanes{ null<TruthTableWord>() };
+	CubeTermType subset{ 0U };
+	do
+	{
+		lanes |= (1ULL << (laneTerm | subset));
+		subset = static_cast<CubeTermType>((subset - laneMask) & laneMask);
+	} while (subset);
+
+	const CubeTermType wordMask{ static_cast<CubeTermType>(cube.mask & ~laneBits) };
+	subset = 0U;
+	do
+	{
+		if (!function(static_cast<std::size_t>((cube.term | subset) >> NumberOfLaneBitsInTruthTableWord), lanes))
+		{
+			break;
+		}
+		subset = static_cast<CubeTermType>((subset - wordMask) & wordMask);
+	} while (subset);
+}
+
+template <typename Function>
+void Espresso::forEachMintermOfCube(const Cube& cube, Function function) const
+{
+	CubeTermType subset{ 0U };
+	do
+	{
+		function(static_cast<CubeTermType>(cube.term | subset));
+		subset = static_cast<CubeTermType>((subset - cube.mask) & cube.mask);
+	} while (subset);
+}
+
+
+// The counter is a byte. If it is saturated, then the overflow map is used
+void Espresso::incrementCoverCount(CubeTermType minterm)
+{
+	uint8_t& count{ coverCount[minterm] };
+	if (SaturatedCoverCount == count)
+	{
+		++coverCountOverflow[minterm];
+	}
+	else
+	{
+		++count;
+		const TruthTableWord lane{ 1ULL << (minterm & (NumberOfLanesInTruthTableWord - 1U)) };
+		if (1U == count) coveredOnce[minterm >> NumberOfLaneBitsInTruthTableWord] |= lane;
+		if (2U == count) coveredTwice[minterm >> NumberOfLaneBitsInTruthTableWord] |= lane;
+	}
+}
+
+void Espresso::decrementCoverCount(CubeTermType minterm)
+{
+	uint8_t& count{ coverCount[minterm] };
+	if (SaturatedCoverCount == count)
+	{
+		const std::unordered_map<CubeTermType, uint>::iterator overflow{ coverCountOverflow.find(minterm) };
+		if (coverCountOverflow.end() != overflow)
+		{
+			if (0U == --overflow->second)
+			{
+				coverCountOverflow.erase(overflow);
+			}
+			return;
+		}
+	}
+	--count;
+	const TruthTableWord lane{ 1ULL << (minterm & (NumberOfLanesInTruthTableWord - 1U)) };
+	if (1U == count) coveredTwice[minterm >> NumberOfLaneBitsInTruthTableWord] &= ~lane;
+	if (0U == count) coveredOnce[minterm >> NumberOfLaneBitsInTruthTableWord] &= ~lane;
+}
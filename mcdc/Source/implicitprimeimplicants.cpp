@@ -0,0 +1,488 @@
+// --------------------------------------------------------------------------------------------------------------------------------
+// License:	BSD-3-Clause
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Copyright 2019      Armin Montigny
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+// following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the 
+//    following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the 
+//    following disclaimer in the documentation and /or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or 
+//    promote products derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+
+
+// Calculation of prime implicants directly from the boolean expression. Please see the description in implicitprimeimplicants.hpp
+
+
+#include "implicitprimeimplicants.hpp"
+#include "cloption.hpp"
+#include "statistics.hpp"
+
+#include <algorithm>
+#include <iostream>
+
+
+namespace
+{
+	using CubeForCalculation = PrimeImplicantType<uint32_t>;
+
+	// Check, if cube lhs is completely contained in cube rhs. All literals of rhs must be in lhs
+	inline bool isContainedIn(const CubeForCalculation& lhs, const CubeForCalculation& rhs) noexcept
+	{
+		return (0U == (lhs.mask & ~rhs.mask)) && (0U == ((lhs.term ^ rhs.term) & ~rhs.mask));
+	}
+
+	inline bool isEqual(const CubeForCalculation& lhs, const CubeForCalculation& rhs) noexcept
+	{
+		return (lhs.term == rhs.term) && (lhs.mask == rhs.mask);
+	}
+}
+
+
+// The implicit calculation is used, if selected by option, or if the truth table would be big
+bool ImplicitPrimeImplicants::isSelectedFor(uint numberOfVariables) noexcept
+{
+	return programOption.option[ProgramOption::ipi].optionSelected || (numberOfVariables > MaxNumberOfVariablesForTruthTable);
+}
+
+
+// Run the object code symbolically. The registers are cube lists. Then calculate the prime implicants
+bool ImplicitPrimeImplicants::calculate(ObjectCode objectCode)
+{
+	// Time and counters for option -stats
+	StageTimer stageTimer("ImplicitPrimeImplicants");
+	stageTimer().add("vmProgramLength", objectCode.opCode.size());
+
+	// Map the symbols to bit positions. Exactly like the virtual machine
+	objectCode.symbolTable.compact();
+	numberOfVariables = objectCode.symbolTable.numberOfSymbols();
+	allVariables = narrow_cast<CubeTermType>((1ULL << numberOfVariables) - 1ULL);
+	cubeLimitExceeded = false;
+	primeImplicant.clear();
+
+	// Find the number of needed registers
+	uint maxRegister{ 0U };
+	for (const OpCodeLine& opCodeLine : objectCode.opCode)
+	{
+		maxRegister = std::max({ maxRegister, opCodeLine.parameter2, (Token::ID == opCodeLine.token) || (Token::IDNOT == opCodeLine.token) ? 0U : opCodeLine.parameter1,
+								(Token::OR == opCodeLine.token) || (Token::XOR == opCodeLine.token) || (Token::AND == opCodeLine.token) ? opCodeLine.parameter3 : 0U });
+	}
+	std::vector<Cover> machineRegister(static_cast<std::size_t>(maxRegister) + 1U);
+	Cover result;
+
+	for (const OpCodeLine& opCodeLine : objectCode.opCode)
+	{
+		switch (opCodeLine.token)
+		{
+		case Token::ID:
+			machineRegister[opCodeLine.parameter2] = literal(narrow_cast<CubeTermType>(bitMask[objectCode.symbolTable.normalizedInput[opCodeLine.parameter1]]), false);
+			break;
+		case Token::IDNOT:
+			machineRegister[opCodeLine.parameter2] = literal(narrow_cast<CubeTermType>(bitMask[objectCode.symbolTable.normalizedInput[opCodeLine.parameter1]]), true);
+			break;
+		case Token::OR:
+			machineRegister[opCodeLine.parameter3] = unionOf(machineRegister[opCodeLine.parameter1], machineRegister[opCodeLine.parameter2]);
+			break;
+		case Token::XOR:
+		{
+			// a^b = a!b + !ab
+			const Cover& lhs{ machineRegister[opCodeLine.parameter1] };
+			const Cover& rhs{ machineRegister[opCodeLine.parameter2] };
+			Cover lhsAndNotRhs{ intersectionOf(lhs, complementOf(rhs)) };
+			Cover notLhsAndRhs{ intersectionOf(complementOf(lhs), rhs) };
+			machineRegister[opCodeLine.parameter3] = unionOf(lhsAndNotRhs, notLhsAndRhs);
+		}
+			break;
+		case Token::AND:
+			machineRegister[opCodeLine.parameter3] = intersectionOf(machineRegister[opCodeLine.parameter1], machineRegister[opCodeLine.parameter2]);
+			break;
+		case Token::NOT:
+			machineRegister[opCodeLine.parameter2] = complementOf(machineRegister[opCodeLine.parameter1]);
+			break;
+		case Token::END:
+			result = machineRegister[opCodeLine.parameter1];
+			break;
+#pragma warning(suppress: 4061)
+#pragma warning(suppress: 4062)
+		default: break;
+		}
+		// Too many cubes. Give up
+		if (cubeLimitExceeded)
+		{
+			stageTimer().add("cubeLimitExceeded", 1U);
+			return false;
+		}
+	}
+
+	calculatePrimeImplicants(std::move(result));
+	stageTimer().add("variables", numberOfVariables);
+	stageTimer().add("cubeLimitExceeded", cubeLimitExceeded ? 1U : 0U);
+	stageTimer().add("primeImplicants", primeImplicant.size());
+	return !cubeLimitExceeded;
+}
+
+
+
+// -----------------------------------------
+// Operations on cube lists
+
+
+// One cube with one literal. All other variables are eliminated
+ImplicitPrimeImplicants::Cover ImplicitPrimeImplicants::literal(CubeTermType variable, bool negated) const
+{
+	return Cover{ Cube(negated ? 0U : variable, static_cast<CubeTermType>(allVariables & ~variable)) };
+}
+
+// a+b. All cubes of both lists
+ImplicitPrimeImplicants::Cover ImplicitPrimeImplicants::unionOf(const Cover& lhs, const Cover& rhs)
+{
+	Cover result{ lhs };
+	result.insert(result.end(), rhs.begin(), rhs.end());
+	result = absorb(std::move(result));
+	cubeLimitExceeded = cubeLimitExceeded || (result.size() > MaxNumberOfCubes);
+	return result;
+}
+
+// ab. All pairs of cubes, that do not have a variable in different polarity
+ImplicitPrimeImplicants::Cover ImplicitPrimeImplicants::intersectionOf(const Cover& lhs, const Cover& rhs)
+{
+	Cover result;
+	for (const Cube& cubeLhs : lhs)
+	{
+		for (const Cube& cubeRhs : rhs)
+		{
+			if (0U == ((cubeLhs.term ^ cubeRhs.term) & ~cubeLhs.mask & ~cubeRhs.mask))
+			{
+				result.push_back(Cube(cubeLhs.term | cubeRhs.term, cubeLhs.mask & cubeRhs.mask));
+			}
+		}
+		// The absorption will reduce the list. But we need to stop somewhere
+		if (result.size() > MaxNumberOfCubes * lhs.size())
+		{
+			cubeLimitExceeded = true;
+			return Cover{};
+		}
+	}
+	result = absorb(std::move(result));
+	cubeLimitExceeded = cubeLimitExceeded || (result.size() > MaxNumberOfCubes);
+	return result;
+}
+
+// !a. Shannon expansion: !f = x!f(x=1) + !x!f(x=0)
+ImplicitPrimeImplicants::Cover ImplicitPrimeImplicants::complementOf(const Cover& cover)
+{
+	Cover result;
+	if (cubeLimitExceeded)
+	{
+		// Nothing to do any longer
+	}
+	else if (cover.empty())
+	{
+		// Always false. Complement is always true
+		result.push_back(Cube(0U, allVariables));
+	}
+	else if (std::any_of(cover.begin(), cover.end(), [this](const Cube& cube) noexcept { return allVariables == cube.mask; }))
+	{
+		// Always true. Complement is always false
+	}
+	else if (1U == cover.size())
+	{
+		// De Morgan. !(abc) = !a+!b+!c
+		const Cube& cube{ cover.front() };
+		CubeTermType remainingVariables{ static_cast<CubeTermType>(allVariables & ~cube.mask) };
+		while (remainingVariables)
+		{
+			const CubeTermType variable{ static_cast<CubeTermType>(remainingVariables & (~remainingVariables + 1U)) };
+			remainingVariables = static_cast<CubeTermType>(remainingVariables ^ variable);
+			result.push_back(literal(variable, 0U != (cube.term & variable)).front());
+		}
+	}
+	else
+	{
+		// Split on the variable, that is used most
+		const CubeTermType variable{ splittingVariable(cover, false) };
+		Cover complementForTrue{ complementOf(cofactorOf(cover, variable, true)) };
+		Cover complementForFalse{ complementOf(cofactorOf(cover, variable, false)) };
+		std::sort(complementForTrue.begin(), complementForTrue.end(), PrimeImplicantTypeCompare<CubeTermType>());
+		std::sort(complementForFalse.begin(), complementForFalse.end(), PrimeImplicantTypeCompare<CubeTermType>());
+
+		// Cubes in both complements do not need the variable. All others get the literal for their side
+		std::vector<Cube>::const_iterator cubeForTrue{ complementForTrue.begin() };
+		std::vector<Cube>::const_iterator cubeForFalse{ complementForFalse.begin() };
+		const PrimeImplicantTypeCompare<CubeTermType> cubeCompare;
+		while ((complementForTrue.end() != cubeForTrue) || (complementForFalse.end() != cubeForFalse))
+		{
+			if ((complementForTrue.end() != cubeForTrue) && (complementForFalse.end() != cubeForFalse) && isEqual(*cubeForTrue, *cubeForFalse))
+			{
+				result.push_back(*cubeForTrue);
+				++cubeForTrue;
+				++cubeForFalse;
+			}
+			else if ((complementForFalse.end() == cubeForFalse) || ((complementForTrue.end() != cubeForTrue) && cubeCompare(*cubeForTrue, *cubeForFalse)))
+			{
+				result.push_back(Cube(cubeForTrue->term | variable, static_cast<CubeTermType>(cubeForTrue->mask & ~variable)));
+				++cubeForTrue;
+			}
+			else
+			{
+				result.push_back(Cube(cubeForFalse->term, static_cast<CubeTermType>(cubeForFalse->mask & ~variable)));
+				++cubeForFalse;
+			}
+		}
+		result = absorb(std::move(result));
+		cubeLimitExceeded = cubeLimitExceeded || (result.size() > MaxNumberOfCubes);
+	}
+	return result;
+}
+
+
+// Absorption law. a+ab = a
+// Big cubes (few literals) first. Then a cube can only be contained in a cube, that is already in the result
+ImplicitPrimeImplicants::Cover ImplicitPrimeImplicants::absorb(Cover cover)
+{
+	std::sort(cover.begin(), cover.end(), [](const Cube& lhs, const Cube& rhs) noexcept
+		{
+			const NumberOfBitsCountType lhsSize{ numberOfSetBits(lhs.mask) };
+			const NumberOfBitsCountType rhsSize{ numberOfSetBits(rhs.mask) };
+			return (lhsSize > rhsSize) || ((lhsSize == rhsSize) && PrimeImplicantTypeCompare<CubeTermType>()(lhs, rhs));
+		});
+	Cover result;
+	for (const Cube& cube : cover)
+	{
+		if (std::none_of(result.begin(), result.end(), [&cube](const Cube& biggerCube) noexcept { return isContainedIn(cube, biggerCube); }))
+		{
+			result.push_back(cube);
+		}
+	}
+	return result;
+}
+
+// Set the variable to a value. Cubes with the other polarity of the variable drop out
+ImplicitPrimeImplicants::Cover ImplicitPrimeImplicants::cofactorOf(const Cover& cover, CubeTermType variable, bool value)
+{
+	Cover result;
+	for (const Cube& cube : cover)
+	{
+		if ((0U != (cube.mask & variable)) || ((0U != (cube.term & variable)) == value))
+		{
+			result.push_back(Cube(static_cast<CubeTermType>(cube.term & ~variable), cube.mask | variable));
+		}
+	}
+	return result;
+}
+
+// Count for all variables, how often they are used in positive and negative form
+ImplicitPrimeImplicants::CubeTermType ImplicitPrimeImplicants::splittingVariable(const Cover& cover, bool binateOnly) const
+{
+	CubeTermType result{ 0U };
+	std::size_t bestCount{ 0U };
+	bool bestIsBinate{ false };
+	for (uint bitPosition = 0U; bitPosition < numberOfVariables; ++bitPosition)
+	{
+		const CubeTermType variable{ narrow_cast<CubeTermType>(bitMask[bitPosition]) };
+		std::size_t countPositive{ 0U };
+		std::size_t countNegative{ 0U };
+		for (const Cube& cube : cover)
+		{
+			if (0U == (cube.mask & variable))
+			{
+				if (cube.term & variable) ++countPositive; else ++countNegative;
+			}
+		}
+		const bool isBinate{ (countPositive > 0U) && (countNegative > 0U) };
+		const std::size_t count{ countPositive + countNegative };
+		if ((isBinate || !binateOnly) && (count > 0U) && ((isBinate && !bestIsBinate) || ((isBinate == bestIsBinate) && (count > bestCount))))
+		{
+			result = variable;
+			bestCount = count;
+			bestIsBinate = isBinate;
+		}
+	}
+	return result;
+}
+
+
+
+// -----------------------------------------
+// Prime implicants
+
+
+// Method of Tison. For one variable after the other, add all consensus terms and remove contained cubes
+void ImplicitPrimeImplicants::calculatePrimeImplicants(Cover cover)
+{
+	cover = absorb(std::move(cover));
+	for (uint bitPosition = 0U; (bitPosition < numberOfVariables) && !cubeLimitExceeded; ++bitPosition)
+	{
+		const CubeTermType variable{ narrow_cast<CubeTermType>(bitMask[bitPosition]) };
+		Cover consensus;
+		for (const Cube& positive : cover)
+		{
+			if ((0U != (positive.mask & variable)) || (0U == (positive.term & variable))) continue;
+			for (const Cube& negative : cover)
+			{
+				if ((0U != (negative.mask & variable)) || (0U != (negative.term & variable))) continue;
+				// xA and !xB. If A and B have no other variable in different polarity, then AB is the consensus
+				if (0U == ((positive.term ^ negative.term) & ~positive.mask & ~negative.mask & ~variable))
+				{
+					consensus.push_back(Cube(static_cast<CubeTermType>((positive.term | negative.term) & ~variable), (positive.mask & negative.mask) | variable));
+				}
+			}
+		}
+		cover.insert(cover.end(), consensus.begin(), consensus.end());
+		cover = absorb(std::move(cover));
+		cubeLimitExceeded = (cover.size() > MaxNumberOfCubes);
+	}
+	primeImplicant = std::move(cover);
+}
+
+
+// Recursive tautology check. Split on binate variables, until the cofactors are simple
+bool ImplicitPrimeImplicants::isTautologyCover(const Cover& cover) const
+{
+	bool result{ false };
+	if (std::any_of(cover.begin(), cover.end(), [this](const Cube& cube) noexcept { return allVariables == cube.mask; }))
+	{
+		result = true;
+	}
+	else if (!cover.empty())
+	{
+		// All cubes together must have at least 2^n minterms. Else some input value is surely not covered
+		ull numberOfCoveredInputValues{ 0ULL };
+		for (const Cube& cube : cover)
+		{
+			numberOfCoveredInputValues += (1ULL << numberOfSetBits(cube.mask));
+		}
+		// A cover, where every variable has only one polarity, is only a tautology with the cube without literals
+		const CubeTermType variable{ splittingVariable(cover, true) };
+		if ((numberOfCoveredInputValues >= (1ULL << numberOfVariables)) && (0U != variable))
+		{
+			result = isTautologyCover(cofactorOf(cover, variable, true)) && isTautologyCover(cofactorOf(cover, variable, false));
+		}
+	}
+	return result;
+}
+
+// The cube is contained in the cover, if the cofactor of the cover for the cube is a tautology
+bool ImplicitPrimeImplicants::isCoveredBy(const Cube& cube, const Cover& cover) const
+{
+	const CubeTermType literalsOfCube{ static_cast<CubeTermType>(allVariables & ~cube.mask) };
+	Cover cofactor;
+	for (const Cube& otherCube : cover)
+	{
+		if (0U == ((otherCube.term ^ cube.term) & literalsOfCube & ~otherCube.mask))
+		{
+			cofactor.push_back(Cube(static_cast<CubeTermType>(otherCube.term & ~literalsOfCube), otherCube.mask | literalsOfCube));
+		}
+	}
+	return isTautologyCover(cofactor);
+}
+
+
+
+// -----------------------------------------
+// Select the cover
+
+
+// Essential prime implicants are always needed. From the others, the ones with the most literals are removed first,
+// if they are covered by the remaining prime implicants
+std::string ImplicitPrimeImplicants::getMinimumDisjunctiveNormalForm(const SymbolTable& symbolTable, const std::string& source)
+{
+	// Time and counters for option -stats
+	StageTimer stageTimer("ImplicitPrimeImplicantsCover");
+
+	const bool predicateForOutputToFile{ (symbolTable.numberOfSymbols() > 5) };
+	OutStreamSelection outStreamSelection(ProgramOption::ppirtc, predicateForOutputToFile);
+	std::ostream& os{ outStreamSelection() };
+
+	os << "\n\n\n------------------ Prime Implicants calculated directly from boolean expression:\n\n'" << source << "'\n\n";
+	for (const Cube& cube : primeImplicant)
+	{
+		os << cube.toString(symbolTable) << "  ";
+	}
+	os << "\n\n";
+
+	// Find the essential prime implicants
+	Cover selected;
+	Cover optional;
+	for (std::size_t index = 0U; index < primeImplicant.size(); ++index)
+	{
+		Cover others{ primeImplicant };
+		others.erase(others.begin() + static_cast<std::ptrdiff_t>(index));
+		if (isCoveredBy(primeImplicant[index], others))
+		{
+			optional.push_back(primeImplicant[index]);
+		}
+		else
+		{
+			selected.push_back(primeImplicant[index]);
+		}
+	}
+	const std::size_t numberOfEssentialPrimeImplicants{ selected.size() };
+
+	// Remove not needed prime implicants. The ones with most literals first
+	std::stable_sort(optional.begin(), optional.end(), [this](const Cube& lhs, const Cube& rhs) noexcept { return numberOfLiterals(lhs) > numberOfLiterals(rhs); });
+	for (std::size_t index = 0U; index < optional.size(); ++index)
+	{
+		Cover others{ selected };
+		others.insert(others.end(), optional.begin() + static_cast<std::ptrdiff_t>(index) + 1, optional.end());
+		if (!isCoveredBy(optional[index], others))
+		{
+			selected.push_back(optional[index]);
+		}
+	}
+
+	// Build minimum disjunctive normal form, as a string. Same format and order of terms as for Quine&  McCluskey
+	std::vector<std::string> termString;
+	for (const Cube& cube : selected)
+	{
+		termString.push_back(cube.toString(symbolTable));
+	}
+	std::sort(termString.begin(), termString.end());
+	std::string minimumDisjunctiveNormalForm;
+	for (const std::string& ts : termString)
+	{
+		if (!minimumDisjunctiveNormalForm.empty())
+		{
+			minimumDisjunctiveNormalForm += "+";
+		}
+		minimumDisjunctiveNormalForm += ts;
+	}
+
+	stageTimer().add("primeImplicants", primeImplicant.size());
+	stageTimer().add("essentialPrimeImplicants", numberOfEssentialPrimeImplicants);
+	stageTimer().add("selectedPrimeImplicants", selected.size());
+
+	os << "Number of prime implicants: " << primeImplicant.size() << "   Essential: " << numberOfEssentialPrimeImplicants << "   Selected: " << selected.size() << "\n";
+	os << "\n\n------------------ Minimum DNF:\n\n" << minimumDisjunctiveNormalForm << "\n\n------------------\n\n";
+	return minimumDisjunctiveNormalForm;
+}
+
+
+// The cubes as strings, for example for the result cache
+std::vector<std::string> ImplicitPrimeImplicants::getPrimeImplicants(const SymbolTable& symbolTable) const
+{
+	std::vector<std::string> result;
+	for (const Cube& cube : primeImplicant)
+	{
+		result.push_back(cube.toString(symbolTable));
+	}
+	return result;
+}
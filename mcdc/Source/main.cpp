@@ -31,12 +31,19 @@
 
 #include "cloption.hpp"
 #include "quinemccluskey.hpp"
+#include "implicitprimeimplicants.hpp"
 #include "mcdc.hpp"
+#include "resultcache.hpp"
+#include "multioutput.hpp"
+#include "benchmark.hpp"
+#include "statistics.hpp"
 
 #include <iostream>
+#include <memory>
 #include <assert.h>
 
 void showHelp();
+void writeStatistics();
 
 sint main(const sint argc, const cchar* const argv[])
 {
@@ -46,6 +53,19 @@ sint main(const sint argc, const cchar* const argv[])
     programOption.readOptions(argc, argv);
     programOption.evaluateCommandLine();
 
+    // Counters and timing for all stages. Will be written at the end of the program
+    if (programOption.option[ProgramOption::stats].optionSelected)
+    {
+        statistics().enable();
+    }
+
+    // The benchmark for the virtual machine is a separate task. Nothing else will be done
+    if (programOption.option[ProgramOption::bvm].optionSelected)
+    {
+        benchmarkVirtualMachine(programOption.option[ProgramOption::bvm].optionParameterString);
+        return 0;
+    }
+
     // If the program is called without any parameters, then help is shown
     // The minimum necessary is that a boolean source expression is given
     // Can also be read interactively
@@ -66,6 +86,14 @@ sint main(const sint argc, const cchar* const argv[])
     }
     // Now we have a boolean expression in variable source
 
+	// Several boolean expressions are minimized together. This is a separate task
+    if (programOption.option[ProgramOption::mo].optionSelected)
+    {
+        evaluateMultipleOutputs(source);
+        writeStatistics();
+        return 0;
+    }
+
 
 	// The number of variables/conditions/symbols/literals in the source string
     NumberOfBitsCountType numberOfVariables{ 0 };
@@ -74,9 +102,17 @@ sint main(const sint argc, const cchar* const argv[])
 	// All symbols will be stored in the symbol table by the compiler as a part of the object code
     SymbolTable symbolTable;
 
-	// After evaluationg the boolean expression with all possible source values, we will receive a list of minterms
-    MintermVector mv;
+	// After evaluationg the boolean expression with all possible source values, we will receive a truth table. The set bits are the minterms
+    TruthTable truthTable;
     MintermCalculator mc(source);
+	// Or the prime implicants are calculated without truth table
+    ImplicitPrimeImplicants implicitPrimeImplicants;
+    bool useImplicitPrimeImplicants{ false };
+	// Or the results are known from an earlier run (option -cache)
+    std::unique_ptr<ResultCache> resultCache{};
+    std::string resultCacheKey;
+    ResultCacheEntry resultCacheEntry;
+    bool useResultCache{ false };
 
 	// Compile the source code boolean expression 
 	const bool termIsOk{ mc.runCompiler() };
@@ -102,25 +138,60 @@ sint main(const sint argc, const cchar* const argv[])
             booleanExpresionsValid = false;
         }
 
-        if (booleanExpresionsValid)
+        if (booleanExpresionsValid && programOption.option[ProgramOption::cache].optionSelected)
         {
-			// So, the boolean expression was valid
-			// Now calculate the vector with the minterms (slow)
-            mv = mc.calculate();
+			// Look for a result of an earlier run with the same boolean expression and the same options
+            resultCache = std::make_unique<ResultCache>(programOption.option[ProgramOption::cache].optionParameterString);
+            resultCacheKey = ResultCache::createKey(source);
+            useResultCache = resultCache->find(resultCacheKey, resultCacheEntry);
+        }
+
+        if (booleanExpresionsValid && !useResultCache)
+        {
+			// For big boolean expressions we try to calculate the prime implicants directly from the object code
+			// Then the exponential truth table is not needed. If there are too many product terms, the truth table will be used
+            if (ImplicitPrimeImplicants::isSelectedFor(numberOfVariables))
+            {
+                useImplicitPrimeImplicants = implicitPrimeImplicants.calculate(mc.getObjectCode());
+                if (!useImplicitPrimeImplicants)
+                {
+                    std::cout << "\n\nToo many product terms for the calculation without truth table. Continue with truth table\n\n";
+                }
+            }
 
-            if (null<MintermVector::size_type>() == mv.size())
+            if (useImplicitPrimeImplicants)
             {
-				// If there are no minterms, the boolean expressions evaluates always to false
-				// This is called a contradiction
-                std::cerr << "\n\n*** Contradiction. Boolean expression '" << source << "' is always false\n\n";
-                booleanExpresionsValid = false;
+                if (implicitPrimeImplicants.isContradiction())
+                {
+                    std::cerr << "\n\n*** Contradiction. Boolean expression '" << source << "' is always false\n\n";
+                    booleanExpresionsValid = false;
+                }
+                if (implicitPrimeImplicants.isTautology())
+                {
+                    std::cerr << "\n\n*** Tautology. Boolean expression '" << source << "' is always true\n\n";
+                    booleanExpresionsValid = false;
+                }
             }
-            if (narrow_cast<MintermVector::size_type>((narrow_cast <MintermVector::size_type>(1) << mc.getNumberOfBooleanVariables())) == mv.size())
+            else
             {
-				// If there are minterms for every inpiut value, the boolean expressions evaluates always to true
-				// This is called a tautology
-				std::cerr << "\n\n*** Tautology. Boolean expression '" << source << "' is always true\n\n";
-                booleanExpresionsValid = false;
+				// So, the boolean expression was valid
+				// Now calculate the vector with the minterms (slow)
+                truthTable = mc.calculate();
+
+                if (truthTable.isContradiction())
+                {
+					// If there are no minterms, the boolean expressions evaluates always to false
+					// This is called a contradiction
+                    std::cerr << "\n\n*** Contradiction. Boolean expression '" << source << "' is always false\n\n";
+                    booleanExpresionsValid = false;
+                }
+                if (truthTable.isTautology())
+                {
+					// If there are minterms for every inpiut value, the boolean expressions evaluates always to true
+					// This is called a tautology
+					std::cerr << "\n\n*** Tautology. Boolean expression '" << source << "' is always true\n\n";
+                    booleanExpresionsValid = false;
+                }
             }
         }
     }
@@ -130,13 +201,43 @@ sint main(const sint argc, const cchar* const argv[])
     if (booleanExpresionsValid)
     {
 
-        std::cout << "\n\nStart to evaluate boolean expression\n\n'" << source << "'\n\nNumber of Variables : " << narrow_cast<uint>(numberOfVariables) << "   Calculated number of minterms : " << mv.size() << "\n\n\n";
-        printTruthTable(source, mv, symbolTable);
+        std::string minimizedSource;
+		// The method, that produced the minimum DNF
+        std::string nameOfMinimizer;
+        if (useResultCache)
+        {
+            std::cout << "\n\nStart to evaluate boolean expression\n\n'" << source << "'\n\nNumber of Variables : " << narrow_cast<uint>(numberOfVariables) << "   Result from cache file : '" << programOption.option[ProgramOption::cache].optionParameterString << "'\n\n\n";
+            std::cout << "Prime implicants:  ";
+            for (const std::string& primeImplicant : resultCacheEntry.primeImplicants)
+            {
+                std::cout << primeImplicant << "  ";
+            }
+            std::cout << "\n\n";
+            minimizedSource = resultCacheEntry.minimumDisjunctiveNormalForm;
+            nameOfMinimizer = "an earlier run (result cache)";
+        }
+        else if (useImplicitPrimeImplicants)
+        {
+            std::cout << "\n\nStart to evaluate boolean expression\n\n'" << source << "'\n\nNumber of Variables : " << narrow_cast<uint>(numberOfVariables) << "   Prime implicants calculated without truth table : " << implicitPrimeImplicants.getNumberOfPrimeImplicants() << "\n\n\n";
 
-		// Start the Quine & McCluskey Algorithm and get aminimum DNF
-        QuineMcluskey quineMcluskey;
-		std::string minimizedSource{ quineMcluskey.getMinimumDisjunctiveNormalForm(mv, symbolTable, source) };
-        std::cout << "\n\nResult of Quine and McCluskey minimizing algorithm:\n\n'" << minimizedSource << "'\n\n";
+			// Select a cover from the already calculated prime implicants
+            minimizedSource = implicitPrimeImplicants.getMinimumDisjunctiveNormalForm(symbolTable, source);
+            resultCacheEntry.primeImplicants = implicitPrimeImplicants.getPrimeImplicants(symbolTable);
+            nameOfMinimizer = "implicit prime implicant calculation (without truth table)";
+        }
+        else
+        {
+            std::cout << "\n\nStart to evaluate boolean expression\n\n'" << source << "'\n\nNumber of Variables : " << narrow_cast<uint>(numberOfVariables) << "   Calculated number of minterms : " << truthTable.numberOfMinterms() << "\n\n\n";
+            printTruthTable(source, truthTable, symbolTable);
+
+			// Start the Quine & McCluskey Algorithm and get aminimum DNF
+            QuineMcluskey quineMcluskey;
+            minimizedSource = quineMcluskey.getMinimumDisjunctiveNormalForm(truthTable, symbolTable, source);
+            resultCacheEntry.primeImplicants = quineMcluskey.getPrimeImplicants();
+            nameOfMinimizer = quineMcluskey.getNameOfMinimizer();
+        }
+        std::cout << "\n\nResult of " << nameOfMinimizer << ":\n\n'" << minimizedSource << "'\n\n";
+        resultCacheEntry.minimumDisjunctiveNormalForm = minimizedSource;
 
 		// We can continue to do the MCDC analysis with the original source code
 		// This may result in unnecessary large Abstract Syntax Trees
@@ -166,21 +267,54 @@ sint main(const sint argc, const cchar* const argv[])
 			// If that was OK. Show tree
             virtualMachineForAST.printTreeStandard(source);
 
-			// If selected, find MCDC test pairs and test set
-            if (!programOption.option[ProgramOption::nomcdc].optionSelected)
+			// If selected, find MCDC test pairs and test set. Big boolean expressions need option -forcemcdc
+            if (!programOption.option[ProgramOption::nomcdc].optionSelected && Mcdc::isSelectedFor(virtualMachineForAST.maxConditionsInTree()))
             {
                 Mcdc mcdc;
 
-                mcdc.findMcdcIndependencePairs(virtualMachineForAST);
-                mcdc.generateTestSets();
+                if (useResultCache)
+                {
+					// The test sets are known. No search for test pairs necessary
+                    mcdc.printTestSets(virtualMachineForAST, resultCacheEntry.testSets);
+                }
+                else
+                {
+                    mcdc.findMcdcIndependencePairs(virtualMachineForAST);
+                    mcdc.generateTestSets();
+                    resultCacheEntry.testSets = mcdc.getTestSets();
+                }
+            }
+
+			// Store the new result for the next run
+            if (resultCache && !useResultCache)
+            {
+                if (!resultCache->add(resultCacheKey, resultCacheEntry))
+                {
+                    std::cerr << "\n\n*** Error: Could not write result cache file '" << programOption.option[ProgramOption::cache].optionParameterString << "'\n\n";
+                }
             }
         }
     }
+    writeStatistics();
     return 0;
 }
 
 
 
+// Write the statistics of all stages as JSON to the file given with option -stats
+void writeStatistics()
+{
+    if (programOption.option[ProgramOption::stats].optionSelected)
+    {
+        if (!statistics().writeJsonFile(programOption.option[ProgramOption::stats].optionParameterString))
+        {
+            std::cerr << "\n\n*** Error: Could not write statistics file '" << programOption.option[ProgramOption::stats].optionParameterString << "'\n\n";
+        }
+    }
+}
+
+
+
 
 void showHelp()
 {
@@ -338,6 +472,24 @@ void showHelp()
 	std::cout << " Any 3.7 option switches on the respective 3.8 options\n";
 	std::cout << "\n";
 	std::cout << "\n";
+	std::cout << " ---------------------------------------------------------------\n";
+	std::cout << " 4. Performance related Options\n";
+	std::cout << "\n";
+	std::cout << " -bvm \"filename\"               Benchmark the virtual machine. Compare byte code interpreter and reference implementation for all boolean expressions in option file \"filename\"\n";
+	std::cout << " -noopt                        Do not optimize the object code for the virtual machine\n";
+	std::cout << " -threads n                    Number of worker threads for all parallel calculations. Default (or 0) is the number of hardware threads\n";
+	std::cout << " -espresso                     Use the heuristic (Espresso like) minimizer instead of Quine&McCluskey. Is selected automatically for big boolean expressions\n";
+	std::cout << " -ipi                          Calculate the prime implicants directly from the boolean expression without truth table. Is selected automatically for big boolean expressions\n";
+	std::cout << " -cache \"filename\"             Store results in the cache file \"filename\" and reuse them, if the same boolean expression is evaluated again with the same options\n";
+	std::cout << " -mo                           Minimize several boolean expressions together with shared prime implicants. The boolean expressions in -s are separated by ';'\n";
+	std::cout << " -stats \"filename\"             Write statistics and timing for all stages (minterm calculation, Quine&McCluskey, coverage, MCDC) as JSON to file \"filename\"\n";
+	std::cout << " -petrick                      Use Petricks method for the cyclic core of a coverage table instead of branch and bound\n";
+	std::cout << " -onecover                     Search only one minimum cover for the cyclic core of a coverage table. Is faster, if there are many minimum covers\n";
+	std::cout << " -petricktree                  Petricks method: Multiply the clauses in a balanced tree in parallel on all worker threads\n";
+	std::cout << " -zdd                          Use a zero-suppressed decision diagram for the cyclic core of a coverage table. For many minimum covers\n";
+	std::cout << " -forcemcdc                    Search MCDC test pairs also for boolean expressions with more than 16 conditions. Needs exponential time and memory\n";
+	std::cout << "\n";
+	std::cout << "\n";
 	std::cout << " if an explicit filename is given, it will always be used in favour auf a automatic generated file name.\n";
 	std::cout << " Means, if \"f\" and \"a\" suffix are both present, suffix \"f\" will be used.\n";
 	std::cout << "\n";
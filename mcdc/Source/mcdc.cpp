@@ -119,6 +119,8 @@
 
 
 #include "mcdc.hpp"
+#include "threadpool.hpp"
+#include "statistics.hpp"
 
 #include "coverage.hpp"
 #include "ast.hpp"
@@ -538,11 +540,30 @@ void Mcdc::generateTestSets()
 	{
 		printResult(allTestSets, std::cout);
 	}
+	resultingTestSets = std::move(allTestSets);
 
 	// Done
 	// Main Purpose of whole software program is finsihed now
 }
 
+
+// The test sets are already known. The AST is only needed to show the values of the conditions and the decision
+void Mcdc::printTestSets(VirtualMachineForAST& ast, const TestSets& allTestSets)
+{
+	astUsedForMcdcCalculation = ast;
+
+	const bool predicateForOutputToFile{ (allTestSets.size() > 30U) };
+	OutStreamSelection outStreamSelection(ProgramOption::pmcsc, predicateForOutputToFile);
+	std::ostream& os{ outStreamSelection() };
+
+	printResult(allTestSets, os);
+	if (!outStreamSelection.hasStdOut())
+	{
+		printResult(allTestSets, std::cout);
+	}
+	resultingTestSets = allTestSets;
+}
+
 McdcIndependencePair Mcdc::findBestResultingIndependencePair(TestVector& resultingIndependencePairPerVariableXPair)
 {
 	uint bestSelectionIndex{ 0 };
@@ -691,6 +712,19 @@ bool Mcdc::isMax1IndependencePairPerCondition()
 }
 
 
+// The brute force search needs exponential time and memory. Big boolean expressions are only analyzed with option -forcemcdc
+bool Mcdc::isSelectedFor(uint numberOfConditions)
+{
+	const bool isSelected{ (numberOfConditions <= MaxNumberOfConditionsForMcdc) || programOption.option[ProgramOption::forcemcdc].optionSelected };
+	if (!isSelected)
+	{
+		std::cout << "\n\n*** MCDC analysis skipped. The boolean expression has " << numberOfConditions << " conditions. The search for MCDC test pairs grows with 4^n\n"
+			<< "*** and is done for up to " << MaxNumberOfConditionsForMcdc << " conditions. Use option -forcemcdc to run it anyway, or -nomcdc to suppress this message\n\n";
+	}
+	return isSelected;
+}
+
+
 // Brute Force Evaluation
 // Try to find test pairs that fullfill the requirement of MCDC
 // A bbolean expressions is given. From this we will construct an abstract syntax tree.
@@ -700,6 +734,8 @@ bool Mcdc::isMax1IndependencePairPerCondition()
 // And finally to check, if it is a valid MCDC test pair
 void Mcdc::findMcdcIndependencePairs(VirtualMachineForAST& ast)
 {
+	// Time and counters for option -stats
+	StageTimer stageTimer("Mcdc");
 
 	sint counter{ 0 };
 
@@ -749,111 +785,153 @@ void Mcdc::findMcdcIndependencePairs(VirtualMachineForAST& ast)
 		}
 
 
+		// Perform TREE XOR. To be able to check, what conditions and what operators changed values
+		// Tree exor means: we perfrom an XOR for every node in the AST
+		// If we have a not evaluated node, then the result is 0
+		// With that, we can check, what values (nodes) changed between 2 test pairs
+		// The result of this activity is the "influence tree"
+		// It is not important, if the source values were 0.
+		// If the complete path, starting from the condition to the root, is all true,
+		// than the condition has an influence.
+		// If only one condition changes (only one condition is true) and this is an influencing condition
+		// then we have unique cause MCDC. If more conditions changed, but only one of them is in an
+		// influencing path, then we have masking MCDC
+		// For strongly coupled conditions (meaningm the same condition is in the AST more than one)
+		// Unique cause is per definition not possible.
+		// If only one of the multiple same conditions is part of the influencing path, 
+		// then we talk about Unique+Maskin MCDC
+		const auto buildInfluenceTree = [&astPreEvaluated, astSize](uint outer, uint inner, VirtualMachineForAST& influenceTree)
+		{
+			for (uint i = 0; i < astSize; ++i)
+			{
+				influenceTree.ast[i].value = (astPreEvaluated[outer].ast[i].value != astPreEvaluated[inner].ast[i].value) &&
+					!astPreEvaluated[outer].ast[i].notEvaluated &&
+					!astPreEvaluated[inner].ast[i].notEvaluated;
+			}
+		};
+
+		// Checking all test pairs is the expensive part. The number of test pairs grows with 4^n
+		// So the check is done by the thread pool. One task checks all test pairs for one outer test value
+		// To limit the needed memory, the outer test values are processed in blocks. The results of
+		// a block are then evaluated in sequence. So the output is the same as for a sequential search
+		using McdcTypeAndCondition = std::pair<McdcType, cchar>;
+		const uint numberOfOuterTestValuesPerBlock{ std::max(1U, std::min(threadPool().getNumberOfThreads() * NumberOfOuterTestValuesPerThread, MaxNumberOfTestPairsPerBlock / maxLoop)) };
+		std::vector<std::vector<McdcTypeAndCondition>> mcdcTypeForBlock(numberOfOuterTestValuesPerBlock);
+
 		// Check all possible test pairs, if they have an influencing condition
-		for (uint outer = 0U; outer < (maxLoop - 1); ++outer)
+		for (uint blockStart = 0U; blockStart < (maxLoop - 1); blockStart += numberOfOuterTestValuesPerBlock)
 		{
-			for (uint inner = outer + 1; inner < maxLoop; inner++)
+			const uint blockEnd{ std::min(blockStart + numberOfOuterTestValuesPerBlock, maxLoop - 1) };
+
+			// Determine the type of MCDC (if any) and the influcening condition for all test pairs in this block
+			threadPool().parallelFor(blockStart, blockEnd, 1U, [&](uint outer)
 			{
-				// Perform TREE XOR. To be able to check, what conditions and what operators changed values
-				// Tree exor means: we perfrom an XOR for every node in the AST
-				// If we have a not evaluated node, then the result is 0
-				// With that, we can check, what values (nodes) changed between 2 test pairs
-				// The result of this activity is the "influence tree"
-				// It is not important, if the source values were 0.
-				// If the complete path, starting from the condition to the root, is all true,
-				// than the condition has an influence.
-				// If only one condition changes (only one condition is true) and this is an influencing condition
-				// then we have unique cause MCDC. If more conditions changed, but only one of them is in an
-				// influencing path, then we have masking MCDC
-				// For strongly coupled conditions (meaningm the same condition is in the AST more than one)
-				// Unique cause is per definition not possible.
-				// If only one of the multiple same conditions is part of the influencing path, 
-				// then we talk about Unique+Maskin MCDC
-				for (uint i = 0; i < astSize; ++i)
+				// Every task needs its own influence tree
+				VirtualMachineForAST influenceTree{ ast };
+				std::vector<McdcTypeAndCondition>& mcdcTypeForOuter{ mcdcTypeForBlock[outer - blockStart] };
+				mcdcTypeForOuter.clear();
+				for (uint inner = outer + 1; inner < maxLoop; inner++)
 				{
-					astInfluenceSet.ast[i].value = (astPreEvaluated[outer].ast[i].value != astPreEvaluated[inner].ast[i].value) &&
-						!astPreEvaluated[outer].ast[i].notEvaluated &&
-						!astPreEvaluated[inner].ast[i].notEvaluated;
+					buildInfluenceTree(outer, inner, influenceTree);
+					mcdcTypeForOuter.push_back(getMcdcType(influenceTree.ast));
 				}
-	
-				// Now check the influence tree. And determine the type of MCDC (if any) and the influcening condition for this test pair
-				const auto [mcdcType, influencingCondition] = getMcdcType(astInfluenceSet.ast);
+			});
 
-
-				// Now, depending on the found MCDC type or if MCDC at all
-				// Inform the user about what we found
-				// And save the test values for further processing
-				switch (mcdcType)
+			for (uint outer = blockStart; outer < blockEnd; ++outer)
+			{
+				for (uint inner = outer + 1; inner < maxLoop; inner++)
 				{
-				case McdcType::UniqueCause:
-					if (!programOption.option[ProgramOption::dnpast].optionSelected)
-					{
-						osMcdc << "\n----------------------- Found   Unique Cause          MCDC Test pair for condition: " << influencingCondition << "     Test Pair: " << outer << ' ' << inner << '\n';
-					}
-					testSetUniqueCauseMCDC.insert(outer);
-					testSetUniqueCauseMCDC.insert(inner);
-					++counterUniqueCauseMCDC;
-					break;
-				case McdcType::UniqueCauseMasking:
-					if (!programOption.option[ProgramOption::dnpast].optionSelected)
-					{
-						osMcdc << "\n----------------------- Found   Unique Cause+Masking  MCDC Test pair for condition: " << influencingCondition << "     Test Pair: " << outer << ' ' << inner << '\n';
-					}
-					testSetUniqueCauseMaskingMCDC.insert(outer);
-					testSetUniqueCauseMaskingMCDC.insert(inner);
-					++counterUniqueCauseMaskingMCDC;
-					break;
-				case McdcType::Masking:
-					if (!programOption.option[ProgramOption::dnpast].optionSelected)
+					// The type of MCDC (if any) and the influcening condition for this test pair
+					const auto [mcdcType, influencingCondition] = mcdcTypeForBlock[outer - blockStart][inner - outer - 1];
+
+
+					// Now, depending on the found MCDC type or if MCDC at all
+					// Inform the user about what we found
+					// And save the test values for further processing
+					switch (mcdcType)
 					{
-						osMcdc << "\n----------------------- Found   Masking               MCDC Test pair for condition: " << influencingCondition << "     Test Pair: " << outer << ' ' << inner << '\n';
+					case McdcType::UniqueCause:
+						if (!programOption.option[ProgramOption::dnpast].optionSelected)
+						{
+							osMcdc << "\n----------------------- Found   Unique Cause          MCDC Test pair for condition: " << influencingCondition << "     Test Pair: " << outer << ' ' << inner << '\n';
+						}
+						testSetUniqueCauseMCDC.insert(outer);
+						testSetUniqueCauseMCDC.insert(inner);
+						++counterUniqueCauseMCDC;
+						break;
+					case McdcType::UniqueCauseMasking:
+						if (!programOption.option[ProgramOption::dnpast].optionSelected)
+						{
+							osMcdc << "\n----------------------- Found   Unique Cause+Masking  MCDC Test pair for condition: " << influencingCondition << "     Test Pair: " << outer << ' ' << inner << '\n';
+						}
+						testSetUniqueCauseMaskingMCDC.insert(outer);
+						testSetUniqueCauseMaskingMCDC.insert(inner);
+						++counterUniqueCauseMaskingMCDC;
+						break;
+					case McdcType::Masking:
+						if (!programOption.option[ProgramOption::dnpast].optionSelected)
+						{
+							osMcdc << "\n----------------------- Found   Masking               MCDC Test pair for condition: " << influencingCondition << "     Test Pair: " << outer << ' ' << inner << '\n';
+						}
+						testSetMaskingMCDC.insert(outer);
+						testSetMaskingMCDC.insert(inner);
+						++counterMaskingMCDC;
+						break;
+					case McdcType::NONE: //fallthrough
+					default:
+						if (!programOption.option[ProgramOption::dnpast].optionSelected)
+						{
+							osMcdc << "....................... Could not be identified as MCDC of any type.  Test Pair: " << outer << ' ' << inner << '\n';
+						}
+						break;
 					}
-					testSetMaskingMCDC.insert(outer);
-					testSetMaskingMCDC.insert(inner);
-					++counterMaskingMCDC;
-					break;
-				case McdcType::NONE: //fallthrough
-				default:
-					if (!programOption.option[ProgramOption::dnpast].optionSelected)
+
+					// If we have a valid MCDC Test Pair
+					if (McdcType::NONE != mcdcType)
 					{
-						osMcdc << "....................... Could not be identified as MCDC of any type.  Test Pair: " << outer << ' ' << inner << '\n';
+						// Then we add it to all internal containers
+						add(McdcIndependencePair(mcdcType, outer, inner, influencingCondition));
+						// And show 3 ASTs
+						if (!outStreamSelection.isNull() && !programOption.option[ProgramOption::dnpast].optionSelected)
+						{
+							++counter;
+							osMcdc << "\n-------------------------------------- AST for value: " << outer << "\n\n";
+							astPreEvaluated[outer].printTree(osMcdc);
+							osMcdc << "\n-------------------------------------- AST for value: " << inner << "\n\n";
+							astPreEvaluated[inner].printTree(osMcdc);
+							osMcdc << "\n-------------------------------------- AST for influencing condition check\n\n";
+							buildInfluenceTree(outer, inner, astInfluenceSet);
+							astInfluenceSet.printTree(osMcdc);
+							osMcdc << "\n\n";
+						}
 					}
-					break;
-				}
-
-				// If we have a valid MCDC Test Pair
-				if (McdcType::NONE != mcdcType)
-				{
-					// Then we add it to all internal containers
-					add(McdcIndependencePair(mcdcType, outer, inner, influencingCondition));
-					// And show 3 ASTs
-					if (!outStreamSelection.isNull() && !programOption.option[ProgramOption::dnpast].optionSelected)
+					else if (!outStreamSelection.isNull() && programOption.option[ProgramOption::paast].optionSelected && !programOption.option[ProgramOption::dnpast].optionSelected)
 					{
-						++counter;
+						// It is alsa possible to show all ASTs regardless if they are MCDC pair or not. Controlled via command line
+						// That is the case here
 						osMcdc << "\n-------------------------------------- AST for value: " << outer << "\n\n";
 						astPreEvaluated[outer].printTree(osMcdc);
 						osMcdc << "\n-------------------------------------- AST for value: " << inner << "\n\n";
 						astPreEvaluated[inner].printTree(osMcdc);
 						osMcdc << "\n-------------------------------------- AST for influencing condition check\n\n";
+						buildInfluenceTree(outer, inner, astInfluenceSet);
 						astInfluenceSet.printTree(osMcdc);
 						osMcdc << "\n\n";
 					}
-				}
-				else if (!outStreamSelection.isNull() && programOption.option[ProgramOption::paast].optionSelected && !programOption.option[ProgramOption::dnpast].optionSelected)
-				{
-					// It is alsa possible to show all ASTs regardless if they are MCDC pair or not. Controlled via command line
-					// That is the case here
-					osMcdc << "\n-------------------------------------- AST for value: " << outer << "\n\n";
-					astPreEvaluated[outer].printTree(osMcdc);
-					osMcdc << "\n-------------------------------------- AST for value: " << inner << "\n\n";
-					astPreEvaluated[inner].printTree(osMcdc);
-					osMcdc << "\n-------------------------------------- AST for influencing condition check\n\n";
-					astInfluenceSet.printTree(osMcdc);
-					osMcdc << "\n\n";
-				}
 
+				}
 			}
 		}
+		// Every test pair has been examined and classified
+		const ull numberOfTestPairs{ (static_cast<ull>(maxLoop) * (maxLoop - 1U)) / 2U };
+		const ull numberOfClassifiedTestPairs{ static_cast<ull>(counterUniqueCauseMCDC) + static_cast<ull>(counterUniqueCauseMaskingMCDC) + static_cast<ull>(counterMaskingMCDC) };
+		stageTimer().add("conditions", maxConditions);
+		stageTimer().add("pairsExamined", numberOfTestPairs);
+		stageTimer().add("pairsClassified", numberOfClassifiedTestPairs);
+		stageTimer().add("pairsUniqueCause", static_cast<ull>(counterUniqueCauseMCDC));
+		stageTimer().add("pairsUniqueCauseMasking", static_cast<ull>(counterUniqueCauseMaskingMCDC));
+		stageTimer().add("pairsMasking", static_cast<ull>(counterMaskingMCDC));
+		stageTimer().add("pairsNone", numberOfTestPairs - numberOfClassifiedTestPairs);
 
 		// So far we showed independence pairs. Now we ant to show the test values in a list
 		if (testSetUniqueCauseMCDC.size() > 0)
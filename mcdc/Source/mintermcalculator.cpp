@@ -59,6 +59,10 @@
 // This programm implements multithreading. But this is basically a meaningless approach
 // Even running on 8 threads, you can do 3 variables more. And then?
 // So, no further effort on runtime speed optimization
+//
+// Update: The virtual machine has now a bit sliced mode. 64 input values will be evaluated
+// in one run of the program. The result is a packed truth table (one bit per input value),
+// which is then converted to the minterm vector. This is more than an order of magnitude faster.
 // 
 // The resulting Mintermvector and the gathered Symbols will be used by other program
 // Parts for further evaluation.
@@ -67,6 +71,9 @@
 
 #include "mintermcalculater.hpp"
 #include "cloption.hpp"
+#include "optimizer.hpp"
+#include "threadpool.hpp"
+#include "statistics.hpp"
 
 #include <future>
 #include <iostream>
@@ -78,9 +85,9 @@
 // Calculating Minterms is slow
 // And the complexity is O(2^n). Meaning Rowing expeonentially
 // SO, for biiger number of boolean variables, we use multi threading
-// One tread calculates a range of Minterms
-// The ranges for the trheads are claculated in this function
-// numberOfRanges is equal to number of threads. Upper bound is 2^number of variables
+// One task in the thread pool calculates a range of Minterms
+// The ranges for the tasks are claculated in this function
+// Upper bound is the number of truth table words. The last range takes the rest
 MintermCalculator::MintermRangeVector MintermCalculator::calculateMintermRanges(uint numberOfRanges, uint upperBound)
 {
 	// Resulting minterm ranges (not overlapping)
@@ -103,8 +110,8 @@ MintermCalculator::MintermRangeVector MintermCalculator::calculateMintermRanges(
 		{
 			// Calculate next end of range value
 			uint endValue{ startValue + rangeValue };
-			// If this is already over  the edge
-			if (endValue > (upperBound))
+			// If this is already over  the edge or if this is the last range, which takes the rest
+			if ((endValue > (upperBound)) || ((ui + 1U) == numberOfRanges))
 			{
 				// Limit the upper bound
 				endValue = upperBound;
@@ -126,96 +133,106 @@ MintermCalculator::MintermRangeVector MintermCalculator::calculateMintermRanges(
 // Calculations with a false result(Maxterm) are not stored.
 // Since claculation is slow and gets slower with more variable
 // We will use multitasking wit big boolean functions
-MintermVector MintermCalculator::calculate()
+const TruthTable& MintermCalculator::calculate()
 {
-	// Here we will store the result, so all minterms for the boolean function
-	MintermVector mintermVector;
+	// Time and counters for option -stats
+	StageTimer stageTimer("MintermCalculator");
+
+	// Here we will store the result, the packed truth table
+	TruthTableWordStream truthTableWords;
 	
 	// Compile the source code to object code
 	if (!compilerResultOK)
 	{
-		compilerResultOK = compiler();
+		compilerResultOK = compileAndOptimize();
 	}
 	if (compilerResultOK)
 	{
 		// CHeck how many variables are in and how many calculation loops we need to do
 		numberOfBooleanVariables = objectCode.symbolTable.numberOfSymbols();
-		const uint maxEvaluations{ 1U << numberOfBooleanVariables };
+		// The virtual machine runs in bit sliced mode. One run calculates 64 input values, so one truth table word
+		const uint numberOfWords{ (numberOfBooleanVariables > NumberOfLaneBitsInTruthTableWord) ? (1U << (numberOfBooleanVariables - NumberOfLaneBitsInTruthTableWord)) : 1U };
 
-		// If we have more than 10 boolean variables, then we will use mult threading to calculate the minterms
-		if (numberOfBooleanVariables > 10)
-		{
-			// Claculate the ranges to be calculated by each thread
-			MintermRangeVector mrv{ calculateMintermRanges(numberOfThreads, maxEvaluations) };
+		// Load the code into a virtual machine. This shows also the listing of the program
+		vmfbe.load(objectCode, source);
 
-			// Futures for asynchronous functions. Wait for the thread to finish ang get the result
-			std::future<MintermVector> futures[numberOfThreads];
+		// For bigger truth tables we will use the thread pool. The truth table is split into many small ranges
+		// More ranges than threads. So the work stealing in the thread pool can balance the load
+		const uint numberOfRanges{ std::min(threadPool().getNumberOfThreads() * NumberOfRangesPerThread, numberOfWords / MinimumNumberOfWordsPerRange) };
+		if (numberOfRanges > 1U)
+		{
+			// Claculate the ranges to be calculated by each task. Ranges are given in truth table words
+			MintermRangeVector mrv{ calculateMintermRanges(numberOfRanges, numberOfWords) };
 
-			// Start calculation threads
-			for (uint i = 0; i < numberOfThreads; ++i)
+			// Futures for the tasks. Wait for the task to finish and get the result
+			std::vector<std::future<TruthTableWordStream>> futures;
+			for (const MintermRange& mintermRange : mrv)
 			{
-				futures[i] = std::async(std::launch::async,& MintermCalculator::calculateAsThread, this, mrv[i], objectCode);
+				futures.push_back(threadPool().submit([this, mintermRange]() { return calculateAsThread(mintermRange, objectCode); }));
 			}
-			// Wait for the thread to end and read the result
-			for (uint i = 0; i < numberOfThreads; ++i)
+			// Wait for the tasks to end and read the result
+			for (std::future<TruthTableWordStream>& future : futures)
 			{
-				MintermVector mvTemp{ futures[i].get() };
-				// Store all results from all threads in one common function result
-				mintermVector.insert(mintermVector.end(), std::make_move_iterator(mvTemp.begin()), std::make_move_iterator(mvTemp.end()));
+				threadPool().wait(future);
+				TruthTableWordStream ttwsTemp{ future.get() };
+				// Store all results from all tasks in one common truth table. Ranges are consecutive
+				truthTableWords.insert(truthTableWords.end(), ttwsTemp.begin(), ttwsTemp.end());
 			}
 		}
 		else
 		{
 			// No multitasking
-			// Load the code into a virtual machine and
-			vmfbe.load(objectCode, source);
-			// execute the program for all posiible input values
-			for (uint ui = 0; ui < maxEvaluations; ++ui)
-			{
-				// If the result evaluates to true
-				if (vmfbe.run(ui))
-				{
-					// then store this minterm
-					mintermVector.push_back(ui);
-				}
-			}
+			// execute the program for all posiible input values, 64 at a time
+			truthTableWords = vmfbe.runBitSlicedForAllInputs();
 		}
 	}
-	return mintermVector;
+	// In bit sliced mode the complete program runs once per truth table word
+	// So one word instruction calculates one operation for 64 input values at the same time
+	const ull programLength{ objectCode.opCode.size() };
+	stageTimer().add("vmProgramLength", programLength);
+	stageTimer().add("truthTableWords", truthTableWords.size());
+	stageTimer().add("vmWordInstructions", programLength * truthTableWords.size());
+
+	// The minterms are the set bits in the packed truth table
+	truthTable = TruthTable(numberOfBooleanVariables, std::move(truthTableWords));
+	stageTimer().add("minterms", truthTable.numberOfMinterms());
+	return truthTable;
 }
 
 
-// Calculate minterms in a thread
-MintermVector MintermCalculator::calculateAsThread(MintermRange mt, ObjectCode objectCodeParameter)
+// Compile the source and optimize the resulting object code
+bool MintermCalculator::compileAndOptimize()
 {
-	// Resulting vector with minterms
-	MintermVector mv;
+	const bool result{ compiler() };
+	if (result && !programOption.option[ProgramOption::noopt].optionSelected)
+	{
+		OptimizerForVM optimizerForVM(objectCode);
+		optimizerForVM.optimize();
+	}
+	return result;
+}
 
+
+// Calculate a part of the truth table in a thread
+// The range is given in truth table words. Each word holds the result for 64 input values
+TruthTableWordStream MintermCalculator::calculateAsThread(MintermRange mt, ObjectCode objectCodeParameter)
+{
 	// Local virtual machine
 	VirtualMachineForBooleanExpressions vm;
-	// Load the object code into the virtual machine
-	vm.load(objectCodeParameter, source);
+	// Load the object code into the virtual machine. The listing has already been shown
+	vm.load(objectCodeParameter, source, false);
 	// And run the virtual machine for the range assigned to the thread
-	for (uint ui = mt.first; ui < mt.second; ++ui)
-	{
-		// In case of true result
-		if (vm.run(ui))
-		{
-			// Store the minterm
-			mv.push_back(ui);
-		}
-	}
-	// Return the local minterm vector, so that it can be combined with other thread results
-	return mv;
+	// Return the local truth table part, so that it can be combined with other thread results
+	return vm.runBitSlicedForRange(mt.first, mt.second);
 }
 
 
 // Print a comlete truth table. 
 // So not only the minterm, but the result for a boolean expression for all possible inputs
-// Source is a minterm vector. The variable source is the source string, the boolean expression.It is for output purposes only
+// Source is the packed truth table. The variable source is the source string, the boolean expression.It is for output purposes only
 // the symbol table is important, to give bits names
 
-void printTruthTable(const std::string& source, MintermVector& mintermVector, const SymbolTable& symbolTable)
+void printTruthTable(const std::string& source, const TruthTable& truthTable, const SymbolTable& symbolTable)
 {
 	// So many letter/symbols/variables/conditions/terminals were in the source string, the boolean expression
 	const uint symbolCount{ symbolTable.numberOfSymbols() };
@@ -244,9 +261,9 @@ void printTruthTable(const std::string& source, MintermVector& mintermVector, co
 	for (uint i = 0; i < maxEvaluations; ++i)
 	{
 		b = i; // Assign running value to bitset
-		// Check if the running value is in the minterm list
+		// Check if the running value is a minterm
 		// If so, then result is 1 , else 0
-		uint result{ (std::find(mintermVector.begin(), mintermVector.end(), i) != mintermVector.end()) ? 1U : 0U };
+		uint result{ truthTable[i] ? 1U : 0U };
 		// Print decimal equivalent of running variable, the bitset and the result
 		os << std::setw(static_cast<std::streamsize>(maxLengthDecimalEquivalent) + 1) << i << " " << b.to_string().substr(26 - symbolCount) << "    " << result << '\n';
 	}
@@ -0,0 +1,414 @@
+// --------------------------------------------------------------------------------------------------------------------------------
+// License:	BSD-3-Clause
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Copyright 2019      Armin Montigny
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+// following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the 
+//    following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the 
+//    following disclaimer in the documentation and /or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or 
+//    promote products derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+
+
+// Multi output minimization. Quine&  McCluskey method with output tags. See multioutput.hpp
+
+#include "multioutput.hpp"
+#include "mcdc.hpp"
+#include "coverage.hpp"
+#include "cloption.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+
+
+namespace
+{
+	// Sort terms by mask and term. Then terms, that can be combined, are in the same range of masks
+	bool isLessByMaskAndTerm(const PrimeImplicantType<uint32_t>& lhs, const PrimeImplicantType<uint32_t>& rhs) noexcept
+	{
+		return (lhs.mask < rhs.mask) || ((lhs.mask == rhs.mask) && (lhs.term < rhs.term));
+	}
+	bool isEqualByMaskAndTerm(const PrimeImplicantType<uint32_t>& lhs, const PrimeImplicantType<uint32_t>& rhs) noexcept
+	{
+		return (lhs.mask == rhs.mask) && (lhs.term == rhs.term);
+	}
+
+	// A truth table for all variables of the symbol table, calculated from a truth table with only the variables of the boolean expression
+	// Variables of the boolean expression, that are not used, are don't care
+	TruthTable expandTruthTable(const TruthTable& truthTable, const SymbolTable& symbolTableOfTruthTable, const SymbolTable& symbolTable)
+	{
+		const uint numberOfVariables{ symbolTable.numberOfSymbols() };
+		// For every variable of the truth table: The bit in the new input value. The first symbol is the highest bit
+		std::vector<uint> bitInNewInputValue;
+		for (const cchar symbol : symbolTableOfTruthTable.symbol)
+		{
+			const uint position{ narrow_cast<uint>(std::distance(symbolTable.symbol.begin(), symbolTable.symbol.find(symbol))) };
+			bitInNewInputValue.push_back(numberOfVariables - 1U - position);
+		}
+		const ull numberOfInputValues{ 1ULL << numberOfVariables };
+		TruthTableWordStream word(static_cast<std::size_t>(std::max(1ULL, numberOfInputValues >> NumberOfLaneBitsInTruthTableWord)), 0ULL);
+		for (ull inputValue = 0ULL; inputValue < numberOfInputValues; ++inputValue)
+		{
+			ull inputValueOfTruthTable{ 0ULL };
+			for (const uint bit : bitInNewInputValue)
+			{
+				inputValueOfTruthTable = (inputValueOfTruthTable << 1U) | ((inputValue >> bit) & 1ULL);
+			}
+			if (truthTable[inputValueOfTruthTable])
+			{
+				word[static_cast<std::size_t>(inputValue >> NumberOfLaneBitsInTruthTableWord)] |= 1ULL << (inputValue & (NumberOfLanesInTruthTableWord - 1U));
+			}
+		}
+		return TruthTable(numberOfVariables, std::move(word));
+	}
+}
+
+
+
+// Main interface. Calculate the prime implicants, select the shared cover and build one DNF per output
+std::vector<std::string> MultiOutputQuineMcluskey::getMinimumDisjunctiveNormalForms(const std::vector<TruthTable>& truthTable, const SymbolTable& symbolTable)
+{
+	numberOfVariables = symbolTable.numberOfSymbols();
+	allVariables = narrow_cast<TermType>((1ULL << numberOfVariables) - 1ULL);
+
+	calculatePrimeImplicants(truthTable);
+
+	// Output control for showing the result of the minimization of the prime implicant table
+	const bool predicateForOutputToFile{ (numberOfVariables > 5) || (truthTable.size() > 2U) };
+	OutStreamSelection outStreamSelection(ProgramOption::ppirtc, predicateForOutputToFile);
+	std::ostream& os{ outStreamSelection() };
+
+	os << "\n\n\n------------------ Multi output prime implicants (outputs in brackets):\n\n";
+	for (const PrimeImplicant& pi : primeImplicant)
+	{
+		os << pi.toString(symbolTable) << " (";
+		for (uint output = 0U; output < truthTable.size(); ++output)
+		{
+			if (0U != (pi.outputTag & (1U << output)))
+			{
+				os << ' ' << (output + 1U);
+			}
+		}
+		os << " )  ";
+	}
+	os << "\n\n";
+
+	selectPrimeImplicants(truthTable, symbolTable, os);
+
+	std::vector<std::string> minimumDisjunctiveNormalForm;
+	for (uint output = 0U; output < truthTable.size(); ++output)
+	{
+		minimumDisjunctiveNormalForm.push_back(getMinimumDisjunctiveNormalFormForOutput(output, symbolTable));
+		os << "\n------------------ Minimum DNF for boolean expression " << (output + 1U) << ":  " << minimumDisjunctiveNormalForm.back() << '\n';
+	}
+	os << "\n\n";
+	return minimumDisjunctiveNormalForm;
+}
+
+
+// Quine&  McCluskey method with output tags. Instead of comparing all terms of neighbouring bit counts, 
+// the partner of a term is searched directly: it has the same mask and one more set bit
+void MultiOutputQuineMcluskey::calculatePrimeImplicants(const std::vector<TruthTable>& truthTable)
+{
+	primeImplicant.clear();
+
+	// The first stage: All minterms of all outputs. Minterms of several outputs get several bits in the tag
+	PrimeImplicantVector stage;
+	for (uint output = 0U; output < truthTable.size(); ++output)
+	{
+		for (const MinTermNumber minterm : truthTable[output])
+		{
+			stage.push_back(PrimeImplicant(narrow_cast<TermType>(minterm), 0U, 1U << output));
+		}
+	}
+	std::sort(stage.begin(), stage.end(), isLessByMaskAndTerm);
+	PrimeImplicantVector::iterator last{ stage.begin() };
+	for (PrimeImplicantVector::iterator pi = stage.begin(); pi != stage.end(); ++pi)
+	{
+		if ((stage.begin() != last) && isEqualByMaskAndTerm(*(last - 1), *pi))
+		{
+			(last - 1)->outputTag |= pi->outputTag;
+		}
+		else
+		{
+			*last++ = *pi;
+		}
+	}
+	stage.erase(last, stage.end());
+
+	// Combine terms, until nothing can be combined any longer
+	while (!stage.empty())
+	{
+		PrimeImplicantVector nextStage;
+		std::vector<bool> combined(stage.size(), false);
+
+		for (std::size_t lower = 0U; lower < stage.size(); ++lower)
+		{
+			// All variables, that are 0 in the term and not yet eliminated, can be combined with a term, where they are 1
+			TermType variables{ static_cast<TermType>(allVariables & ~stage[lower].mask & ~stage[lower].term) };
+			while (0U != variables)
+			{
+				const TermType variable{ static_cast<TermType>(variables & (~variables + 1U)) };
+				variables = static_cast<TermType>(variables & ~variable);
+
+				const PrimeImplicant partner(static_cast<TermType>(stage[lower].term | variable), stage[lower].mask);
+				const PrimeImplicantVector::iterator upperIterator{ std::lower_bound(stage.begin(), stage.end(), partner, isLessByMaskAndTerm) };
+				if ((stage.end() != upperIterator) && isEqualByMaskAndTerm(*upperIterator, partner))
+				{
+					const std::size_t upper{ static_cast<std::size_t>(upperIterator - stage.begin()) };
+					const OutputTagType commonOutputs{ stage[lower].outputTag & stage[upper].outputTag };
+					if (0U != commonOutputs)
+					{
+						nextStage.push_back(PrimeImplicant(stage[lower].term, static_cast<TermType>(stage[lower].mask | variable), commonOutputs));
+						// Only if the new term is used for all outputs of the old term, the old term is not needed any longer
+						if (commonOutputs == stage[lower].outputTag)
+						{
+							combined[lower] = true;
+						}
+						if (commonOutputs == stage[upper].outputTag)
+						{
+							combined[upper] = true;
+						}
+					}
+				}
+			}
+		}
+		for (std::size_t index = 0U; index < stage.size(); ++index)
+		{
+			if (!combined[index])
+			{
+				primeImplicant.push_back(stage[index]);
+			}
+		}
+		// The same term can be created from different pairs. The tag is then always the same
+		std::sort(nextStage.begin(), nextStage.end(), isLessByMaskAndTerm);
+		nextStage.erase(std::unique(nextStage.begin(), nextStage.end(), isEqualByMaskAndTerm), nextStage.end());
+		stage = std::move(nextStage);
+	}
+}
+
+
+// Rows of the prime implicant table are the minterms of all outputs. A prime implicant covers the minterms 
+// of all outputs in its tag. So one column can cover rows of several outputs
+void MultiOutputQuineMcluskey::selectPrimeImplicants(const std::vector<TruthTable>& truthTable, const SymbolTable& symbolTable, std::ostream& os)
+{
+	Coverage coverageForPrimeImplicants;
+	uint rowIndex{ 0U };
+	for (uint output = 0U; output < truthTable.size(); ++output)
+	{
+		for (const MinTermNumber minterm : truthTable[output])
+		{
+			coverageForPrimeImplicants.addRow(rowIndex++, std::to_string(output + 1U) + ':' + std::to_string(minterm), PrimeImplicant(narrow_cast<TermType>(minterm), 0U, 1U << output));
+		}
+	}
+	for (uint columnIndex = 0U; columnIndex < primeImplicant.size(); ++columnIndex)
+	{
+		coverageForPrimeImplicants.addColumn(columnIndex, primeImplicant[columnIndex].toString(symbolTable), primeImplicant[columnIndex]);
+	}
+	coverageForPrimeImplicants.setCheckForCoverFunction([](CellVectorHeader& rowHeader, CellVectorHeader& columnHeader)
+	{
+		const PrimeImplicant minterm{ std::any_cast<PrimeImplicant>(rowHeader.userData) };
+		const PrimeImplicant pi{ std::any_cast<PrimeImplicant>(columnHeader.userData) };
+		return (0U != (minterm.outputTag & pi.outputTag)) && isCoveredBy(minterm.term, pi);
+	});
+	coverageForPrimeImplicants.checkAllCellsForCover();
+
+	const CoverageResult coverageResult{ coverageForPrimeImplicants.reduce(os) };
+
+	// Select the result with the least product terms. If there are several, then the one with the least literals
+	const auto numberOfLiteralsInCoverageSet = [this](const CellVectorHeaderSet& cvhs)
+	{
+		uint result{ 0U };
+		for (const CellVectorHeader& cvh : cvhs)
+		{
+			result += numberOfLiterals(std::any_cast<PrimeImplicant>(cvh.userData));
+		}
+		return result;
+	};
+	const CoverageResult::const_iterator best{ std::min_element(coverageResult.begin(), coverageResult.end(), [&numberOfLiteralsInCoverageSet](const CellVectorHeaderSet& lhs, const CellVectorHeaderSet& rhs)
+	{
+		return (lhs.size() < rhs.size()) || ((lhs.size() == rhs.size()) && (numberOfLiteralsInCoverageSet(lhs) < numberOfLiteralsInCoverageSet(rhs)));
+	}) };
+
+	selectedPrimeImplicant.clear();
+	if (coverageResult.end() != best)
+	{
+		for (const CellVectorHeader& cvh : *best)
+		{
+			selectedPrimeImplicant.push_back(std::any_cast<PrimeImplicant>(cvh.userData));
+		}
+	}
+}
+
+
+// A selected prime implicant may be needed only for other outputs. Those are removed. The ones with most literals first
+std::string MultiOutputQuineMcluskey::getMinimumDisjunctiveNormalFormForOutput(uint output, const SymbolTable& symbolTable) const
+{
+	PrimeImplicantVector candidate;
+	std::copy_if(selectedPrimeImplicant.begin(), selectedPrimeImplicant.end(), std::back_inserter(candidate), [output](const PrimeImplicant& pi) noexcept { return 0U != (pi.outputTag & (1U << output)); });
+	std::stable_sort(candidate.begin(), candidate.end(), [this](const PrimeImplicant& lhs, const PrimeImplicant& rhs) noexcept { return numberOfLiterals(lhs) > numberOfLiterals(rhs); });
+
+	std::vector<bool> removed(candidate.size(), false);
+	for (std::size_t index = 0U; index < candidate.size(); ++index)
+	{
+		// Check all minterms of this prime implicant. Is every one covered by another not removed prime implicant?
+		bool isRedundant{ true };
+		TermType eliminated{ 0U };
+		do
+		{
+			const TermType minterm{ static_cast<TermType>(candidate[index].term | eliminated) };
+			bool isCovered{ false };
+			for (std::size_t other = 0U; (other < candidate.size()) && !isCovered; ++other)
+			{
+				isCovered = (other != index) && !removed[other] && isCoveredBy(minterm, candidate[other]);
+			}
+			isRedundant = isCovered;
+			// Next combination of the eliminated variables
+			eliminated = static_cast<TermType>((eliminated - candidate[index].mask) & candidate[index].mask);
+		} while (isRedundant && (0U != eliminated));
+		removed[index] = isRedundant;
+	}
+
+	// Build the DNF, as a string. Same format and order of terms as for Quine&  McCluskey
+	std::vector<std::string> termString;
+	for (std::size_t index = 0U; index < candidate.size(); ++index)
+	{
+		if (!removed[index])
+		{
+			termString.push_back(candidate[index].toString(symbolTable));
+		}
+	}
+	std::sort(termString.begin(), termString.end());
+	std::string minimumDisjunctiveNormalForm;
+	for (const std::string& ts : termString)
+	{
+		if (!minimumDisjunctiveNormalForm.empty())
+		{
+			minimumDisjunctiveNormalForm += "+";
+		}
+		minimumDisjunctiveNormalForm += ts;
+	}
+	return minimumDisjunctiveNormalForm;
+}
+
+
+
+void evaluateMultipleOutputs(const std::string& booleanExpressions)
+{
+	// Split the boolean expressions
+	std::vector<std::string> source;
+	{
+		std::istringstream iss(booleanExpressions);
+		std::string booleanExpression;
+		while (std::getline(iss, booleanExpression, ';'))
+		{
+			if (booleanExpression.end() != std::find_if(booleanExpression.begin(), booleanExpression.end(), [](const cchar c) { return !std::isspace(static_cast<uchar>(c)); }))
+			{
+				source.push_back(booleanExpression);
+			}
+		}
+	}
+	if (source.empty() || (source.size() > MultiOutputQuineMcluskey::MaxNumberOfOutputs))
+	{
+		std::cerr << "\n\n*** Error: Number of boolean expressions must be 1 ... " << MultiOutputQuineMcluskey::MaxNumberOfOutputs << ". Separate them with ';'\n\n";
+		return;
+	}
+
+	// Compile all boolean expressions and calculate the truth tables. All variables of all boolean expressions will be used
+	std::vector<TruthTable> truthTableOfSource;
+	std::vector<SymbolTable> symbolTableOfSource;
+	SymbolTable symbolTable;
+	for (std::string& booleanExpression : source)
+	{
+		MintermCalculator mc(booleanExpression);
+		if (!mc.runCompiler())
+		{
+			std::cout << "\n\n*** Syntax Error in boolean expression '" << booleanExpression << "'\n\n";
+			return;
+		}
+		symbolTableOfSource.push_back(mc.getSymbolTable());
+		symbolTable.symbol.insert(symbolTableOfSource.back().symbol.begin(), symbolTableOfSource.back().symbol.end());
+		if (symbolTable.numberOfSymbols() > static_cast<uint>(MaxNumberOfBitsForEvaluation))
+		{
+			std::cerr << "\n\n*** Error: Too many boolean variables for this program version (" << symbolTable.numberOfSymbols() << "). Max is: " << MaxNumberOfBitsForEvaluation << "\n\n";
+			return;
+		}
+		truthTableOfSource.push_back(mc.calculate());
+	}
+
+	std::vector<TruthTable> truthTable;
+	for (std::size_t index = 0U; index < source.size(); ++index)
+	{
+		truthTable.push_back(expandTruthTable(truthTableOfSource[index], symbolTableOfSource[index], symbolTable));
+		if (truthTable.back().isContradiction())
+		{
+			std::cerr << "\n\n*** Contradiction. Boolean expression '" << source[index] << "' is always false\n\n";
+			return;
+		}
+		if (truthTable.back().isTautology())
+		{
+			std::cerr << "\n\n*** Tautology. Boolean expression '" << source[index] << "' is always true\n\n";
+			return;
+		}
+	}
+	truthTableOfSource.clear();
+
+	std::cout << "\n\nStart to evaluate " << source.size() << " boolean expressions together. Number of Variables : " << symbolTable.numberOfSymbols() << "\n\n";
+	for (std::size_t index = 0U; index < source.size(); ++index)
+	{
+		std::cout << std::setw(4) << (index + 1U) << ":  '" << source[index] << "'   Calculated number of minterms : " << truthTable[index].numberOfMinterms() << '\n';
+	}
+
+	MultiOutputQuineMcluskey multiOutputQuineMcluskey;
+	const std::vector<std::string> minimizedSource{ multiOutputQuineMcluskey.getMinimumDisjunctiveNormalForms(truthTable, symbolTable) };
+
+	std::cout << "\n\nResult of multi output minimization. Number of different product terms: " << multiOutputQuineMcluskey.getNumberOfProductTerms() << "\n\n";
+	for (std::size_t index = 0U; index < source.size(); ++index)
+	{
+		std::cout << std::setw(4) << (index + 1U) << ":  '" << minimizedSource[index] << "'\n";
+	}
+	std::cout << "\n\n";
+
+	// MCDC analysis for every boolean expression. With the original boolean expression or with the minimized one
+	for (std::size_t index = 0U; index < source.size(); ++index)
+	{
+		std::string sourceForMcdc{ programOption.option[ProgramOption::umdnf].optionSelected ? minimizedSource[index] : source[index] };
+		std::cout << "\n\n------------------ Boolean expression " << (index + 1U) << "\n\nContinue Abstract Syntax Tree Analyis with " 
+			<< (programOption.option[ProgramOption::umdnf].optionSelected ? "minimized" : "original") << " boolean expression\n\n'" << sourceForMcdc << "'\n\n";
+
+		VirtualMachineForAST virtualMachineForAST;
+		CompilerForAST compilerForAST(sourceForMcdc, virtualMachineForAST);
+		if (compilerForAST())
+		{
+			virtualMachineForAST.printTreeStandard(sourceForMcdc);
+			if (!programOption.option[ProgramOption::nomcdc].optionSelected && Mcdc::isSelectedFor(virtualMachineForAST.maxConditionsInTree()))
+			{
+				Mcdc mcdc;
+				mcdc.findMcdcIndependencePairs(virtualMachineForAST);
+				mcdc.generateTestSets();
+			}
+		}
+	}
+}
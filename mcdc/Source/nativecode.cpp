@@ -0,0 +1,413 @@
+// --------------------------------------------------------------------------------------------------------------------------------
+// License:	BSD-3-Clause
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Copyright 2019      Armin Montigny
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+// following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the 
+//    following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the 
+//    following disclaimer in the documentation and /or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or 
+//    promote products derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+
+
+
+// Native code for boolean expressions (JIT Compiler)
+//
+// The byte code of the virtual machine is translated into x86-64 machine code. 
+//
+// Calling convention:
+// - The input value is given in ECX (Windows x64) or EDI (System V, Linux and others). It will be copied to R11D
+// - The result is returned in AL (EAX is 0 or 1)
+//
+// Register usage:
+// - R11D holds the input value
+// - EAX and EDX are scratch registers
+// - Machine registers of the virtual machine are mapped to ECX, R8D, R9D, R10D (caller saved, free to use)
+//   and then to EBX, ESI, EDI, R12D ... R15D (callee saved, will be pushed and poped, if used)
+// - If there are even more machine registers, then they will be stored on the stack
+//
+// Every machine register holds 0 or 1. So we can work with 32 bit operations.
+//
+// A load of a boolean variable (bit position p in the input value) is done via
+//		mov reg, r11d;  shr reg, p;  and reg, 1
+// IDNOT and NOT are an additional  "xor reg, 1". OR, XOR and AND map directly to the CPU instructions
+
+
+#include "nativecode.hpp"
+
+#include <cstring>
+#include <vector>
+
+#if defined(MCDC_NATIVE_CODE_X86_64)
+	#if defined(_WIN32)
+		#define WIN32_LEAN_AND_MEAN
+		#define NOMINMAX
+		#include <windows.h>
+	#else
+		#include <sys/mman.h>
+		#include <unistd.h>
+	#endif
+#endif
+
+
+#if defined(MCDC_NATIVE_CODE_X86_64)
+
+// Numbers of the x86-64 CPU registers as used in the instruction encoding
+namespace X86_64Register
+{
+	constexpr uint EAX{ 0U };
+	constexpr uint ECX{ 1U };
+	constexpr uint EDX{ 2U };
+	constexpr uint EBX{ 3U };
+	constexpr uint ESI{ 6U };
+	constexpr uint EDI{ 7U };
+	constexpr uint R8D{ 8U };
+	constexpr uint R9D{ 9U };
+	constexpr uint R10D{ 10U };
+	constexpr uint R11D{ 11U };
+	constexpr uint R12D{ 12U };
+	constexpr uint R13D{ 13U };
+	constexpr uint R14D{ 14U };
+	constexpr uint R15D{ 15U };
+}
+
+// CPU registers available for the machine registers of the virtual machine. First the caller saved ones
+constexpr uint RegisterPool[]{ X86_64Register::ECX, X86_64Register::R8D, X86_64Register::R9D, X86_64Register::R10D,
+							   X86_64Register::EBX, X86_64Register::ESI, X86_64Register::EDI, X86_64Register::R12D, X86_64Register::R13D, X86_64Register::R14D, X86_64Register::R15D };
+constexpr uint NumberOfRegistersInPool{ sizeof(RegisterPool) / sizeof(RegisterPool[0]) };
+// The first registers in the pool may be used without saving them
+constexpr uint NumberOfCallerSavedRegistersInPool{ 4U };
+
+// Opcodes that we need. All in the form "operation reg, r/m" or "operation r/m, reg"
+constexpr uint8_t OpcodeOrRegisterRM{ 0x0BU };
+constexpr uint8_t OpcodeAndRegisterRM{ 0x23U };
+constexpr uint8_t OpcodeXorRegisterRM{ 0x33U };
+constexpr uint8_t OpcodeMovRegisterRM{ 0x8BU };
+constexpr uint8_t OpcodeMovRMRegister{ 0x89U };
+
+
+// Location of a machine register. Either in a CPU register or on the stack
+struct MachineRegisterLocation
+{
+	bool inCpuRegister{ true };
+	uint cpuRegister{ X86_64Register::EAX };
+	uint32_t stackOffset{ 0U };
+};
+
+
+// Small helper for writing x86-64 instructions into a buffer
+class MachineCodeBuffer
+{
+public:
+	std::vector<uint8_t> code;
+
+	void emitByte(uint8_t byte) { code.push_back(byte); }
+	void emit32(uint32_t value) { for (uint i = 0U; i < 4U; ++i) { emitByte(narrow_cast<uint8_t>(value >> (8U * i))); } }
+
+	// REX prefix is only needed for the registers R8 ... R15 or for 64 bit operations
+	void emitRex(bool operation64Bit, uint reg, uint rm)
+	{
+		const uint8_t rex{ narrow_cast<uint8_t>(0x40U | (operation64Bit ? 0x08U : 0U) | ((reg & 8U) ? 0x04U : 0U) | ((rm & 8U) ? 0x01U : 0U)) };
+		if (0x40U != rex) emitByte(rex);
+	}
+	// Operation with 2 CPU registers
+	void emitRegisterRegister(uint8_t opcode, uint reg, uint rm)
+	{
+		emitRex(false, reg, rm);
+		emitByte(opcode);
+		emitByte(narrow_cast<uint8_t>(0xC0U | ((reg & 7U) << 3U) | (rm & 7U)));
+	}
+	// Operation with a CPU register and a stack location [rsp + offset]
+	void emitRegisterStack(uint8_t opcode, uint reg, uint32_t offset)
+	{
+		emitRex(false, reg, 0U);
+		emitByte(opcode);
+		emitByte(narrow_cast<uint8_t>(0x84U | ((reg & 7U) << 3U)));	// mod = 10, rm = 100 --> SIB follows
+		emitByte(0x24U);												// SIB: base = rsp, no index
+		emit32(offset);
+	}
+	// Operation with an 8 bit immediate value. opcode 0x83 or 0xC1 with extension in the reg field
+	void emitRegisterImmediate(uint8_t opcode, uint extension, uint rm, uint8_t immediate)
+	{
+		emitRex(false, 0U, rm);
+		emitByte(opcode);
+		emitByte(narrow_cast<uint8_t>(0xC0U | (extension << 3U) | (rm & 7U)));
+		emitByte(immediate);
+	}
+
+	void emitShiftRight(uint reg, uint8_t count) { emitRegisterImmediate(0xC1U, 5U, reg, count); }
+	void emitAndImmediate(uint reg, uint8_t value) { emitRegisterImmediate(0x83U, 4U, reg, value); }
+	void emitXorImmediate(uint reg, uint8_t value) { emitRegisterImmediate(0x83U, 6U, reg, value); }
+	void emitPush(uint reg) { emitRex(false, 0U, reg); emitByte(narrow_cast<uint8_t>(0x50U + (reg & 7U))); }
+	void emitPop(uint reg) { emitRex(false, 0U, reg); emitByte(narrow_cast<uint8_t>(0x58U + (reg & 7U))); }
+	void emitSubRsp(uint32_t value) { emitByte(0x48U); emitByte(0x81U); emitByte(0xECU); emit32(value); }
+	void emitAddRsp(uint32_t value) { emitByte(0x48U); emitByte(0x81U); emitByte(0xC4U); emit32(value); }
+	void emitReturn() { emitByte(0xC3U); }
+
+	// Move a machine register (where ever it is) into a CPU register
+	void emitLoad(uint reg, const MachineRegisterLocation& source)
+	{
+		if (source.inCpuRegister)
+		{
+			if (source.cpuRegister != reg) emitRegisterRegister(OpcodeMovRegisterRM, reg, source.cpuRegister);
+		}
+		else
+		{
+			emitRegisterStack(OpcodeMovRegisterRM, reg, source.stackOffset);
+		}
+	}
+	// Move a CPU register into a machine register (where ever it is)
+	void emitStore(const MachineRegisterLocation& destination, uint reg)
+	{
+		if (destination.inCpuRegister)
+		{
+			if (destination.cpuRegister != reg) emitRegisterRegister(OpcodeMovRegisterRM, destination.cpuRegister, reg);
+		}
+		else
+		{
+			emitRegisterStack(OpcodeMovRMRegister, reg, destination.stackOffset);
+		}
+	}
+	// Operation "reg = reg op machine register"
+	void emitOperation(uint8_t opcode, uint reg, const MachineRegisterLocation& source)
+	{
+		if (source.inCpuRegister)
+		{
+			emitRegisterRegister(opcode, reg, source.cpuRegister);
+		}
+		else
+		{
+			emitRegisterStack(opcode, reg, source.stackOffset);
+		}
+	}
+};
+
+
+// Allocate executable memory, copy the code into it and protect it against writing
+static void* allocateExecutableMemory(const std::vector<uint8_t>& code, std::size_t& memorySize)
+{
+	void* memory{ nullptr };
+#if defined(_WIN32)
+	SYSTEM_INFO systemInfo;
+	GetSystemInfo(&systemInfo);
+	const std::size_t pageSize{ systemInfo.dwPageSize };
+	memorySize = ((code.size() + pageSize - 1U) / pageSize) * pageSize;
+	memory = VirtualAlloc(nullptr, memorySize, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+	if (nullptr != memory)
+	{
+		std::memcpy(memory, code.data(), code.size());
+		DWORD oldProtection{ 0U };
+		if (!VirtualProtect(memory, memorySize, PAGE_EXECUTE_READ, &oldProtection))
+		{
+			VirtualFree(memory, 0U, MEM_RELEASE);
+			memory = nullptr;
+		}
+		else
+		{
+			FlushInstructionCache(GetCurrentProcess(), memory, memorySize);
+		}
+	}
+#else
+	const long pageSizeFromSystem{ sysconf(_SC_PAGESIZE) };
+	const std::size_t pageSize{ (pageSizeFromSystem > 0L) ? static_cast<std::size_t>(pageSizeFromSystem) : 4096U };
+	memorySize = ((code.size() + pageSize - 1U) / pageSize) * pageSize;
+	memory = mmap(nullptr, memorySize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (MAP_FAILED == memory)
+	{
+		memory = nullptr;
+	}
+	else
+	{
+		std::memcpy(memory, code.data(), code.size());
+		if (0 != mprotect(memory, memorySize, PROT_READ | PROT_EXEC))
+		{
+			munmap(memory, memorySize);
+			memory = nullptr;
+		}
+	}
+#endif
+	return memory;
+}
+
+#endif
+
+
+// Translate the byte code to x86-64 machine code
+bool NativeCodeForBooleanExpressions::compile(const ByteCodeProgram& byteCodeProgram, uint numberOfMachineRegisters)
+{
+	// Remove old code
+	release();
+#if defined(MCDC_NATIVE_CODE_X86_64)
+	if (byteCodeProgram.empty())
+	{
+		return false;
+	}
+
+	// Map the machine registers to CPU registers or to the stack
+	std::vector<MachineRegisterLocation> location(numberOfMachineRegisters);
+	uint numberOfStackSlots{ 0U };
+	for (uint machineRegister = 0U; machineRegister < numberOfMachineRegisters; ++machineRegister)
+	{
+		if (machineRegister < NumberOfRegistersInPool)
+		{
+			location[machineRegister].cpuRegister = RegisterPool[machineRegister];
+		}
+		else
+		{
+			location[machineRegister].inCpuRegister = false;
+			location[machineRegister].stackOffset = 4U * numberOfStackSlots;
+			++numberOfStackSlots;
+		}
+	}
+	// Callee saved registers that we use
+	const uint numberOfUsedPoolRegisters{ (numberOfMachineRegisters < NumberOfRegistersInPool) ? numberOfMachineRegisters : NumberOfRegistersInPool };
+	// Stack frame for the machine registers that did not fit into CPU registers. Keep it 8 byte aligned
+	const uint32_t stackFrameSize{ ((4U * numberOfStackSlots) + 7U) & ~7U };
+
+	MachineCodeBuffer mcb;
+
+	// Prologue. Save callee saved registers, create stack frame and copy input value to R11D
+	for (uint i = NumberOfCallerSavedRegistersInPool; i < numberOfUsedPoolRegisters; ++i)
+	{
+		mcb.emitPush(RegisterPool[i]);
+	}
+	if (stackFrameSize > 0U) mcb.emitSubRsp(stackFrameSize);
+#if defined(_WIN32)
+	mcb.emitRegisterRegister(OpcodeMovRegisterRM, X86_64Register::R11D, X86_64Register::ECX);
+#else
+	mcb.emitRegisterRegister(OpcodeMovRegisterRM, X86_64Register::R11D, X86_64Register::EDI);
+#endif
+
+	// Epilogue. Result is in EAX
+	const auto emitEpilogue = [&]()
+	{
+		if (stackFrameSize > 0U) mcb.emitAddRsp(stackFrameSize);
+		for (uint i = numberOfUsedPoolRegisters; i > NumberOfCallerSavedRegistersInPool; --i)
+		{
+			mcb.emitPop(RegisterPool[i - 1U]);
+		}
+		mcb.emitReturn();
+	};
+
+	// Work register for an operation. Either the destination CPU register or, if on the stack, EAX
+	const auto workRegister = [](const MachineRegisterLocation& destination) { return destination.inCpuRegister ? destination.cpuRegister : X86_64Register::EAX; };
+
+	bool endFound{ false };
+	for (const ByteCodeLine& bcl : byteCodeProgram)
+	{
+		switch (bcl.operation)
+		{
+		case Token::ID:
+		case Token::IDNOT:
+			{
+				// Load bit from input value
+				const MachineRegisterLocation& destination{ location[bcl.parameter2] };
+				const uint reg{ workRegister(destination) };
+				mcb.emitRegisterRegister(OpcodeMovRegisterRM, reg, X86_64Register::R11D);
+				if (bcl.parameter1 > 0U) mcb.emitShiftRight(reg, narrow_cast<uint8_t>(bcl.parameter1));
+				mcb.emitAndImmediate(reg, 1U);
+				if (Token::IDNOT == bcl.operation) mcb.emitXorImmediate(reg, 1U);
+				mcb.emitStore(destination, reg);
+			}
+			break;
+		case Token::OR:
+		case Token::XOR:
+		case Token::AND:
+			{
+				const uint8_t opcode{ (Token::OR == bcl.operation) ? OpcodeOrRegisterRM : ((Token::XOR == bcl.operation) ? OpcodeXorRegisterRM : OpcodeAndRegisterRM) };
+				const MachineRegisterLocation& source1{ location[bcl.parameter1] };
+				const MachineRegisterLocation& source2{ location[bcl.parameter2] };
+				const MachineRegisterLocation& destination{ location[bcl.parameter3] };
+				if (destination.inCpuRegister && source2.inCpuRegister && (destination.cpuRegister == source2.cpuRegister))
+				{
+					// Destination is source 2. Operations are commutative, so: dest = dest op source1 
+					mcb.emitOperation(opcode, destination.cpuRegister, source1);
+				}
+				else
+				{
+					// reg = source1; reg = reg op source2; destination = reg
+					const uint reg{ workRegister(destination) };
+					mcb.emitLoad(reg, source1);
+					mcb.emitOperation(opcode, reg, source2);
+					mcb.emitStore(destination, reg);
+				}
+			}
+			break;
+		case Token::NOT:
+			{
+				const MachineRegisterLocation& destination{ location[bcl.parameter2] };
+				const uint reg{ workRegister(destination) };
+				mcb.emitLoad(reg, location[bcl.parameter1]);
+				mcb.emitXorImmediate(reg, 1U);
+				mcb.emitStore(destination, reg);
+			}
+			break;
+		case Token::END:
+			mcb.emitLoad(X86_64Register::EAX, location[bcl.parameter1]);
+			emitEpilogue();
+			endFound = true;
+			break;
+#pragma warning(suppress: 4061)
+#pragma warning(suppress: 4062)
+		default: break;
+		}
+		if (endFound) break;
+	}
+	if (!endFound)
+	{
+		return false;
+	}
+
+	// Make it executable
+	executableMemory = allocateExecutableMemory(mcb.code, executableMemorySize);
+	if (nullptr != executableMemory)
+	{
+		nativeCodeSize = mcb.code.size();
+		nativeFunction = reinterpret_cast<NativeFunction>(executableMemory);
+	}
+#else
+	// Not supported on this architecture
+	(void)byteCodeProgram;
+	(void)numberOfMachineRegisters;
+#endif
+	return isAvailable();
+}
+
+
+// Free the executable memory
+void NativeCodeForBooleanExpressions::release() noexcept
+{
+#if defined(MCDC_NATIVE_CODE_X86_64)
+	if (nullptr != executableMemory)
+	{
+#if defined(_WIN32)
+		VirtualFree(executableMemory, 0U, MEM_RELEASE);
+#else
+		munmap(executableMemory, executableMemorySize);
+#endif
+	}
+#endif
+	executableMemory = nullptr;
+	executableMemorySize = 0U;
+	nativeCodeSize = 0U;
+	nativeFunction = nullptr;
+}
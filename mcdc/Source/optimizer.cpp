@@ -0,0 +1,225 @@
+// --------------------------------------------------------------------------------------------------------------------------------
+// License:	BSD-3-Clause
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Copyright 2019      Armin Montigny
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+// following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the 
+//    following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the 
+//    following disclaimer in the documentation and /or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or 
+//    promote products derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+
+
+
+// Optimizer for the object code of the virtual machine
+//
+// The object code is first converted into a list of values with value numbering. Identical operations get
+// the same value number. This eliminates common sub expressions. NOT operations are folded into
+// loads or removed, if they are doubled.
+//
+// Then all values needed for the result will be marked, starting at the END operation. All other
+// values are dead and will not be generated.
+//
+// Finally new object code will be generated. Registers are allocated again. A register will be available
+// after the last use of its value and can be reused immediately for the destination of the same operation.
+
+
+#include "optimizer.hpp"
+
+#include <algorithm>
+
+
+// Get a value number for an operation. Create a new value only, if it does not yet exist
+uint OptimizerForVM::getValueNumber(Token operation, uint operand1, uint operand2)
+{
+	uint result{ 0U };
+	const std::tuple<Token, uint, uint> key{ operation, operand1, operand2 };
+	std::map<std::tuple<Token, uint, uint>, uint>::iterator valueIterator{ valueNumberForOperation.find(key) };
+	if (valueNumberForOperation.end() != valueIterator)
+	{
+		// Common sub expression. We know this value already
+		result = valueIterator->second;
+	}
+	else
+	{
+		// New value
+		result = narrow_cast<uint>(value.size());
+		value.push_back({ operation, operand1, operand2 });
+		valueNumberForOperation[key] = result;
+	}
+	return result;
+}
+
+
+// Negate a value. Fold NOT into the loads and eliminate double NOT
+uint OptimizerForVM::getNegatedValueNumber(uint valueNumber)
+{
+	uint result{ 0U };
+	const Value v{ value[valueNumber] };
+	switch (v.operation)
+	{
+	case Token::ID:		result = getValueNumber(Token::IDNOT, v.operand1, 0U); break;
+	case Token::IDNOT:	result = getValueNumber(Token::ID, v.operand1, 0U); break;
+	case Token::NOT:	result = v.operand1; break;
+#pragma warning(suppress: 4061)
+#pragma warning(suppress: 4062)
+	default:			result = getValueNumber(Token::NOT, valueNumber, 0U); break;
+	}
+	return result;
+}
+
+
+// Do all optimizations
+void OptimizerForVM::optimize()
+{
+	numberOfOpCodesBefore = narrow_cast<uint>(objectCode.opCode.size());
+	numberOfOpCodesAfter = numberOfOpCodesBefore;
+	value.clear();
+	valueNumberForOperation.clear();
+
+	// 1. Value numbering. Which value is currently in which register
+	std::map<uint, uint> valueInRegister;
+	uint resultValue{ 0U };
+	bool endFound{ false };
+	for (const OpCodeLine& opCodeLine : objectCode.opCode)
+	{
+		switch (opCodeLine.token)
+		{
+		case Token::ID:
+		case Token::IDNOT:
+			valueInRegister[opCodeLine.parameter2] = getValueNumber(opCodeLine.token, opCodeLine.parameter1, 0U);
+			break;
+		case Token::OR:
+		case Token::XOR:
+		case Token::AND:
+			{
+				const uint operand1{ valueInRegister[opCodeLine.parameter1] };
+				const uint operand2{ valueInRegister[opCodeLine.parameter2] };
+				// x OR x = x and x AND x = x
+				if ((operand1 == operand2) && (Token::XOR != opCodeLine.token))
+				{
+					valueInRegister[opCodeLine.parameter3] = operand1;
+				}
+				else
+				{
+					// Operations are commutative. Sort the operands, so that a+b and b+a are the same value
+					valueInRegister[opCodeLine.parameter3] = getValueNumber(opCodeLine.token, std::min(operand1, operand2), std::max(operand1, operand2));
+				}
+			}
+			break;
+		case Token::NOT:
+			valueInRegister[opCodeLine.parameter2] = getNegatedValueNumber(valueInRegister[opCodeLine.parameter1]);
+			break;
+		case Token::END:
+			resultValue = valueInRegister[opCodeLine.parameter1];
+			endFound = true;
+			break;
+#pragma warning(suppress: 4061)
+#pragma warning(suppress: 4062)
+		default: break;
+		}
+	}
+	// Without result there is nothing to do
+	if (!endFound) return;
+
+	// 2. Dead value elimination. Mark all values, that are needed for the result, and find the last use of each value
+	const uint numberOfValues{ narrow_cast<uint>(value.size()) };
+	std::vector<bool> valueIsUsed(numberOfValues, false);
+	// The END operation is the last use of the result
+	std::vector<uint> lastUse(numberOfValues, 0U);
+	valueIsUsed[resultValue] = true;
+	lastUse[resultValue] = numberOfValues;
+	// Operands have always a lower value number than the operation. So go backwards
+	for (uint valueNumber = numberOfValues; valueNumber > 0U; --valueNumber)
+	{
+		const uint current{ valueNumber - 1U };
+		const Value& v{ value[current] };
+		if (valueIsUsed[current] && (Token::ID != v.operation) && (Token::IDNOT != v.operation))
+		{
+			valueIsUsed[v.operand1] = true;
+			lastUse[v.operand1] = std::max(lastUse[v.operand1], current);
+			if (Token::NOT != v.operation)
+			{
+				valueIsUsed[v.operand2] = true;
+				lastUse[v.operand2] = std::max(lastUse[v.operand2], current);
+			}
+		}
+	}
+
+	// 3. Generate new object code with new register allocation
+	std::vector<OpCodeLine> optimizedOpCode;
+	std::vector<bool> availableRegister;
+	std::vector<uint> registerForValue(numberOfValues, 0U);
+	// Free the register of an operand, if this is its last use
+	const auto freeRegister = [&](uint operand, uint current) { if (lastUse[operand] == current) availableRegister[registerForValue[operand]] = true; };
+	// Use the lowest available register or a new one
+	const auto getNextAvailableRegister = [&]() 
+	{ 
+		const std::vector<bool>::iterator available{ std::find(availableRegister.begin(), availableRegister.end(), true) };
+		const uint result{ narrow_cast<uint>(std::distance(availableRegister.begin(), available)) };
+		if (availableRegister.end() == available) availableRegister.push_back(false); else *available = false;
+		return result;
+	};
+
+	for (uint current = 0U; current < numberOfValues; ++current)
+	{
+		if (valueIsUsed[current])
+		{
+			const Value& v{ value[current] };
+			OpCodeLine opCodeLine;
+			opCodeLine.token = v.operation;
+			switch (v.operation)
+			{
+			case Token::ID:
+			case Token::IDNOT:
+				opCodeLine.parameter1 = v.operand1;
+				opCodeLine.parameter2 = registerForValue[current] = getNextAvailableRegister();
+				// For the listing of the program
+				opCodeLine.parameter3 = static_cast<uint>('a') + v.operand1;
+				break;
+			case Token::NOT:
+				opCodeLine.parameter1 = registerForValue[v.operand1];
+				freeRegister(v.operand1, current);
+				opCodeLine.parameter2 = registerForValue[current] = getNextAvailableRegister();
+				break;
+#pragma warning(suppress: 4061)
+#pragma warning(suppress: 4062)
+			default:
+				// OR, XOR, AND
+				opCodeLine.parameter1 = registerForValue[v.operand1];
+				opCodeLine.parameter2 = registerForValue[v.operand2];
+				freeRegister(v.operand1, current);
+				if (v.operand1 != v.operand2) freeRegister(v.operand2, current);
+				opCodeLine.parameter3 = registerForValue[current] = getNextAvailableRegister();
+				break;
+			}
+			optimizedOpCode.push_back(opCodeLine);
+		}
+	}
+	OpCodeLine endLine;
+	endLine.token = Token::END;
+	endLine.parameter1 = registerForValue[resultValue];
+	optimizedOpCode.push_back(endLine);
+
+	objectCode.opCode = std::move(optimizedOpCode);
+	numberOfOpCodesAfter = narrow_cast<uint>(objectCode.opCode.size());
+}
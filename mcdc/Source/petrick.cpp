@@ -104,50 +104,275 @@
 
 
 #include "petrick.hpp"
+#include "statistics.hpp"
+#include "threadpool.hpp"
 
 #include <algorithm>
+#include <iterator>
 
 // Functor operator for applying Petricks methhod
 
 ProductTermVector PetricksMethod::operator ()(const CNF& cnf)
 {
-	// We select an iterative approach. Start with the first Element of the CNF (which is a DNF)
-	// And we sorte the result of each iterative operation again in this element
-	DNF resultingDNF{ cnf[0] };
-	// We will always start with the element 1 (not element 0) becuase in 0 is the initial value
-	// or respectively the intermediate result
-	for (CNF::size_type dnfInCnfIndex = 1; dnfInCnfIndex < cnf.size(); ++dnfInCnfIndex)
+	// Time and the size of the DNF after every multiplication for option -stats
+	StageTimer stageTimer("PetricksMethod");
+	stageTimer().add("clauses", cnf.size());
+
+	// All product terms get one bit for every variable used in the CNF
+	std::size_t numberOfVariables{ 0U };
+	for (const DNF& dnf : cnf)
 	{
-		// Result of multipliyong out od the intermediate (initial) value with the current CNF Product term
-		DNF intermediateCalculatedDNF;
-		// Now go through all elements of the intermediate (initial) product term/DNF
-		// For (1+2)(3+4)  this would be the (1+2) part
-		for (const ProductTerm& productTermLeftSide : resultingDNF)
+		for (const ProductTerm& productTerm : dnf)
 		{
-			// Next we will iterate over all Minterms in the next DNF
-			// For (1+2)(3+4)  this would be the (3+4) part
-			for (const ProductTerm& productTermRightSide : cnf[dnfInCnfIndex])
+			if (!productTerm.empty())
 			{
-				ProductTerm productTerm{ productTermLeftSide }; // Resulting Product term is now 1
-				// Add all elements from the right side
-				productTerm.insert(productTermRightSide.begin(), productTermRightSide.end());	// Resulting Product term is now 1,2
-				intermediateCalculatedDNF.insert(std::move(productTerm));  // Store this one
-				// And continue to add more product terms. The stl::set will ensure the idempotence law and prevent memory waste
+				numberOfVariables = std::max(numberOfVariables, static_cast<std::size_t>(*productTerm.rbegin()) + 1U);
 			}
 		}
-		// And now add all found terms to the result and continue with the next element of the right hand side
-		// Please note: also here the set will prevent double terms
-		resultingDNF = std::move(intermediateCalculatedDNF);
 	}
 
-	// Now we have the result (with 10 lines of code). The result contains all product terms in DNF
+	// Convert the clauses to bitsets. Small clauses first, so that the DNF grows slowly
+	std::vector<BitDNF> clause;
+	for (const DNF& dnf : cnf)
+	{
+		BitDNF bitDnf;
+		for (const ProductTerm& productTerm : dnf)
+		{
+			BitProductTerm bitProductTerm(numberOfVariables);
+			for (const BooleanVariable booleanVariable : productTerm)
+			{
+				bitProductTerm.set(booleanVariable);
+			}
+			bitDnf.push_back(std::move(bitProductTerm));
+		}
+		clause.push_back(std::move(bitDnf));
+	}
+	std::stable_sort(clause.begin(), clause.end(), [](const BitDNF& left, const BitDNF& right) noexcept { return left.size() < right.size(); });
+
+	// No minimum product term can be longer than a product term found with a simple greedy method
+	const std::size_t upperBound{ calculateUpperBound(clause) };
+	stageTimer().add("upperBound", upperBound);
+
+	BitDNF resultingDNF{};
+	if (multiplyInParallel && (clause.size() > MinimumNumberOfClausesPerTask))
+	{
+		// Balanced tree of sub products on the thread pool. Only the size of the final DNF is recorded
+		resultingDNF = multiplyTree(clause, 0U, clause.size(), upperBound);
+		stageTimer().add("parallel", 1U);
+		stageTimer().append("dnfSize", resultingDNF.size());
+	}
+	else
+	{
+		// We select an iterative approach. Start with the neutral element (the empty product term)
+		// And multiply the result of each iterative operation with the next clause
+		resultingDNF.push_back(BitProductTerm(numberOfVariables));
+		for (const BitDNF& bitDnf : clause)
+		{
+			resultingDNF = multiply(resultingDNF, bitDnf);
+			// Product terms, that are longer than the upper bound, can never be a minimum result
+			applyAbsorption(resultingDNF, upperBound);
+			stageTimer().append("dnfSize", resultingDNF.size());
+		}
+	}
+
+	// Now we have the result. The result contains all not absorbed product terms in DNF
 	// But for our prupose we are only interested in the minimum size terms
 	// so, lets find the element with the minimu size (can be more than one)
-	uint minLength{ narrow_cast<uint>(std::min_element(resultingDNF.begin(), resultingDNF.end(), [](const ProductTerm & left, const ProductTerm & right) noexcept {return left.size() < right.size(); })->size()) };
+	std::size_t minLength{ upperBound };
+	for (const BitProductTerm& pt : resultingDNF)
+	{
+		minLength = std::min(minLength, pt.count());
+	}
 	// And from the big list of the DNF with all product terms, we copy all elements having the minimu size to the result. These are our best coverage sets
-	ProductTermVector cheapestVector;
-	// Copy result and return it to caller
-	std::copy_if(resultingDNF.begin(), resultingDNF.end(), std::back_inserter(cheapestVector), [&minLength](const ProductTerm& pt) noexcept {return pt.size() == minLength; });
+	// The set sorts them in the same way as before
+	std::set<ProductTerm> cheapestSet;
+	for (const BitProductTerm& pt : resultingDNF)
+	{
+		if (pt.count() == minLength)
+		{
+			ProductTerm productTerm;
+			for (std::size_t bit = pt.findNext(0U); bit < pt.size(); bit = pt.findNext(bit + 1U))
+			{
+				productTerm.insert(narrow_cast<BooleanVariable>(bit));
+			}
+			cheapestSet.insert(std::move(productTerm));
+		}
+	}
+	ProductTermVector cheapestVector(cheapestSet.begin(), cheapestSet.end());
+	stageTimer().add("productTerms", resultingDNF.size());
+	stageTimer().add("minimumProductTerms", cheapestVector.size());
 	return cheapestVector;
 }
 
+
+// Multiply out (dnf) * (clause). For (1+2)(3+4) the result is 13+14+23+24
+// If a product term of the DNF contains already a product term of the clause, then all other products are absorbed by it: 
+// 1(1+3) = 1+13 = 1. So the product term is taken as is
+PetricksMethod::BitDNF PetricksMethod::multiply(const BitDNF& dnf, const BitDNF& clause)
+{
+	BitDNF result;
+	for (const BitProductTerm& productTermLeftSide : dnf)
+	{
+		if (clause.end() != std::find_if(clause.begin(), clause.end(), [&productTermLeftSide](const BitProductTerm& pt) noexcept { return pt.isSubsetOf(productTermLeftSide); }))
+		{
+			result.push_back(productTermLeftSide);
+		}
+		else
+		{
+			for (const BitProductTerm& productTermRightSide : clause)
+			{
+				result.push_back(productTermLeftSide);
+				result.back() |= productTermRightSide;
+			}
+		}
+	}
+	return result;
+}
+
+
+// Absorption law X + XY = X. Product terms are sorted by their number of variables
+// A product term can only be absorbed by a shorter one. Double product terms are removed first
+// Product terms, that are longer than the upper bound, can never be a minimum result
+void PetricksMethod::applyAbsorption(BitDNF& dnf, std::size_t upperBound)
+{
+	std::vector<std::pair<std::size_t, BitProductTerm>> lengthAndProductTerm;
+	lengthAndProductTerm.reserve(dnf.size());
+	for (BitProductTerm& pt : dnf)
+	{
+		const std::size_t length{ pt.count() };
+		if (length <= upperBound)
+		{
+			lengthAndProductTerm.emplace_back(length, std::move(pt));
+		}
+	}
+	std::sort(lengthAndProductTerm.begin(), lengthAndProductTerm.end());
+	lengthAndProductTerm.erase(std::unique(lengthAndProductTerm.begin(), lengthAndProductTerm.end()), lengthAndProductTerm.end());
+
+	dnf.clear();
+	// Product terms in dnf with a shorter length than the currently checked one
+	std::size_t numberOfShorterProductTerms{ 0U };
+	for (std::size_t index = 0U; index < lengthAndProductTerm.size(); ++index)
+	{
+		if ((index > 0U) && (lengthAndProductTerm[index].first != lengthAndProductTerm[index - 1U].first))
+		{
+			numberOfShorterProductTerms = dnf.size();
+		}
+		const BitProductTerm& pt{ lengthAndProductTerm[index].second };
+		if (dnf.begin() + static_cast<std::ptrdiff_t>(numberOfShorterProductTerms) == std::find_if(dnf.begin(), dnf.begin() + static_cast<std::ptrdiff_t>(numberOfShorterProductTerms), [&pt](const BitProductTerm& shorter) noexcept { return shorter.isSubsetOf(pt); }))
+		{
+			dnf.push_back(std::move(lengthAndProductTerm[index].second));
+		}
+	}
+}
+
+
+// Greedy: As long as there are not satisfied clauses, take the product term of such a clause, 
+// which satisfies the most not satisfied clauses. The length of the result is an upper bound for the minimum
+std::size_t PetricksMethod::calculateUpperBound(const std::vector<BitDNF>& clause)
+{
+	std::size_t result{ 0U };
+	if (!clause.empty() && !clause[0].empty())
+	{
+		BitProductTerm greedyProductTerm(clause[0][0].size());
+		const auto isSatisfied = [&greedyProductTerm](const BitDNF& bitDnf) { return bitDnf.end() != std::find_if(bitDnf.begin(), bitDnf.end(), [&greedyProductTerm](const BitProductTerm& pt) noexcept { return pt.isSubsetOf(greedyProductTerm); }); };
+
+		std::vector<bool> satisfied(clause.size(), false);
+		for (std::size_t index = 0U; index < clause.size(); ++index)
+		{
+			if (!satisfied[index] && !isSatisfied(clause[index]))
+			{
+				// Select the product term of this clause, that satisfies the most other not satisfied clauses
+				std::size_t bestNumberOfSatisfiedClauses{ 0U };
+				BitProductTerm bestProductTerm{ clause[index][0] };
+				for (const BitProductTerm& candidate : clause[index])
+				{
+					BitProductTerm extended{ greedyProductTerm };
+					extended |= candidate;
+					std::size_t numberOfSatisfiedClauses{ 0U };
+					for (std::size_t other = index; other < clause.size(); ++other)
+					{
+						if (!satisfied[other] && (clause[other].end() != std::find_if(clause[other].begin(), clause[other].end(), [&extended](const BitProductTerm& pt) noexcept { return pt.isSubsetOf(extended); })))
+						{
+							++numberOfSatisfiedClauses;
+						}
+					}
+					if (numberOfSatisfiedClauses > bestNumberOfSatisfiedClauses)
+					{
+						bestNumberOfSatisfiedClauses = numberOfSatisfiedClauses;
+						bestProductTerm = candidate;
+					}
+				}
+				greedyProductTerm |= bestProductTerm;
+			}
+			satisfied[index] = true;
+		}
+		result = greedyProductTerm.count();
+	}
+	return result;
+}
+
+
+
+// Fold the clauses [first, last) into one DNF, starting with the neutral element (the empty product term)
+PetricksMethod::BitDNF PetricksMethod::multiplySequential(const std::vector<BitDNF>& clause, std::size_t first, std::size_t last, std::size_t upperBound)
+{
+	BitDNF result{ BitProductTerm(clause[first].empty() ? 0U : clause[first][0].size()) };
+	for (std::size_t index = first; index < last; ++index)
+	{
+		result = multiply(result, clause[index]);
+		applyAbsorption(result, upperBound);
+	}
+	return result;
+}
+
+
+// (C1 C2 .. Cn) = (C1 .. Cm)(Cm+1 .. Cn). The first half is calculated in another task, the second half by the calling thread
+// Waiting for the first half does not block a worker. It executes other tasks in the meantime
+PetricksMethod::BitDNF PetricksMethod::multiplyTree(const std::vector<BitDNF>& clause, std::size_t first, std::size_t last, std::size_t upperBound)
+{
+	BitDNF result{};
+	if ((last - first) <= MinimumNumberOfClausesPerTask)
+	{
+		result = multiplySequential(clause, first, last, upperBound);
+	}
+	else
+	{
+		const std::size_t middle{ first + ((last - first) / 2U) };
+		std::future<BitDNF> leftSide{ threadPool().submit([&clause, first, middle, upperBound]() { return multiplyTree(clause, first, middle, upperBound); }) };
+		const BitDNF rightSide{ multiplyTree(clause, middle, last, upperBound) };
+		threadPool().wait(leftSide);
+		result = multiplyParallel(leftSide.get(), rightSide, upperBound);
+	}
+	return result;
+}
+
+
+// Multiply 2 sub products. The left side is split in blocks. Each block is multiplied with the right side and reduced
+// in its own task. A product term absorbed within a block is also absorbed in the complete DNF. So the final absorption
+// works on the already reduced blocks
+PetricksMethod::BitDNF PetricksMethod::multiplyParallel(const BitDNF& left, const BitDNF& right, std::size_t upperBound)
+{
+	BitDNF result{};
+	if (left.size() < (2U * MinimumNumberOfProductTermsPerBlock))
+	{
+		result = multiply(left, right);
+	}
+	else
+	{
+		const uint numberOfBlocks{ narrow_cast<uint>((left.size() + MinimumNumberOfProductTermsPerBlock - 1U) / MinimumNumberOfProductTermsPerBlock) };
+		std::vector<BitDNF> blockResult(numberOfBlocks);
+		threadPool().parallelFor(0U, numberOfBlocks, 1U, [&left, &right, &blockResult, upperBound](uint block)
+		{
+			const std::size_t blockStart{ block * MinimumNumberOfProductTermsPerBlock };
+			const std::size_t blockEnd{ std::min(left.size(), blockStart + MinimumNumberOfProductTermsPerBlock) };
+			blockResult[block] = multiply(BitDNF(left.begin() + static_cast<std::ptrdiff_t>(blockStart), left.begin() + static_cast<std::ptrdiff_t>(blockEnd)), right);
+			applyAbsorption(blockResult[block], upperBound);
+		});
+		for (BitDNF& bitDnf : blockResult)
+		{
+			std::move(bitDnf.begin(), bitDnf.end(), std::back_inserter(result));
+		}
+	}
+	applyAbsorption(result, upperBound);
+	return result;
+}
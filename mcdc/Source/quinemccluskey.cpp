@@ -97,10 +97,11 @@
 
 #include "quinemccluskey.hpp"
 #include "cloption.hpp"
+#include "threadpool.hpp"
+#include "espresso.hpp"
+#include "statistics.hpp"
 
 #include <cmath>
-#include <thread>
-#include <future>
 
 #include <iostream>
 #include <iomanip>
@@ -109,42 +110,43 @@
 
 // In order to find a minimum set of Prime Implicants we need to solve the set cover or unate covarge problem
 // Bevor we can start doing the slection of prime implicant, we must initialze the coverage table
-void  QuineMcluskey::initializeCoverageForPrimeImplicants(Coverage& coverageForPrimeImplicants, MintermVector& mv, const SymbolTable& symbolTable)
+template <typename TermType>
+void  QuineMcluskeyForTermWidth<TermType>::initializeCoverageForPrimeImplicants(Coverage& coverageForPrimeImplicants, const TruthTable& truthTable, const SymbolTable& symbolTable)
 {
 	// Add all minterms as rows
-	for (const MinTermType minTerm : mv)
+	for (const MinTermNumber minTerm : truthTable)
 	{
-		coverageForPrimeImplicants.addRow(minTerm);
+		coverageForPrimeImplicants.addRow(narrow_cast<uint>(minTerm));
 	}
 	// Add all prime implicants as columms
-	for (PrimeImplicantType primeImplicant : primeImplicantSetResult)
+	for (PrimeImplicantType<TermType> primeImplicant : primeImplicantSetResult)
 	{
 		// Additionally store the prime implicant name in the column header
 		std::string primeImplicantString{ primeImplicant.toString(symbolTable) };
-		coverageForPrimeImplicants.addColumn(primeImplicant.term, primeImplicantString, primeImplicant);
+		coverageForPrimeImplicants.addColumn(narrow_cast<uint>(primeImplicant.term), primeImplicantString, primeImplicant);
 	}
 }
 
 // This is the next part of the initialization for the coverage table for prime implicants
 // The covering cells are determined and set
 // minTermRowHeader + primeImplicantColumnHeader
-// This is a call back function
+// This is a call back function. There is one for each term width
+template <typename TermType>
 bool checkCoverForCell(const CellVectorHeader& minTermRowHeader, CellVectorHeader& primeImplicantColumnHeader)
 {
 	// The Prime Implicant Info has been stored in the any field of the column header. Get it
-	const PrimeImplicantType resultingPrimeImplicant{ std::any_cast<PrimeImplicantType>(primeImplicantColumnHeader.userData) };
+	const PrimeImplicantType<TermType> resultingPrimeImplicant{ std::any_cast<PrimeImplicantType<TermType>>(primeImplicantColumnHeader.userData) };
 	// And, get the minterm
-	const MinTermType mtnMinTerm{ minTermRowHeader.index };
+	const TermType mtnMinTerm{ narrow_cast<TermType>(minTermRowHeader.index) };
 
 	// We want to know, if the minterm is covered by the prime implicant
 	bool result{ false };
 
 	// Check, if the prime implicant implies the minterm
-	const MinTermNumber mtnPrimeImplicant{ resultingPrimeImplicant.term };
-	const MinTermNumber primeImplicantMask{ resultingPrimeImplicant.mask };
-	const MinTermNumber primeImplicantMaskNegated{ ~resultingPrimeImplicant.mask };
-	const MinTermNumber mtnMinTermMasked{ mtnMinTerm & primeImplicantMaskNegated };
-	const MinTermNumber mtnPrimeImplicantMasked{ mtnPrimeImplicant & primeImplicantMaskNegated };
+	const TermType mtnPrimeImplicant{ resultingPrimeImplicant.term };
+	const TermType primeImplicantMaskNegated{ static_cast<TermType>(~resultingPrimeImplicant.mask) };
+	const TermType mtnMinTermMasked{ static_cast<TermType>(mtnMinTerm & primeImplicantMaskNegated) };
+	const TermType mtnPrimeImplicantMasked{ static_cast<TermType>(mtnPrimeImplicant & primeImplicantMaskNegated) };
 
 	if (mtnMinTermMasked == mtnPrimeImplicantMasked)
 	{
@@ -159,17 +161,28 @@ bool checkCoverForCell(const CellVectorHeader& minTermRowHeader, CellVectorHeade
 // Get a minimum possible disjunctive normal form DNF
 // Please not, the source parameter is for output purposes
 // The main input data is the minterm table
-std::string QuineMcluskey::getMinimumDisjunctiveNormalForm(MintermVector& mv, const SymbolTable& symbolTable, const std::string& source)
+template <typename TermType>
+std::string QuineMcluskeyForTermWidth<TermType>::getMinimumDisjunctiveNormalForm(const TruthTable& truthTable, const SymbolTable& symbolTable, const std::string& source)
 {
-	// Initialize the first level Quine and McCluskey table.
-	// Will contain all minterms sorted by number of bits set in the minterm
-	initiate(mv);
+	{
+		// Showing tables for more than 6 variables is too much data for the console
+		OutStreamSelection outStreamSelection(ProgramOption::pqmtc, (symbolTable.numberOfSymbols() > 6));
+		// All reduction stages are only needed for the printout. Otherwise a stage is released, when the next one is done
+		retainReductionTables = !outStreamSelection.isNull();
+
+		// Initialize the first level Quine and McCluskey table.
+		// Will contain all minterms sorted by number of bits set in the minterm
+		initiate(truthTable);
 
-	// Apply Quine and McCluskey Method
-	reduce();
+		// Apply Quine and McCluskey Method
+		reduce();
 
-	// Print all resulting reduction tables
-	printReductionTable(symbolTable, source);
+		// Print all resulting reduction tables
+		if (retainReductionTables)
+		{
+			printReductionTable(outStreamSelection(), symbolTable, source);
+		}
+	}
 
 	// The result of the operation
 	std::string minimumDisjunctiveNormalForm;
@@ -184,11 +197,13 @@ std::string QuineMcluskey::getMinimumDisjunctiveNormalForm(MintermVector& mv, co
 	// Set up the prime implicant table
 	Coverage coverageForPrimeImplicants;
 	// Fill in row and column headers for prime implicant table
-	initializeCoverageForPrimeImplicants(coverageForPrimeImplicants, mv, symbolTable);
+	initializeCoverageForPrimeImplicants(coverageForPrimeImplicants, truthTable, symbolTable);
 	// Set the callback function that will be called to set the initial coverage
-	coverageForPrimeImplicants.setCheckForCoverFunction(checkCoverForCell);
+	coverageForPrimeImplicants.setCheckForCoverFunction(checkCoverForCell<TermType>);
 	// And now find the initial coverage (Call the callback function)
 	coverageForPrimeImplicants.checkAllCellsForCover();
+	// Prime implicants with fewer literals are cheaper. The column text is the prime implicant as string
+	coverageForPrimeImplicants.setColumnCostFunction([](const CellVectorHeader& cvh) { return narrow_cast<uint>(cvh.textInfo.size()); });
 
 
 	// Reduce the primeimplicant table. May have several resulting vectors
@@ -294,27 +309,81 @@ QuineMcluskey::QuineMcluskey()
 		// But it will be more understandable for the user in the printout
 		processLowerAndUpperMintermOnly = false;
 	}
+	// Use the heuristic method instead of the exact method
+	useHeuristicMinimization = programOption.option[ProgramOption::espresso].optionSelected;
+}
+
+
+// Select the narrowest term width for the number of variables and run the Quine&  McCluskey method with it
+// Most boolean expressions have not more than 16 variables and will use the fast 16 bit version
+// Big boolean expressions cannot be minimized with the exact method in a reasonable time. For them the heuristic method is used
+std::string QuineMcluskey::getMinimumDisjunctiveNormalForm(const TruthTable& truthTable, const SymbolTable& symbolTable, const std::string& source)
+{
+	const uint numberOfVariables{ symbolTable.numberOfSymbols() };
+
+	std::string minimumDisjunctiveNormalForm;
+	const bool useEspresso{ useHeuristicMinimization || Espresso::isSelectedFor(truthTable) };
+	nameOfMinimizer = useEspresso ? "Espresso heuristic minimizing algorithm" : "Quine and McCluskey minimizing algorithm";
+	if (useEspresso)
+	{
+		Espresso espresso;
+		minimumDisjunctiveNormalForm = espresso.getMinimumDisjunctiveNormalForm(truthTable, symbolTable, source);
+		primeImplicants = espresso.getPrimeImplicants(symbolTable);
+	}
+	else if (numberOfVariables <= QuineMcluskeyForTermWidth<uint16_t>::MaxNumberOfBooleanVariables)
+	{
+		QuineMcluskeyForTermWidth<uint16_t> quineMcluskey(processLowerAndUpperMintermOnly);
+		minimumDisjunctiveNormalForm = quineMcluskey.getMinimumDisjunctiveNormalForm(truthTable, symbolTable, source);
+		primeImplicants = quineMcluskey.getPrimeImplicants(symbolTable);
+	}
+	else if (numberOfVariables <= QuineMcluskeyForTermWidth<uint32_t>::MaxNumberOfBooleanVariables)
+	{
+		QuineMcluskeyForTermWidth<uint32_t> quineMcluskey(processLowerAndUpperMintermOnly);
+		minimumDisjunctiveNormalForm = quineMcluskey.getMinimumDisjunctiveNormalForm(truthTable, symbolTable, source);
+		primeImplicants = quineMcluskey.getPrimeImplicants(symbolTable);
+	}
+	else
+	{
+		QuineMcluskeyForTermWidth<uint64_t> quineMcluskey(processLowerAndUpperMintermOnly);
+		minimumDisjunctiveNormalForm = quineMcluskey.getMinimumDisjunctiveNormalForm(truthTable, symbolTable, source);
+		primeImplicants = quineMcluskey.getPrimeImplicants(symbolTable);
+	}
+	return minimumDisjunctiveNormalForm;
+}
+
+
+// All prime implicants as strings. In the order of the prime implicant set
+template <typename TermType>
+std::vector<std::string> QuineMcluskeyForTermWidth<TermType>::getPrimeImplicants(const SymbolTable& symbolTable) const
+{
+	std::vector<std::string> result;
+	for (const PrimeImplicantType<TermType>& primeImplicant : primeImplicantSetResult)
+	{
+		result.push_back(primeImplicant.toString(symbolTable));
+	}
+	return result;
 }
 
 
 // Fill the first initial Quine&  McCluskey Reduction table
 // Fill it with minterm grouped by number of bits in minterm
-void QuineMcluskey::initiate(MintermVector& mv)
+template <typename TermType>
+void QuineMcluskeyForTermWidth<TermType>::initiate(const TruthTable& truthTable)
 {
 	// We will use a fxed sized vector to store the goups of minterms
 	// Depending on the number of max variables
-	BitsAndMinTerms bitsAndMinTerms(MAX_NUMBER_OF_BOOLEAN_VARIABLES+1);
+	BitsAndMinTerms bitsAndMinTerms(NumberOfTablesForBitCount);
 
 	// This is one row of a reduction table
 	TableEntry tableEntry;
 
-	// Iterate over all input minterms
-	for (const MinTermNumber& mtn : mv)
+	// Iterate over all input minterms. These are the set bits in the truth table
+	for (const MinTermNumber mtn : truthTable)
 	{
 		// For the selected algorithm, we will use only the lower and upper
 		// source minterm number, out of which a new row will be generated
 		// For the first initial table, upper and lower are the same 
-		tableEntry.mintermLower = tableEntry.mintermUpper = mtn;
+		tableEntry.mintermLower = tableEntry.mintermUpper = narrow_cast<TermType>(mtn);
 
 		// If the user wants to see every originator minterm
 		// then we additionally store it an a dedicated container
@@ -322,14 +391,19 @@ void QuineMcluskey::initiate(MintermVector& mv)
 		if (!processLowerAndUpperMintermOnly)
 		{
 			tableEntry.matchedMinterm.clear();
-			tableEntry.matchedMinterm.insert(mtn);
+			tableEntry.matchedMinterm.insert(narrow_cast<TermType>(mtn));
 		}
 
 		// Get the number of bits for this minterm
 		const NumberOfBitsCountType nb{ numberOfSetBits(mtn) };
 		
 		// And add this table row to the grouped-by-number-of-bits-table
-		bitsAndMinTerms[nb].push_back(tableEntry);
+		bitsAndMinTerms[nb].row.push_back(tableEntry);
+	}
+	// All minterms have the mask 0. So there is one bucket per sub table
+	for (TableForBitCount& tfbc : bitsAndMinTerms)
+	{
+		tfbc.sortAndBuildBuckets();
 	}
 
 	// After that, add it to the vector conatining all reduction tables that will be filled in several loops
@@ -342,98 +416,108 @@ void QuineMcluskey::initiate(MintermVector& mv)
 // Rows with terms containing all the same number of set bits will be compared
 // with other rows conatining one set bit more.
 // The goups of tables with a different numer of set bits are given as parameter
-// This, becuase we want to use multithreading and let different threads do comparisons
-// for different tables with different number of set bits
-// This function compares 2 subtables and produces one resulting table
-void QuineMcluskey::compareTwoEntries(TableForBitCount& upper, TableForBitCount& lower, TableForBitCount& output)
+// This, becuase we want to use the thread pool and let different tasks do comparisons
+// for different tables with different number of set bits. Big tables are additionally split
+// into blocks of rows. This function compares a block of rows of the upper table with the complete lower table
+//
+// Comparing every row of the upper table with every row of the lower table is O(|upper|*|lower|)
+// But a partner for a row in the upper table must have the same mask and a term with exactly one of
+// the set bits cleared. So there are at most n candidates (n = number of variables)
+// Rows with the same mask are in one bucket and the bucket is sorted by term. So we can find
+// a candidate with a binary search in the one bucket of the lower table with the same mask.
+// This makes a reduction round nearly linear in the table size
+// The tables are not modified. Found matches are marked in the bitmaps of the task
+template <typename TermType>
+void QuineMcluskeyForTermWidth<TermType>::compareTwoEntries(const TableForBitCount& upper, const TableForBitCount& lower, ComparisonTask& comparisonTask)
 {
-	
-	// Compare alle table entries, all rows with a number of bits, with the other table entries, rows with number of bits+1
-	// Compare all rows of table with bit count + 1
-	for (const TableEntry& teUpper : upper)
+	// Functor for the binary search in the sorted lower table
+	TableEntryCompare tableEntryCompare;
+
+	// All rows of the block have the same mask. Only the bucket with the same mask in the lower table can contain partners
+	const typename std::vector<TableEntry>::const_iterator bucketBegin{ lower.row.begin() + comparisonTask.firstRowLower };
+	const typename std::vector<TableEntry>::const_iterator bucketEnd{ lower.row.begin() + comparisonTask.lastRowLower };
+	std::vector<TableEntry>& output{ comparisonTask.output };
+	comparisonTask.matchFoundUpper.assign(comparisonTask.lastRowUpper - comparisonTask.firstRowUpper, false);
+	comparisonTask.matchFoundLower.assign(comparisonTask.lastRowLower - comparisonTask.firstRowLower, false);
+	comparisonTask.numberOfComparisons = 0ULL;
+
+	// Look for partners of all rows (of the given block) of table with bit count + 1
+	for (uint rowUpper = comparisonTask.firstRowUpper; rowUpper < comparisonTask.lastRowUpper; ++rowUpper)
 	{
-		// To all other rows bit bit count
-		for (const TableEntry& telower : lower)
+		const TableEntry& teUpper{ upper.row[rowUpper] };
+
+		// The next lines are implement the algorithm 
+		// abc+aBc == ac(b+B) == ac(true) == ac
+		// So, 2 terms, with the same variables and a difference in just one bit (b--B), can be reduced
+		// to one term, with the different bit eliminated.
+		// Eliminated bits are always 0 in mintermLower. So we try all set bits of the term
+		TermType remainingBits{ teUpper.mintermLower };
+		while (remainingBits)
 		{
-			// The next 4 lines are implement the algorithm 
-			// abc+aBc == ac(b+B) == ac(true) == ac
-			// So, 2 terms, with the same variables and a difference in just one bit (b--B), can be reduced
-			// to one term, with the different bit eliminated.
-
-			// The mask (The so far eliminated Bit Positions) must be equal
-			if (teUpper.maskForEliminatedBit == telower.maskForEliminatedBit)
+			// The lowest set bit is the difference between the 2 terms. Taken from "Hackers Delight"
+			const TermType termDifference{ static_cast<TermType>(remainingBits & (~remainingBits + 1U)) };
+			remainingBits = static_cast<TermType>(remainingBits ^ termDifference);
+
+			// This would be the partner in the lower table. The mask (The so far eliminated Bit Positions) must be equal
+			const TermType termLower{ static_cast<TermType>(teUpper.mintermLower ^ termDifference) };
+			const TableEntry candidate(termLower, static_cast<TermType>(termLower | teUpper.maskForEliminatedBit), teUpper.maskForEliminatedBit);
+
+			// Search for it
+			++comparisonTask.numberOfComparisons;
+			const typename std::vector<TableEntry>::const_iterator partner{ std::lower_bound(bucketBegin, bucketEnd, candidate, tableEntryCompare) };
+			// So, we found 2 terms, where one variable can be eliminated
+			if ((bucketEnd != partner) && (*partner == candidate))
 			{
-				// XOR for the 2 terms, will find the different set bits between 2 terms
-				const MinTermType termDifference{ (teUpper.mintermLower ^ telower.mintermLower) };
-				// If there is only a difference in one bit. So is there only one bit set in the difference we just calculated
-				const bool differenceInOnlyOneBit{ (!(termDifference & (termDifference - 1))) };  // Taken from "Hackers Delight"
-				// So, we found 2 terms, where one variable can be eliminated
-				if (differenceInOnlyOneBit)
+				const TableEntry& telower{ *partner };
+
+				// According to the algorithm, we will mark the 2 terms as "done"
+				// We found a difference in exactly one bit. Mark both terms
+				comparisonTask.matchFoundUpper[rowUpper - comparisonTask.firstRowUpper] = true;
+				comparisonTask.matchFoundLower[static_cast<std::size_t>(partner - bucketBegin)] = true;
+
+				// The combined term with the new mask can be built from pairs for every bit in the new mask
+				// All these pairs are in this table. The result is only stored for the pair, where the eliminated bit
+				// is the highest bit of the new mask. So every combined term is created exactly once and there are no duplicates
+				if (termDifference < teUpper.maskForEliminatedBit)
 				{
-					// According to the algorithm, we will mark the 2 terms as "done"
-					// We found a difference in exactly one bit. Mark both terms
-					teUpper.matchFound = true;
-					telower.matchFound = true;
-
-					// Depending on the comand line selection . . .
-					// Functionality wise, only the upper and the lower term from the source terms are important
-					// Standard QWuine and McCluskey copy all source terms to the next table.
-					// This is not necessary
-					// Anyway, for the user it may be simpler to see everything. We give the possibility
-					// And implement the algorithm here accordingly
-					if (processLowerAndUpperMintermOnly)
-					{
-						// Create a new tableEntry for the next reduction Table column
-						output.push_back(TableEntry(telower.mintermLower, teUpper.mintermUpper, termDifference + telower.maskForEliminatedBit));
-					}
-					else
-					{
-						// Store all the source values, from which we combined the new one
-						MintermSet mintermSetForMatches;
-						mintermSetForMatches.insert(telower.matchedMinterm.begin(), telower.matchedMinterm.end());
-						mintermSetForMatches.insert(teUpper.matchedMinterm.begin(), teUpper.matchedMinterm.end());
-						
-						// Create a new tableEntry for the next Reduction Table column
-						output.push_back(TableEntry(telower.mintermLower, teUpper.mintermUpper, termDifference + telower.maskForEliminatedBit, std::move(mintermSetForMatches)));
-					}
+					continue;
+				}
+
+				// Depending on the comand line selection . . .
+				// Functionality wise, only the upper and the lower term from the source terms are important
+				// Standard QWuine and McCluskey copy all source terms to the next table.
+				// This is not necessary
+				// Anyway, for the user it may be simpler to see everything. We give the possibility
+				// And implement the algorithm here accordingly
+				if (processLowerAndUpperMintermOnly)
+				{
+					// Create a new tableEntry for the next reduction Table column
+					output.push_back(TableEntry(telower.mintermLower, teUpper.mintermUpper, static_cast<TermType>(termDifference + telower.maskForEliminatedBit)));
+				}
+				else
+				{
+					// Store all the source values, from which we combined the new one
+					MintermSetForTermWidth mintermSetForMatches;
+					mintermSetForMatches.insert(telower.matchedMinterm.begin(), telower.matchedMinterm.end());
+					mintermSetForMatches.insert(teUpper.matchedMinterm.begin(), teUpper.matchedMinterm.end());
+					
+					// Create a new tableEntry for the next Reduction Table column
+					output.push_back(TableEntry(telower.mintermLower, teUpper.mintermUpper, static_cast<TermType>(termDifference + telower.maskForEliminatedBit), std::move(mintermSetForMatches)));
 				}
 			}
 		}
 	}
-	// Definition of Functor. For comparing and finally sorting the rows in the resulting tables
-	TableEntryCompare tableEntryCompare;
-	// Sort the new resulting table
-	std::sort(output.begin(), output.end(), tableEntryCompare);
-	// And erase duplicates
-	output.erase(std::unique(output.begin(), output.end()), output.end());
 }
 
 
 
-// Compare a range of sub table (grouped by number of set bits) for a complete reduction table
-// Also here is the intention to enable mlti threading
-void QuineMcluskey::compareFromBitCountUpperToBitCountLower(uint indexReductionTableColumn, uint indexUpper, uint indexLower)
-{
-	// For the given main reduction table
-	// Do something with subtables with a number-of-set-bits-upper to number-of-set-bits-upper
-	// And store the result in a new reduction table for the next reduction round
-	// So, do for given range
-	for (uint ui = indexUpper; ui > indexLower; --ui)
-	{
-		compareTwoEntries(	reductionTable[indexReductionTableColumn][ui],								// Subtable with set bit count x
-							reductionTable[indexReductionTableColumn][static_cast<uint>(ui) - 1],		// Subtable with set bit count x-1
-
-							// Write to other (next) reduction table at the lower bit count index
-							// It is alwyas the lower bit cout index, because if you comapre something
-							// with 4 bits sets and with 3 bits set, then the result is of youres something with 3 bits set
-							reductionTable[static_cast<size_t>(indexReductionTableColumn) + 1U][static_cast<uint>(ui) - 1]);
-	}
-}
-
-
 // Overall reduction algorithm until prime implicants are found
-void QuineMcluskey::reduce()
+template <typename TermType>
+void QuineMcluskeyForTermWidth<TermType>::reduce()
 {
+	// Time and counters per reduction round for option -stats
+	StageTimer stageTimer("QuineMcluskey");
+
 	// We start with the main and initial reduction table 0
 	uint currentReductionTableColumn{ 0 };
 	// Iterate, until all prime implicants are found
@@ -441,42 +525,86 @@ void QuineMcluskey::reduce()
 	do
 	{
 		// Already now create a new, next stage, reduction table
-		reductionTable.emplace_back(BitsAndMinTerms(MAX_NUMBER_OF_BOOLEAN_VARIABLES + 1));
+		reductionTable.emplace_back(BitsAndMinTerms(NumberOfTablesForBitCount));
 
 		// We simple have defined the table with a fixed number. Without knowing 
 		// how many bist are set at all. We will now find out the table index, where a bit is set
 		// And here, the highest index and the lowest index
 		const uint upper{ getHighestIndexOfBitCountEntry(currentReductionTableColumn) };
 		const uint lower{ getLowestIndexOfBitCountEntry(currentReductionTableColumn) };
-		// We want to calculate ranges of "bit-set-numbers" that we can give to multiple threads
-		BitCountRangeVector bcrv{ calculateBoundsForMultiThreading(upper, lower) };
-		// If we will do multi threading
-		if (bcrv.size() > 0)
+
+		// Create the tasks for the thread pool. For all buckets in the sub tables with bit count u
+		// that have a bucket with the same mask in the sub table with bit count u-1
+		std::vector<ComparisonTask> comparisonTask;
+		for (uint ui = upper; ui > lower; --ui)
 		{
-			// Define futures for the threads. No return value necessary. We just wnt to wait until thread is finished
-			std::future<void> futures[numberOfThreads];
-			// Get the ranges
-			for (uint ui = 0; ui < bcrv.size(); ++ui)
-			{
-				uint u{ bcrv[ui].first };
-				uint l{ bcrv[ui].second };
-				// And call calculation function in a thread
-				futures[ui] = std::async(&QuineMcluskey::compareFromBitCountUpperToBitCountLower, this, currentReductionTableColumn, u, l);
-			}
-			// Wait until all threads are finished
-			for (uint ui = 0; ui < bcrv.size(); ++ui)
+			const TableForBitCount& tableUpper{ reductionTable[currentReductionTableColumn][ui] };
+			const TableForBitCount& tableLower{ reductionTable[currentReductionTableColumn][ui - 1U] };
+			for (uint bucket = 0U; bucket < tableUpper.numberOfBuckets(); ++bucket)
 			{
-				futures[ui].wait();
+				const uint bucketLower{ tableLower.findBucket(tableUpper.maskOfBucket(bucket)) };
+				if (bucketLower < tableLower.numberOfBuckets())
+				{
+					// Every row of the upper table needs up to n binary searches in the lower table
+					const uint bucketEnd{ tableUpper.bucketStart[bucket + 1U] };
+					for (uint firstRow = tableUpper.bucketStart[bucket]; firstRow < bucketEnd; firstRow += MinimumNumberOfRowsPerTask)
+					{
+						comparisonTask.push_back(ComparisonTask{ ui, firstRow, std::min(firstRow + MinimumNumberOfRowsPerTask, bucketEnd), 
+							tableLower.bucketStart[bucketLower], tableLower.bucketStart[bucketLower + 1U], std::vector<TableEntry>(), std::vector<bool>(), std::vector<bool>(), 0ULL });
+					}
+				}
 			}
 		}
-		else
+
+		// Let the thread pool do the comparisons
+		threadPool().parallelFor(0U, narrow_cast<uint>(comparisonTask.size()), 1U, [this, currentReductionTableColumn, &comparisonTask](uint taskIndex)
 		{
-			// No multi threading. Calculate result in one thread
-			compareFromBitCountUpperToBitCountLower(currentReductionTableColumn, upper, lower);
+			ComparisonTask& ct{ comparisonTask[taskIndex] };
+			compareTwoEntries(reductionTable[currentReductionTableColumn][ct.indexUpper], reductionTable[currentReductionTableColumn][ct.indexUpper - 1U], ct);
+		});
+
+		// All tasks are done. Now the marks can be written to the tables
+		ull numberOfComparisons{ 0ULL };
+		ull numberOfMerges{ 0ULL };
+		for (const ComparisonTask& ct : comparisonTask)
+		{
+			mergeMatchFound(currentReductionTableColumn, ct);
+			numberOfComparisons += ct.numberOfComparisons;
+			numberOfMerges += ct.output.size();
+		}
+		ull numberOfEntries{ 0ULL };
+		for (const TableForBitCount& tfbc : reductionTable[currentReductionTableColumn])
+		{
+			numberOfEntries += tfbc.size();
+		}
+		stageTimer().append("entries", numberOfEntries);
+		stageTimer().append("comparisons", numberOfComparisons);
+		stageTimer().append("merges", numberOfMerges);
+
+		// Write the results to the next reduction table at the lower bit count index
+		// It is alwyas the lower bit cout index, because if you comapre something
+		// with 4 bits sets and with 3 bits set, then the result is of youres something with 3 bits set
+		BitsAndMinTerms& nextBitsAndMinTerms{ reductionTable[static_cast<size_t>(currentReductionTableColumn) + 1U] };
+		for (ComparisonTask& ct : comparisonTask)
+		{
+			std::vector<TableEntry>& target{ nextBitsAndMinTerms[ct.indexUpper - 1U].row };
+			target.insert(target.end(), std::make_move_iterator(ct.output.begin()), std::make_move_iterator(ct.output.end()));
+			// Free the memory of the task result immediately
+			std::vector<TableEntry>().swap(ct.output);
+		}
+		// Sort the new resulting tables, erase duplicates and build the buckets
+		for (TableForBitCount& tfbc : nextBitsAndMinTerms)
+		{
+			tfbc.sortAndBuildBuckets();
 		}
 
 		// Collect prime implicants after this round. Prime implicants have not been marked (as used for combination)
 		collectPrimeImplicants(currentReductionTableColumn);
+		// This stage is no longer needed. Only the next stage will be compared. Free the memory, if there is no printout
+		if (!retainReductionTables)
+		{
+			releaseReductionTable(currentReductionTableColumn);
+		}
 
 		// Goto next reduction round
 		++currentReductionTableColumn;
@@ -484,6 +612,9 @@ void QuineMcluskey::reduce()
 		doIterateUntilAllPrimeImplcantsAreFound = checkIfFurtherEvaluationNecessary(currentReductionTableColumn);
 
 	} while (doIterateUntilAllPrimeImplcantsAreFound);
+
+	stageTimer().add("reductionRounds", currentReductionTableColumn);
+	stageTimer().add("primeImplicants", primeImplicantSetResult.size());
 }
 
 
@@ -492,30 +623,60 @@ void QuineMcluskey::reduce()
 
 
 
+// Mark all rows of the tables with bit count u and u-1, for which the task found a match
+template <typename TermType>
+void QuineMcluskeyForTermWidth<TermType>::mergeMatchFound(uint indexReductionTableColumn, const ComparisonTask& comparisonTask)
+{
+	std::vector<TableEntry>& rowUpper{ reductionTable[indexReductionTableColumn][comparisonTask.indexUpper].row };
+	for (uint row = comparisonTask.firstRowUpper; row < comparisonTask.lastRowUpper; ++row)
+	{
+		if (comparisonTask.matchFoundUpper[row - comparisonTask.firstRowUpper]) rowUpper[row].matchFound = true;
+	}
+	std::vector<TableEntry>& rowLower{ reductionTable[indexReductionTableColumn][comparisonTask.indexUpper - 1U].row };
+	for (uint row = comparisonTask.firstRowLower; row < comparisonTask.lastRowLower; ++row)
+	{
+		if (comparisonTask.matchFoundLower[row - comparisonTask.firstRowLower]) rowLower[row].matchFound = true;
+	}
+}
+
+
 // Collect the prime implicnats
 // Afte a reduction round has been made, and we tried to combine rows withd different number of bits set
 // Some rows my not have been combine and ar hance not marked as such
 // Then, it is a prime implicant
-void QuineMcluskey::collectPrimeImplicants(uint indexReductionTableColumn)
+template <typename TermType>
+void QuineMcluskeyForTermWidth<TermType>::collectPrimeImplicants(uint indexReductionTableColumn)
 {
 	// Iterate over the a reduction table for this stage
 	for (const TableForBitCount& tfbc : reductionTable[indexReductionTableColumn])
 	{
 		// If there are elements then iterate over rows in the subtables (gouped by bit numbers)
-		if (tfbc.size()) for (TableEntry te : tfbc)
+		if (tfbc.size()) for (const TableEntry& te : tfbc.row)
 		{
 			// And if the row is not marked as combined with a other row
 			if (!te.matchFound)
 			{
 				// The it is a prime implicnat and we save it in the set of prime implicants
-				primeImplicantSetResult.insert(std::move(PrimeImplicantType(te.mintermLower, te.maskForEliminatedBit)));
+				primeImplicantSetResult.insert(std::move(PrimeImplicantType<TermType>(te.mintermLower, te.maskForEliminatedBit)));
 			}
 		}
 	}
 }
 
+// Free the memory of all rows of a reduction stage. The (empty) tables for the bit counts remain
+template <typename TermType>
+void QuineMcluskeyForTermWidth<TermType>::releaseReductionTable(uint indexReductionTableColumn)
+{
+	for (TableForBitCount& tfbc : reductionTable[indexReductionTableColumn])
+	{
+		std::vector<TableEntry>().swap(tfbc.row);
+		std::vector<uint>().swap(tfbc.bucketStart);
+	}
+}
+
 // Check, if we found all prime implicants or if we need to continue searching
-bool QuineMcluskey::checkIfFurtherEvaluationNecessary(uint indexReductionTableColumn)
+template <typename TermType>
+bool QuineMcluskeyForTermWidth<TermType>::checkIfFurtherEvaluationNecessary(uint indexReductionTableColumn)
 {
 	bool result{ false };	// We initially assume that no further evealuation is necessary
 	// Go through all sub table (gouped by number of bits) for this reduction table
@@ -537,7 +698,8 @@ bool QuineMcluskey::checkIfFurtherEvaluationNecessary(uint indexReductionTableCo
 // To save time and memeory, we will not evaluate empty tables
 
 // This function returns the highest index of the subtable that contains elements
-uint QuineMcluskey::getHighestIndexOfBitCountEntry(uint indexReductionTableColumn)
+template <typename TermType>
+uint QuineMcluskeyForTermWidth<TermType>::getHighestIndexOfBitCountEntry(uint indexReductionTableColumn)
 {
 	uint result{ 0 };
 	// Iterate over all sub tables
@@ -556,7 +718,8 @@ uint QuineMcluskey::getHighestIndexOfBitCountEntry(uint indexReductionTableColum
 }
 
 // This function returns the lowest index of the subtable that contains elements
-uint QuineMcluskey::getLowestIndexOfBitCountEntry(uint indexReductionTableColumn)
+template <typename TermType>
+uint QuineMcluskeyForTermWidth<TermType>::getLowestIndexOfBitCountEntry(uint indexReductionTableColumn)
 {
 	uint result{ 0 };
 	// Iterate over sub tables, starting with 0, until we find a sub table that has elements
@@ -574,117 +737,20 @@ uint QuineMcluskey::getLowestIndexOfBitCountEntry(uint indexReductionTableColumn
 }
 
 
-// This is a little bit hard to understand. Lets give it a try
-// Snce comparing rows bit certain number of set bits is a very time and memory consuming
-// operation, we will uses multithrading to reduce calculation time
-// We need to compare ranges with number of set bits. For example we need to
-// compare a subtable that has 4 bits with a subtable that has 3 bits. And so one
-// Mathimatically it is the case, that for a certain number of bits there
-// are more possible minterms (rows) then for the other. We want to
-// distribute the work to the threads in a somehow balanced way.
-// Looking at the mathematics, we see the the binimial distrbution applies
-// Number of possible minterms with a given number of set bits is (n over k)
-// This function simulates that distribution and generates ranges for set
-// bits that can then be worked on by separate threads
-
-// Upper and lower ar max and min indices for sub tables
-// The result is a vector of pairs with upper/lower values
-QuineMcluskey::BitCountRangeVector QuineMcluskey::calculateBoundsForMultiThreading(uint upper, uint lower)
-{
-	BitCountRangeVector result;		// Here will store the resulting ranges
-
-	// For the claculation we atrt in the middle of the given overall range
-	const uint middle{ static_cast<uint>(std::ceil((upper - lower) / 2 + 1)) };
-
-	// We start with a delta of one, so the next range will be only on more or less than the current value
-	sint delta{ 1 };
-	// We will start with the middle and then go up and down
-	sint currentForDirectionLower{ static_cast<sint>(middle) };
-	sint nextForDirectionLower{ static_cast<sint>(middle) - delta };
-
-	sint currentForDirectionUpper{ static_cast<sint>(middle) + delta };
-	sint nextForDirectionUpper{ static_cast<sint>(middle) };
-
-	//Depending on the number of available threads we will define ranges for up and for down
-	const uint maxLoopCount{ (numberOfThreads >> 1) };
-	const uint lastLoopCount{ maxLoopCount - 1 };
-
-
-	for (uint i = 0; i < maxLoopCount; ++i)
-	{
-		// Direction for lower indices
-		// If we did not hit the lower boundary
-		if (currentForDirectionLower > narrow_cast<sint>(lower))
-		{
-			// Limit to the lower boundary. Ther must be nothing smaller than "lower"
-			if (nextForDirectionLower < narrow_cast<sint>(lower))
-			{
-				nextForDirectionLower = narrow_cast<sint>(lower);
-			}
-			// If this is the last possibility to set the range
-			if (i == lastLoopCount)
-			{
-				// Then the range is from the crrent value to the lower boundary
-				result.push_back(BitCountRange(currentForDirectionLower, lower));
-			}
-			else
-			{
-				// ELse the range is from the current value to the next calculated value
-				result.push_back(BitCountRange(currentForDirectionLower, nextForDirectionLower));
-			}
-		}
-
-		// Direction for higher indices
-		// If we did not hit the upper boundary
-		if (nextForDirectionUpper < narrow_cast<sint>(upper))
-		{
-			// Limit claculated value to upper boundary
-			if (currentForDirectionUpper > narrow_cast<sint>(upper))
-			{
-				currentForDirectionUpper = narrow_cast<sint>(upper);
-			}
-			// If this is the last loop run,
-			if (i == lastLoopCount)
-			{
-				// Then the range is from the current element to the upper boundary
-				result.push_back(BitCountRange(upper, nextForDirectionUpper));
-			}
-			else
-			{
-				// ELse the range is from the current value to the next calculated value
-				result.push_back(BitCountRange(currentForDirectionUpper, nextForDirectionUpper));
-			}
-		}
-
-		// Clculate the next values
-		currentForDirectionLower = nextForDirectionLower;
-		nextForDirectionLower -= delta;
-
-		nextForDirectionUpper = currentForDirectionUpper;
-		currentForDirectionUpper += delta;
-		// And in the next round the delta will be bigger.
-		// Times 2
-		// This reproduces the effect of the binmial distribution
-		delta = delta << 1;
-	}
-	return result;
-}
-
-
-
 // -----------------------------------------
 // print data
 
 
 // Convert a prime implicant to a string
 //The symbol table is needed to do the translation
-std::string PrimeImplicantType::toString(const SymbolTable& symbolTable) const
+template <typename TermType>
+std::string PrimeImplicantType<TermType>::toString(const SymbolTable& symbolTable) const
 {
 	std::ostringstream result;
 	// Maximum number of symbols in the symbol table
 	const uint symbolCount{ symbolTable.numberOfSymbols() };
 	// We will check, which bit is set or not. For the set bits we will print a symbol
-	MinTermNumber maskSelector{ bitMask[symbolCount - 1] };
+	TermType maskSelector{ narrow_cast<TermType>(bitMask[symbolCount - 1]) };
 
 	// We will iterate over all symbols
 	std::set<cchar>::iterator symbolIterator{ symbolTable.symbol.begin() };
@@ -696,13 +762,13 @@ std::string PrimeImplicantType::toString(const SymbolTable& symbolTable) const
 		// Is there a symbol at this position?
 		if (!(maskSelector&  mask))
 		{
-			const MinTermNumber mt{ term };
-			const MinTermNumber mtMasked{ mt & maskSelector }; // This will result in true, if there is a positive variable at this position 
+			const TermType mt{ term };
+			const TermType mtMasked{ static_cast<TermType>(mt & maskSelector) }; // This will result in true, if there is a positive variable at this position 
 			// Distihuish between lower case and upper case.
 			result << (mtMasked ? *symbolIterator : static_cast<cchar>((*symbolIterator) - ('a' - 'A')));
 		}
 		// Check next bit position
-		maskSelector = maskSelector >> 1;
+		maskSelector = static_cast<TermType>(maskSelector >> 1);
 		// And evaluate next symbol
 		++symbolIterator;
 	}
@@ -711,15 +777,11 @@ std::string PrimeImplicantType::toString(const SymbolTable& symbolTable) const
 
 
 // Print all Reduction tables, so show the complete history of the Q&M reduction process
-void QuineMcluskey::printReductionTable(const SymbolTable& symbolTable, const std::string& source)
+template <typename TermType>
+void QuineMcluskeyForTermWidth<TermType>::printReductionTable(std::ostream& os, const SymbolTable& symbolTable, const std::string& source)
 {
-	// Tetermin, to which stream the output should go
-	// Showing tables for more than 6 variables is too much data
 	const uint maxNumberOfBits{ narrow_cast<uint>(symbolTable.symbol.size()) };
 	const uint maxNumberOfBitsMinusOne{ maxNumberOfBits - 1 };
-	const bool predicateForOutputToFile{ (maxNumberOfBits > 6) };
-	OutStreamSelection outStreamSelection(ProgramOption::pqmtc, predicateForOutputToFile);
-	std::ostream& os{ outStreamSelection() };
 
 	// Header
 	os << "------------------ Print Quine McCluskey Reduction tables for boolean expression\n\n'" << source << "'\n\n";
@@ -749,19 +811,29 @@ void QuineMcluskey::printReductionTable(const SymbolTable& symbolTable, const st
 		// So, for all the sub tables grouped by the number of set bits
 		for (uint bitCount = lower; bitCount <= upper; ++bitCount)
 		{
+			// The rows are stored in buckets by mask. For the printout we show them in the classical order, sorted by minterm
+			std::vector<const TableEntry*> rowForPrint;
+			for (const TableEntry& te : reductionTable[currentTableIndex][bitCount].row)
+			{
+				rowForPrint.push_back(&te);
+			}
+			std::sort(rowForPrint.begin(), rowForPrint.end(), [](const TableEntry* lhs, const TableEntry* rhs) noexcept
+				{ return (lhs->mintermLower < rhs->mintermLower) || ((lhs->mintermLower == rhs->mintermLower) && (lhs->mintermUpper < rhs->mintermUpper)); });
+
 			// For each row in this sub table
-			for (TableEntry& te : reductionTable[currentTableIndex][bitCount])
+			for (const TableEntry* rowPointer : rowForPrint)
 			{
+				const TableEntry& te{ *rowPointer };
 				// Print running number and bit count
 				os << std::left << std::setw(6)<< counter++<< std::setw(4) << narrow_cast<uint>(bitCount) << "  ";
 
 				// Get the minterm and the mask. So, see, what avriables are in there
-				const MinTermNumber mtn{ te.mintermLower };
-				const MinTermNumber deletedPos{ te.maskForEliminatedBit };
+				const TermType mtn{ te.mintermLower };
+				const TermType deletedPos{ te.maskForEliminatedBit };
 
 				// This will be used to iterate over the single literals in the minterms
 				// Start with this vale und will be shifted right
-				MinTermNumber bitMaskLocal{ bitMask[maxNumberOfBitsMinusOne] };
+				TermType bitMaskLocal{ narrow_cast<TermType>(bitMask[maxNumberOfBitsMinusOne]) };
 				
 				// Now check all bits in the term
 				for (uint bitIndex = 0; bitIndex < maxNumberOfBits; ++bitIndex)
@@ -782,7 +854,7 @@ void QuineMcluskey::printReductionTable(const SymbolTable& symbolTable, const st
 						}
 						// else, use 0 from the varaibale initiaization
 					}
-					bitMaskLocal = bitMaskLocal >> 1; // Next bitmask
+					bitMaskLocal = static_cast<TermType>(bitMaskLocal >> 1); // Next bitmask
 					os << output << ' ';	// print separator
 				}
 
@@ -814,7 +886,7 @@ void QuineMcluskey::printReductionTable(const SymbolTable& symbolTable, const st
 				else
 				{
 					// Show all minterms, from whicht his row has been created
-					for (const MinTermType m : te.matchedMinterm)
+					for (const TermType m : te.matchedMinterm)
 					{
 						os << m << ' ';
 					}
@@ -828,7 +900,7 @@ void QuineMcluskey::printReductionTable(const SymbolTable& symbolTable, const st
 	// Then show all prime implicants
 	os << "------------------ Prime Implicants  after Quine McCluskey Minimization for boolean expression\n'" << source << "'\n\n";
 
-	for (const PrimeImplicantType& resultingPrimeImplicant : primeImplicantSetResult)
+	for (const PrimeImplicantType<TermType>& resultingPrimeImplicant : primeImplicantSetResult)
 	{
 		os << resultingPrimeImplicant.toString(symbolTable) << "  ";
 	}
@@ -837,6 +909,12 @@ void QuineMcluskey::printReductionTable(const SymbolTable& symbolTable, const st
 
 
 
-
-
-
+// -----------------------------------------
+// The term widths, that can be selected by QuineMcluskey
+
+template struct PrimeImplicantType<uint16_t>;
+template struct PrimeImplicantType<uint32_t>;
+template struct PrimeImplicantType<uint64_t>;
+template class QuineMcluskeyForTermWidth<uint16_t>;
+template class QuineMcluskeyForTermWidth<uint32_t>;
+template class QuineMcluskeyForTermWidth<uint64_t>;
@@ -0,0 +1,374 @@
+// --------------------------------------------------------------------------------------------------------------------------------
+// License:	BSD-3-Clause
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Copyright 2019      Armin Montigny
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+// following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the 
+//    following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the 
+//    following disclaimer in the documentation and /or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or 
+//    promote products derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+
+
+// Persistent result cache. Memory mapped for reading, append only for writing. See resultcache.hpp
+
+#include "resultcache.hpp"
+#include "cloption.hpp"
+
+#include <cstring>
+#include <cctype>
+#include <fstream>
+#include <iostream>
+#include <filesystem>
+#include <initializer_list>
+#include <algorithm>
+
+#if defined(_WIN32)
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <windows.h>
+#else
+	#include <sys/mman.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+
+namespace
+{
+	// Serialization of numbers and strings into a record
+	void appendUint32(std::string& record, uint32_t value)
+	{
+		record.append(reinterpret_cast<const char*>(&value), sizeof(value));
+	}
+	void appendUint64(std::string& record, uint64_t value)
+	{
+		record.append(reinterpret_cast<const char*>(&value), sizeof(value));
+	}
+	void appendString(std::string& record, const std::string& value)
+	{
+		appendUint32(record, narrow_cast<uint32_t>(value.size()));
+		record.append(value);
+	}
+
+	// Read from the memory mapped file. All reads are checked against the end of the record
+	class RecordReader
+	{
+	public:
+		RecordReader(const uint8_t* begin, const uint8_t* end) noexcept : position(begin), last(end) {}
+
+		bool read(uint32_t& value) noexcept { return readRaw(&value, sizeof(value)); }
+		bool read(uint64_t& value) noexcept { return readRaw(&value, sizeof(value)); }
+		bool read(std::string& value)
+		{
+			uint32_t length{ 0U };
+			if (!read(length) || (static_cast<std::size_t>(last - position) < length)) return false;
+			value.assign(reinterpret_cast<const char*>(position), length);
+			position += length;
+			return true;
+		}
+
+	protected:
+		bool readRaw(void* destination, std::size_t size) noexcept
+		{
+			if (static_cast<std::size_t>(last - position) < size) return false;
+			std::memcpy(destination, position, size);
+			position += size;
+			return true;
+		}
+		const uint8_t* position;
+		const uint8_t* last;
+	};
+}
+
+
+ResultCache::ResultCache(const std::string& cacheFileName) : fileName(cacheFileName)
+{
+	mapFile();
+	if (foreignFile)
+	{
+		std::cerr << "\n*** Error: '" << fileName << "' is not a result cache file. Results will not be cached\n\n";
+	}
+}
+
+
+// The key consists of all options, that influence the result, and the boolean expression
+std::string ResultCache::createKey(const std::string& source)
+{
+	std::string key;
+	for (const ProgramOption::OptionID optionID : { ProgramOption::bse, ProgramOption::umdnf, ProgramOption::nomcdc, ProgramOption::espresso, ProgramOption::ipi, ProgramOption::onecover, ProgramOption::forcemcdc })
+	{
+		key += programOption.option[optionID].optionIdentificationString;
+		key += programOption.option[optionID].optionSelected ? "=1 " : "=0 ";
+	}
+	// White space has no meaning in a boolean expression
+	for (const cchar c : source)
+	{
+		if (!std::isspace(static_cast<uchar>(c)))
+		{
+			key.push_back(c);
+		}
+	}
+	return key;
+}
+
+
+uint64_t ResultCache::hashOf(const std::string& key) noexcept
+{
+	uint64_t hash{ 0xCBF29CE484222325ULL };
+	for (const cchar c : key)
+	{
+		hash ^= static_cast<uchar>(c);
+		hash *= 0x100000001B3ULL;
+	}
+	return hash;
+}
+
+
+void ResultCache::mapFile()
+{
+	unmapFile();
+
+	std::error_code errorCode;
+	const std::uintmax_t fileSize{ std::filesystem::file_size(fileName, errorCode) };
+	// No file or empty file. Will be created with the first new record
+	if (errorCode || (0U == fileSize))
+	{
+		return;
+	}
+
+#if defined(_WIN32)
+	const HANDLE file{ CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr) };
+	if (INVALID_HANDLE_VALUE != file)
+	{
+		const HANDLE mapping{ CreateFileMappingA(file, nullptr, PAGE_READONLY, 0U, 0U, nullptr) };
+		if (nullptr != mapping)
+		{
+			mappedData = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0U, 0U, 0U));
+			// The view keeps the mapping alive
+			CloseHandle(mapping);
+		}
+		CloseHandle(file);
+	}
+#else
+	const int file{ open(fileName.c_str(), O_RDONLY) };
+	if (file >= 0)
+	{
+		void* const data{ mmap(nullptr, static_cast<std::size_t>(fileSize), PROT_READ, MAP_SHARED, file, 0) };
+		if (MAP_FAILED != data)
+		{
+			mappedData = static_cast<const uint8_t*>(data);
+		}
+		close(file);
+	}
+#endif
+	if (nullptr == mappedData)
+	{
+		return;
+	}
+	mappedSize = static_cast<std::size_t>(fileSize);
+
+	// Check the file identification
+	if (0 != std::memcmp(mappedData, FileIdentification, std::min(mappedSize, FileIdentificationSize)))
+	{
+		foreignFile = true;
+		unmapFile();
+		return;
+	}
+	// Not even the file identification has been written completely. Will be overwritten with the first new record
+	if (mappedSize < FileIdentificationSize)
+	{
+		unmapFile();
+		return;
+	}
+
+	// Build the index. Stop at the first incomplete or corrupt record
+	std::size_t offset{ FileIdentificationSize };
+	while (offset + RecordHeaderSize <= mappedSize)
+	{
+		RecordReader recordReader(mappedData + offset, mappedData + mappedSize);
+		uint32_t magicNumber{ 0U };
+		uint32_t dataSize{ 0U };
+		uint64_t hash{ 0U };
+		static_cast<void>(recordReader.read(magicNumber));
+		static_cast<void>(recordReader.read(dataSize));
+		static_cast<void>(recordReader.read(hash));
+		if ((RecordMagicNumber != magicNumber) || (mappedSize - offset - RecordHeaderSize < dataSize))
+		{
+			break;
+		}
+		recordIndex.emplace(hash, offset);
+		offset += RecordHeaderSize + dataSize;
+	}
+	validSize = offset;
+}
+
+
+void ResultCache::unmapFile() noexcept
+{
+	if (nullptr != mappedData)
+	{
+#if defined(_WIN32)
+		UnmapViewOfFile(mappedData);
+#else
+		munmap(const_cast<uint8_t*>(mappedData), mappedSize);
+#endif
+	}
+	mappedData = nullptr;
+	mappedSize = 0U;
+	validSize = 0U;
+	recordIndex.clear();
+}
+
+
+bool ResultCache::readRecord(std::size_t offset, std::string& key, ResultCacheEntry& resultCacheEntry) const
+{
+	uint32_t dataSize{ 0U };
+	std::memcpy(&dataSize, mappedData + offset + sizeof(uint32_t), sizeof(dataSize));
+	const uint8_t* const data{ mappedData + offset + RecordHeaderSize };
+	RecordReader recordReader(data, data + dataSize);
+
+	if (!recordReader.read(key) || !recordReader.read(resultCacheEntry.minimumDisjunctiveNormalForm))
+	{
+		return false;
+	}
+	uint32_t numberOfPrimeImplicants{ 0U };
+	if (!recordReader.read(numberOfPrimeImplicants))
+	{
+		return false;
+	}
+	resultCacheEntry.primeImplicants.clear();
+	for (uint32_t i = 0U; i < numberOfPrimeImplicants; ++i)
+	{
+		std::string primeImplicant;
+		if (!recordReader.read(primeImplicant))
+		{
+			return false;
+		}
+		resultCacheEntry.primeImplicants.push_back(std::move(primeImplicant));
+	}
+	uint32_t numberOfTestSets{ 0U };
+	if (!recordReader.read(numberOfTestSets))
+	{
+		return false;
+	}
+	resultCacheEntry.testSets.clear();
+	for (uint32_t i = 0U; i < numberOfTestSets; ++i)
+	{
+		uint32_t numberOfTestValues{ 0U };
+		if (!recordReader.read(numberOfTestValues))
+		{
+			return false;
+		}
+		std::set<uint> testSet;
+		for (uint32_t k = 0U; k < numberOfTestValues; ++k)
+		{
+			uint32_t testValue{ 0U };
+			if (!recordReader.read(testValue))
+			{
+				return false;
+			}
+			testSet.insert(testValue);
+		}
+		resultCacheEntry.testSets.insert(std::move(testSet));
+	}
+	return true;
+}
+
+
+bool ResultCache::find(const std::string& key, ResultCacheEntry& resultCacheEntry) const
+{
+	const auto [first, last] { recordIndex.equal_range(hashOf(key)) };
+	for (auto record = first; record != last; ++record)
+	{
+		// Same hash. Compare the complete key
+		std::string storedKey;
+		if (readRecord(record->second, storedKey, resultCacheEntry) && (storedKey == key))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+
+bool ResultCache::add(const std::string& key, const ResultCacheEntry& resultCacheEntry)
+{
+	if (foreignFile)
+	{
+		return false;
+	}
+
+	// Build the record data
+	std::string data;
+	appendString(data, key);
+	appendString(data, resultCacheEntry.minimumDisjunctiveNormalForm);
+	appendUint32(data, narrow_cast<uint32_t>(resultCacheEntry.primeImplicants.size()));
+	for (const std::string& primeImplicant : resultCacheEntry.primeImplicants)
+	{
+		appendString(data, primeImplicant);
+	}
+	appendUint32(data, narrow_cast<uint32_t>(resultCacheEntry.testSets.size()));
+	for (const std::set<uint>& testSet : resultCacheEntry.testSets)
+	{
+		appendUint32(data, narrow_cast<uint32_t>(testSet.size()));
+		for (const uint testValue : testSet)
+		{
+			appendUint32(data, testValue);
+		}
+	}
+	std::string record;
+	record.reserve(RecordHeaderSize + data.size());
+	appendUint32(record, RecordMagicNumber);
+	appendUint32(record, narrow_cast<uint32_t>(data.size()));
+	appendUint64(record, hashOf(key));
+	record += data;
+
+	// The mapping must be closed before the file can be changed. And we want to see the current file size
+	mapFile();
+	const std::size_t endOfCompleteRecords{ validSize };
+	unmapFile();
+
+	std::error_code errorCode;
+	if (0U == endOfCompleteRecords)
+	{
+		// New file
+		record.insert(0U, FileIdentification, FileIdentificationSize);
+	}
+	else if (std::filesystem::file_size(fileName, errorCode) != endOfCompleteRecords)
+	{
+		// Remove an incomplete record at the end of the file
+		std::filesystem::resize_file(fileName, endOfCompleteRecords, errorCode);
+	}
+
+	bool result{ false };
+	{
+		std::ofstream cacheFile(fileName, (0U == endOfCompleteRecords) ? (std::ios::binary | std::ios::trunc) : (std::ios::binary | std::ios::app));
+		if (cacheFile)
+		{
+			cacheFile.write(record.data(), static_cast<std::streamsize>(record.size()));
+			result = static_cast<bool>(cacheFile);
+		}
+	}
+	mapFile();
+	return result;
+}
@@ -0,0 +1,329 @@
+// --------------------------------------------------------------------------------------------------------------------------------
+// License:	BSD-3-Clause
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Copyright 2019      Armin Montigny
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+// following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the 
+//    following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the 
+//    following disclaimer in the documentation and /or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or 
+//    promote products derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+
+
+
+// Kernels for the bit sliced evaluation of boolean expressions
+//
+// The virtual machine can run a program in bit sliced mode. Every machine register is then
+// a 64 bit word and holds the result for 64 consecutive input values. 
+//
+// With SIMD instructions, we can do even more. An AVX2 register has 256 bit, an AVX-512 register 512 bit.
+// So one pass through the program evaluates 256 or 512 input values.
+//
+// Not all CPUs support AVX2 or AVX-512. So the kernel will be selected at runtime (once, on first usage) 
+// via CPUID. If nothing is available or we are not on an x86-64 machine, then the scalar 64 bit
+// kernel is used.
+//
+// The SIMD functions are compiled for their instruction set only. So the rest of the program
+// can run on any x86-64 machine.
+
+
+#include "simdkernel.hpp"
+
+#include <memory>
+
+#if defined(MCDC_SIMD_X86_64)
+	#include <immintrin.h>
+	#if defined(_MSC_VER)
+		#include <intrin.h>
+		// MSVC allows intrinsics everywhere
+		#define MCDC_TARGET_AVX2
+		#define MCDC_TARGET_AVX512
+	#else
+		// GCC and Clang need to know, that a function will use the instruction set
+		#define MCDC_TARGET_AVX2 __attribute__((target("avx2")))
+		#define MCDC_TARGET_AVX512 __attribute__((target("avx512f")))
+	#endif
+#endif
+
+
+
+// Bit pattern of a boolean variable (given by its bit position in the input value) for the 64 input values of a truth table word 
+inline TruthTableWord literalPattern(uint bitPosition, uint word) noexcept
+{
+	// Lower 6 bits change within a word. Higher bits are constant for the whole word
+	if (bitPosition < NumberOfLaneBitsInTruthTableWord) return laneBitPattern[bitPosition];
+	const uint32 wordStartValue{ static_cast<uint32>(word) << NumberOfLaneBitsInTruthTableWord };
+	return (null<uint32>() == (wordStartValue & bitMask[bitPosition])) ? 0ULL : ~0ULL;
+}
+
+
+// ------------------------------------------------------------------------------------------------------------------------------
+// Scalar kernel. 64 input values per pass. Runs everywhere
+
+static void runScalarKernel(const ByteCodeProgram& byteCodeProgram, uint numberOfRegisters, uint numberOfLiterals,
+							uint firstWord, uint lastWord, TruthTableWord* truthTable)
+{
+	std::vector<TruthTableWord> machineWordRegister(numberOfRegisters, 0ULL);
+
+	for (uint word = firstWord; word < lastWord; ++word)
+	{
+		TruthTableWord result{ 0ULL };
+		// Run the program line by line.
+		for (const ByteCodeLine& bcl : byteCodeProgram)
+		{
+			switch (bcl.operation)
+			{
+			case Token::ID:		machineWordRegister[bcl.parameter2] = literalPattern(bcl.parameter1, word); break;
+			case Token::IDNOT:	machineWordRegister[bcl.parameter2] = ~literalPattern(bcl.parameter1, word); break;
+			case Token::OR:		machineWordRegister[bcl.parameter3] = machineWordRegister[bcl.parameter1] | machineWordRegister[bcl.parameter2]; break;
+			case Token::XOR:	machineWordRegister[bcl.parameter3] = machineWordRegister[bcl.parameter1] ^ machineWordRegister[bcl.parameter2]; break;
+			case Token::AND:	machineWordRegister[bcl.parameter3] = machineWordRegister[bcl.parameter1] & machineWordRegister[bcl.parameter2]; break;
+			case Token::NOT:	machineWordRegister[bcl.parameter2] = ~machineWordRegister[bcl.parameter1]; break;
+			case Token::END:	result = machineWordRegister[bcl.parameter1]; break;
+#pragma warning(suppress: 4061)
+#pragma warning(suppress: 4062)
+			default: break;
+			}
+		}
+		// If we have less than 6 variables, then not all 64 lanes are valid input values. Mask them out
+		if (numberOfLiterals < NumberOfLaneBitsInTruthTableWord)
+		{
+			result &= (1ULL << (1U << numberOfLiterals)) - 1ULL;
+		}
+		truthTable[word - firstWord] = result;
+	}
+}
+
+
+#if defined(MCDC_SIMD_X86_64)
+
+// SIMD registers must be aligned to their size. std::vector does not guarantee that for the SIMD types,
+// and outside of functions compiled for the instruction set, some compilers even report a smaller alignof.
+// So we take a vector of words with some spare space and align it on our own
+template <typename SimdRegister>
+static SimdRegister* allocateSimdRegisters(std::vector<TruthTableWord>& registerStorage, uint numberOfSimdRegisters)
+{
+	constexpr size_t wordsPerRegister{ sizeof(SimdRegister) / sizeof(TruthTableWord) };
+	registerStorage.assign((static_cast<size_t>(numberOfSimdRegisters) + 1U) * wordsPerRegister, 0ULL);
+	void* storage{ registerStorage.data() };
+	size_t space{ registerStorage.size() * sizeof(TruthTableWord) };
+	return static_cast<SimdRegister*>(std::align(sizeof(SimdRegister), numberOfSimdRegisters * sizeof(SimdRegister), storage, space));
+}
+
+
+// ------------------------------------------------------------------------------------------------------------------------------
+// AVX2 kernel. 256 input values (4 truth table words) per pass
+
+MCDC_TARGET_AVX2 static void runAvx2Kernel(const ByteCodeProgram& byteCodeProgram, uint numberOfRegisters, uint numberOfLiterals,
+										   uint firstWord, uint lastWord, TruthTableWord* truthTable)
+{
+	constexpr uint wordsPerPass{ 4U };
+	std::vector<TruthTableWord> registerStorage;
+	// Machine registers and the bit patterns for all boolean variables (calculated once per pass)
+	__m256i* const machineRegister{ allocateSimdRegisters<__m256i>(registerStorage, numberOfRegisters + numberOfLiterals) };
+	__m256i* const literal{ machineRegister + numberOfRegisters };
+	const __m256i allOnes{ _mm256_set1_epi64x(-1LL) };
+
+	uint word{ firstWord };
+	for (; (word + wordsPerPass) <= lastWord; word += wordsPerPass)
+	{
+		for (uint bitPosition = 0U; bitPosition < numberOfLiterals; ++bitPosition)
+		{
+			literal[bitPosition] = _mm256_set_epi64x(static_cast<sll>(literalPattern(bitPosition, word + 3U)), static_cast<sll>(literalPattern(bitPosition, word + 2U)),
+														   static_cast<sll>(literalPattern(bitPosition, word + 1U)), static_cast<sll>(literalPattern(bitPosition, word)));
+		}
+		__m256i result{ _mm256_setzero_si256() };
+		for (const ByteCodeLine& bcl : byteCodeProgram)
+		{
+			switch (bcl.operation)
+			{
+			case Token::ID:		machineRegister[bcl.parameter2] = literal[bcl.parameter1]; break;
+			case Token::IDNOT:	machineRegister[bcl.parameter2] = _mm256_xor_si256(literal[bcl.parameter1], allOnes); break;
+			case Token::OR:		machineRegister[bcl.parameter3] = _mm256_or_si256(machineRegister[bcl.parameter1], machineRegister[bcl.parameter2]); break;
+			case Token::XOR:	machineRegister[bcl.parameter3] = _mm256_xor_si256(machineRegister[bcl.parameter1], machineRegister[bcl.parameter2]); break;
+			case Token::AND:	machineRegister[bcl.parameter3] = _mm256_and_si256(machineRegister[bcl.parameter1], machineRegister[bcl.parameter2]); break;
+			case Token::NOT:	machineRegister[bcl.parameter2] = _mm256_xor_si256(machineRegister[bcl.parameter1], allOnes); break;
+			case Token::END:	result = machineRegister[bcl.parameter1]; break;
+#pragma warning(suppress: 4061)
+#pragma warning(suppress: 4062)
+			default: break;
+			}
+		}
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(truthTable + (word - firstWord)), result);
+	}
+	// The rest, that does not fit into a complete pass
+	if (word < lastWord)
+	{
+		runScalarKernel(byteCodeProgram, numberOfRegisters, numberOfLiterals, word, lastWord, truthTable + (word - firstWord));
+	}
+}
+
+
+// ------------------------------------------------------------------------------------------------------------------------------
+// AVX-512 kernel. 512 input values (8 truth table words) per pass
+
+MCDC_TARGET_AVX512 static void runAvx512Kernel(const ByteCodeProgram& byteCodeProgram, uint numberOfRegisters, uint numberOfLiterals,
+											   uint firstWord, uint lastWord, TruthTableWord* truthTable)
+{
+	constexpr uint wordsPerPass{ 8U };
+	std::vector<TruthTableWord> registerStorage;
+	// Machine registers and the bit patterns for all boolean variables (calculated once per pass)
+	__m512i* const machineRegister{ allocateSimdRegisters<__m512i>(registerStorage, numberOfRegisters + numberOfLiterals) };
+	__m512i* const literal{ machineRegister + numberOfRegisters };
+	const __m512i allOnes{ _mm512_set1_epi64(-1LL) };
+
+	uint word{ firstWord };
+	for (; (word + wordsPerPass) <= lastWord; word += wordsPerPass)
+	{
+		for (uint bitPosition = 0U; bitPosition < numberOfLiterals; ++bitPosition)
+		{
+			literal[bitPosition] = _mm512_set_epi64(static_cast<sll>(literalPattern(bitPosition, word + 7U)), static_cast<sll>(literalPattern(bitPosition, word + 6U)),
+														  static_cast<sll>(literalPattern(bitPosition, word + 5U)), static_cast<sll>(literalPattern(bitPosition, word + 4U)),
+														  static_cast<sll>(literalPattern(bitPosition, word + 3U)), static_cast<sll>(literalPattern(bitPosition, word + 2U)),
+														  static_cast<sll>(literalPattern(bitPosition, word + 1U)), static_cast<sll>(literalPattern(bitPosition, word)));
+		}
+		__m512i result{ _mm512_setzero_si512() };
+		for (const ByteCodeLine& bcl : byteCodeProgram)
+		{
+			switch (bcl.operation)
+			{
+			case Token::ID:		machineRegister[bcl.parameter2] = literal[bcl.parameter1]; break;
+			case Token::IDNOT:	machineRegister[bcl.parameter2] = _mm512_xor_si512(literal[bcl.parameter1], allOnes); break;
+			case Token::OR:		machineRegister[bcl.parameter3] = _mm512_or_si512(machineRegister[bcl.parameter1], machineRegister[bcl.parameter2]); break;
+			case Token::XOR:	machineRegister[bcl.parameter3] = _mm512_xor_si512(machineRegister[bcl.parameter1], machineRegister[bcl.parameter2]); break;
+			case Token::AND:	machineRegister[bcl.parameter3] = _mm512_and_si512(machineRegister[bcl.parameter1], machineRegister[bcl.parameter2]); break;
+			case Token::NOT:	machineRegister[bcl.parameter2] = _mm512_xor_si512(machineRegister[bcl.parameter1], allOnes); break;
+			case Token::END:	result = machineRegister[bcl.parameter1]; break;
+#pragma warning(suppress: 4061)
+#pragma warning(suppress: 4062)
+			default: break;
+			}
+		}
+		_mm512_storeu_si512(truthTable + (word - firstWord), result);
+	}
+	// The rest, that does not fit into a complete pass
+	if (word < lastWord)
+	{
+		runScalarKernel(byteCodeProgram, numberOfRegisters, numberOfLiterals, word, lastWord, truthTable + (word - firstWord));
+	}
+}
+
+
+// ------------------------------------------------------------------------------------------------------------------------------
+// Check the CPU capabilities. Also the operating system must support the bigger registers
+
+static SimdKernel detectSimdKernel() noexcept
+{
+	SimdKernel simdKernel{ SimdKernel::Scalar };
+#if defined(_MSC_VER)
+	int cpuInfo[4]{};
+	__cpuid(cpuInfo, 0);
+	const int maxLeaf{ cpuInfo[0] };
+	if (maxLeaf >= 7)
+	{
+		__cpuid(cpuInfo, 1);
+		// OS uses XSAVE and CPU has AVX
+		const bool osxsave{ (cpuInfo[2] & (1 << 27)) != 0 };
+		const bool avx{ (cpuInfo[2] & (1 << 28)) != 0 };
+		if (osxsave && avx)
+		{
+			// Check which registers are saved by the OS
+			const ull xcr0{ _xgetbv(0) };
+			__cpuidex(cpuInfo, 7, 0);
+			if (((xcr0 & 0xE6ULL) == 0xE6ULL) && ((cpuInfo[1] & (1 << 16)) != 0))
+			{
+				simdKernel = SimdKernel::AVX512;
+			}
+			else if (((xcr0 & 0x06ULL) == 0x06ULL) && ((cpuInfo[1] & (1 << 5)) != 0))
+			{
+				simdKernel = SimdKernel::AVX2;
+			}
+		}
+	}
+#else
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx512f"))
+	{
+		simdKernel = SimdKernel::AVX512;
+	}
+	else if (__builtin_cpu_supports("avx2"))
+	{
+		simdKernel = SimdKernel::AVX2;
+	}
+#endif
+	return simdKernel;
+}
+
+#else
+
+// Not on x86-64. Always use the scalar kernel
+static SimdKernel detectSimdKernel() noexcept
+{
+	return SimdKernel::Scalar;
+}
+
+#endif
+
+
+// ------------------------------------------------------------------------------------------------------------------------------
+// Interface functions
+
+// Select the kernel once at first usage
+SimdKernel selectedSimdKernel() noexcept
+{
+	static const SimdKernel simdKernel{ detectSimdKernel() };
+	return simdKernel;
+}
+
+
+const cchar* simdKernelName(SimdKernel simdKernel) noexcept
+{
+	const cchar* name{ "Scalar" };
+	switch (simdKernel)
+	{
+	case SimdKernel::AVX2:		name = "AVX2"; break;
+	case SimdKernel::AVX512:	name = "AVX-512"; break;
+	case SimdKernel::Scalar:	name = "Scalar"; break;
+	}
+	return name;
+}
+
+
+// Evaluate the byte code program in bit sliced mode for the truth table words firstWord ... lastWord-1 with the given kernel
+void runBitSlicedKernel(SimdKernel simdKernel, const ByteCodeProgram& byteCodeProgram, uint numberOfRegisters, uint numberOfLiterals,
+						uint firstWord, uint lastWord, TruthTableWord* truthTable)
+{
+	switch (simdKernel)
+	{
+#if defined(MCDC_SIMD_X86_64)
+	case SimdKernel::AVX512:
+		runAvx512Kernel(byteCodeProgram, numberOfRegisters, numberOfLiterals, firstWord, lastWord, truthTable);
+		break;
+	case SimdKernel::AVX2:
+		runAvx2Kernel(byteCodeProgram, numberOfRegisters, numberOfLiterals, firstWord, lastWord, truthTable);
+		break;
+#endif
+	default:
+		runScalarKernel(byteCodeProgram, numberOfRegisters, numberOfLiterals, firstWord, lastWord, truthTable);
+		break;
+	}
+}
@@ -0,0 +1,216 @@
+// --------------------------------------------------------------------------------------------------------------------------------
+// License:	BSD-3-Clause
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Copyright 2019      Armin Montigny
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+// following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the 
+//    following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the 
+//    following disclaimer in the documentation and /or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or 
+//    promote products derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+
+
+// Machine readable statistics and timing for all stages. See statistics.hpp
+
+#include "statistics.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+
+#if defined(_WIN32)
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <windows.h>
+#endif
+
+
+namespace
+{
+	// Strings in JSON need escaping for quotes, backslashes and control characters
+	void writeJsonString(std::ostream& os, const std::string& value)
+	{
+		os << '"';
+		for (const cchar c : value)
+		{
+			switch (c)
+			{
+			case '"': os << "\\\""; break;
+			case '\\': os << "\\\\"; break;
+			case '\n': os << "\\n"; break;
+			case '\t': os << "\\t"; break;
+			default:
+				if (static_cast<uchar>(c) < 0x20U)
+				{
+					os << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<uint>(static_cast<uchar>(c)) << std::dec << std::setfill(' ');
+				}
+				else
+				{
+					os << c;
+				}
+				break;
+			}
+		}
+		os << '"';
+	}
+}
+
+
+// Add a value to a counter. Counters are found by a linear search. There are only a few per stage
+void StageStatistics::add(const std::string& counterName, ull value)
+{
+	if (isRecorded)
+	{
+		std::vector<std::pair<std::string, ull>>::iterator c{ std::find_if(counter.begin(), counter.end(), [&counterName](const std::pair<std::string, ull>& nc) { return nc.first == counterName; }) };
+		if (counter.end() == c)
+		{
+			counter.emplace_back(counterName, 0ULL);
+			c = counter.end() - 1;
+		}
+		c->second += value;
+	}
+}
+
+
+// Append a value to a series
+void StageStatistics::append(const std::string& seriesName, ull value)
+{
+	if (isRecorded)
+	{
+		std::vector<std::pair<std::string, std::vector<ull>>>::iterator s{ std::find_if(series.begin(), series.end(), [&seriesName](const std::pair<std::string, std::vector<ull>>& ns) { return ns.first == seriesName; }) };
+		if (series.end() == s)
+		{
+			series.emplace_back(seriesName, std::vector<ull>());
+			s = series.end() - 1;
+		}
+		s->second.push_back(value);
+	}
+}
+
+
+// Create a new stage. If statistics are not enabled, the dummy will be used
+StageStatistics& Statistics::addStage(const std::string& name)
+{
+	if (!enabled)
+	{
+		return notRecorded;
+	}
+	std::lock_guard<std::mutex> lock(mutexForStage);
+	stage.emplace_back();
+	stage.back().name = name;
+	return stage.back();
+}
+
+
+// All stages as one JSON object. Counters and series of a stage are members of the object "counter"
+void Statistics::writeJson(std::ostream& os) const
+{
+	os << "{\n  \"stages\": [";
+	bool firstStage{ true };
+	for (const StageStatistics& ss : stage)
+	{
+		os << (firstStage ? "\n" : ",\n") << "    {\n      \"name\": ";
+		firstStage = false;
+		writeJsonString(os, ss.name);
+		os << ",\n      \"wallClockTime\": " << std::setprecision(9) << ss.wallClockTime << ",\n      \"cpuTime\": " << ss.cpuTime << ",\n      \"counter\": {";
+
+		bool firstCounter{ true };
+		for (const std::pair<std::string, ull>& nc : ss.counter)
+		{
+			os << (firstCounter ? "\n        " : ",\n        ");
+			firstCounter = false;
+			writeJsonString(os, nc.first);
+			os << ": " << nc.second;
+		}
+		for (const std::pair<std::string, std::vector<ull>>& ns : ss.series)
+		{
+			os << (firstCounter ? "\n        " : ",\n        ");
+			firstCounter = false;
+			writeJsonString(os, ns.first);
+			os << ": [";
+			for (std::size_t i = 0U; i < ns.second.size(); ++i)
+			{
+				os << ((0U == i) ? "" : ", ") << ns.second[i];
+			}
+			os << ']';
+		}
+		os << (firstCounter ? "}" : "\n      }") << "\n    }";
+	}
+	os << (firstStage ? "]" : "\n  ]") << "\n}\n";
+}
+
+
+bool Statistics::writeJsonFile(const std::string& fileName) const
+{
+	std::ofstream ofs(fileName);
+	if (ofs)
+	{
+		writeJson(ofs);
+	}
+	return static_cast<bool>(ofs);
+}
+
+
+// The process wide statistics. Enabled in main, if option -stats is selected
+Statistics& statistics()
+{
+	static Statistics processStatistics;
+	return processStatistics;
+}
+
+
+
+// Start the measurement for a new stage
+StageTimer::StageTimer(const std::string& name) : stageStatistics(statistics().addStage(name)), wallClockStart(std::chrono::steady_clock::now()), cpuTimeStart(processCpuTime())
+{
+}
+
+
+// Stop the measurement and store the times
+StageTimer::~StageTimer()
+{
+	if (stageStatistics.isRecorded)
+	{
+		stageStatistics.wallClockTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallClockStart).count();
+		stageStatistics.cpuTime = processCpuTime() - cpuTimeStart;
+	}
+}
+
+
+// User and kernel time of all threads of the process. On Windows std::clock is the wall clock time, so the system is asked directly
+double StageTimer::processCpuTime() noexcept
+{
+#if defined(_WIN32)
+	FILETIME creationTime{}, exitTime{}, kernelTime{}, userTime{};
+	double result{ 0.0 };
+	if (GetProcessTimes(GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime))
+	{
+		// File times are in units of 100 ns
+		const ull kernel{ (static_cast<ull>(kernelTime.dwHighDateTime) << 32U) | kernelTime.dwLowDateTime };
+		const ull user{ (static_cast<ull>(userTime.dwHighDateTime) << 32U) | userTime.dwLowDateTime };
+		result = static_cast<double>(kernel + user) * 1.0e-7;
+	}
+	return result;
+#else
+	return static_cast<double>(std::clock()) / static_cast<double>(CLOCKS_PER_SEC);
+#endif
+}
@@ -0,0 +1,192 @@
+// --------------------------------------------------------------------------------------------------------------------------------
+// License:	BSD-3-Clause
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Copyright 2019      Armin Montigny
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+// following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the 
+//    following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the 
+//    following disclaimer in the documentation and /or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or 
+//    promote products derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+
+
+// Work stealing thread pool. Please see the description in threadpool.hpp
+
+
+#include "threadpool.hpp"
+#include "cloption.hpp"
+
+#include <string>
+
+
+// Every thread knows, if it is a worker of a pool and which queue belongs to it
+// Threads outside the pool have no own queue
+thread_local const ThreadPool* poolOfCurrentThread{ nullptr };
+thread_local uint indexOfQueueForCurrentThread{ 0U };
+
+
+// Start the worker threads. Each worker has its own task queue
+ThreadPool::ThreadPool(uint numberOfWorkerThreads)
+{
+	if (0U == numberOfWorkerThreads)
+	{
+		numberOfWorkerThreads = 1U;
+	}
+	for (uint i = 0U; i < numberOfWorkerThreads; ++i)
+	{
+		taskQueue.emplace_back(std::make_unique<TaskQueue>());
+	}
+	// Queues must exist, before the first worker starts to steal
+	for (uint i = 0U; i < numberOfWorkerThreads; ++i)
+	{
+		worker.emplace_back(&ThreadPool::workerLoop, this, i);
+	}
+}
+
+// Let the workers finish all pending tasks and wait for them
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutexForSleep);
+		stopWorker = true;
+	}
+	conditionForWakeUp.notify_all();
+	for (std::thread& t : worker)
+	{
+		t.join();
+	}
+}
+
+
+// Workers put new tasks into their own queue. All others distribute them round robin
+void ThreadPool::push(Task&& task)
+{
+	const uint numberOfQueues{ narrow_cast<uint>(taskQueue.size()) };
+	const uint indexOfQueue{ (this == poolOfCurrentThread) ? indexOfQueueForCurrentThread : (nextQueueForSubmit++ % numberOfQueues) };
+
+	// Count first. So the number of pending tasks is never less than the tasks in the queues
+	++numberOfPendingTasks;
+	{
+		std::lock_guard<std::mutex> lock(taskQueue[indexOfQueue]->mutex);
+		taskQueue[indexOfQueue]->task.push_back(std::move(task));
+	}
+	// Wake up one sleeping worker
+	{
+		std::lock_guard<std::mutex> lock(mutexForSleep);
+	}
+	conditionForWakeUp.notify_one();
+}
+
+
+// Look first in the own queue (back), then steal from the other queues (front)
+bool ThreadPool::tryToRunOneTask()
+{
+	Task task{};
+	bool taskFound{ false };
+
+	const uint numberOfQueues{ narrow_cast<uint>(taskQueue.size()) };
+	const bool isWorker{ this == poolOfCurrentThread };
+	const uint indexOfOwnQueue{ isWorker ? indexOfQueueForCurrentThread : 0U };
+
+	if (isWorker)
+	{
+		std::lock_guard<std::mutex> lock(taskQueue[indexOfOwnQueue]->mutex);
+		if (!taskQueue[indexOfOwnQueue]->task.empty())
+		{
+			task = std::move(taskQueue[indexOfOwnQueue]->task.back());
+			taskQueue[indexOfOwnQueue]->task.pop_back();
+			taskFound = true;
+		}
+	}
+	// Nothing in the own queue. Steal from the others, starting with the neighbour
+	for (uint i = (isWorker ? 1U : 0U); (i < numberOfQueues) && !taskFound; ++i)
+	{
+		TaskQueue& victim{ *taskQueue[(indexOfOwnQueue + i) % numberOfQueues] };
+		std::lock_guard<std::mutex> lock(victim.mutex);
+		if (!victim.task.empty())
+		{
+			task = std::move(victim.task.front());
+			victim.task.pop_front();
+			taskFound = true;
+		}
+	}
+
+	if (taskFound)
+	{
+		--numberOfPendingTasks;
+		task();
+	}
+	return taskFound;
+}
+
+
+// Run tasks as long as there are some. Then sleep until there is new work or the pool shall be stopped
+void ThreadPool::workerLoop(uint indexOfQueue)
+{
+	poolOfCurrentThread = this;
+	indexOfQueueForCurrentThread = indexOfQueue;
+
+	bool doRun{ true };
+	while (doRun)
+	{
+		if (!tryToRunOneTask())
+		{
+			std::unique_lock<std::mutex> lock(mutexForSleep);
+			conditionForWakeUp.wait(lock, [this]() { return stopWorker || (numberOfPendingTasks > 0U); });
+			doRun = !(stopWorker && (0U == numberOfPendingTasks));
+		}
+	}
+}
+
+
+
+// The process wide thread pool. Size is taken from the command line option -threads
+// If not given (or 0), then all hardware threads will be used
+ThreadPool& threadPool()
+{
+	static ThreadPool pool{ []() -> uint
+	{
+		uint numberOfWorkerThreads{ 0U };
+		if (programOption.option[ProgramOption::threads].optionSelected)
+		{
+			try
+			{
+				numberOfWorkerThreads = narrow_cast<uint>(std::stoul(programOption.option[ProgramOption::threads].optionParameterString));
+			}
+			catch (const std::exception&)
+			{
+				numberOfWorkerThreads = 0U;
+			}
+		}
+		if (0U == numberOfWorkerThreads)
+		{
+			numberOfWorkerThreads = std::thread::hardware_concurrency();
+		}
+		// If the hardware concurrency is not known, then use a default
+		if (0U == numberOfWorkerThreads)
+		{
+			numberOfWorkerThreads = numberOfThreads;
+		}
+		return numberOfWorkerThreads;
+	}() };
+	return pool;
+}
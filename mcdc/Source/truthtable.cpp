@@ -0,0 +1,97 @@
+// --------------------------------------------------------------------------------------------------------------------------------
+// License:	BSD-3-Clause
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Copyright 2019      Armin Montigny
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+// following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the 
+//    following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the 
+//    following disclaimer in the documentation and /or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or 
+//    promote products derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+
+
+
+// Packed truth table for a boolean expression
+//
+// One bit per input value. See truthtable.hpp
+
+
+#include "truthtable.hpp"
+
+#include <algorithm>
+
+
+// Create the truth table from packed words and build the directory for rank and select
+TruthTable::TruthTable(uint numberOfBooleanVariables, TruthTableWordStream&& packedWords) : numberOfVariables(numberOfBooleanVariables), word(std::move(packedWords)), numberOfMintermsBeforeWord()
+{
+	// There is always at least one word
+	if (word.empty()) word.push_back(0ULL);
+	numberOfMintermsBeforeWord.reserve(word.size() + 1U);
+	ull count{ 0ULL };
+	for (const TruthTableWord w : word)
+	{
+		numberOfMintermsBeforeWord.push_back(count);
+		count += numberOfSetBitsInTruthTableWord(w);
+	}
+	numberOfMintermsBeforeWord.push_back(count);
+}
+
+
+// Number of minterms less than the given input value
+ull TruthTable::rank(ull inputValue) const noexcept
+{
+	ull result{ numberOfMinterms() };
+	const std::size_t wordIndex{ static_cast<std::size_t>(inputValue >> NumberOfLaneBitsInTruthTableWord) };
+	if (wordIndex < word.size())
+	{
+		// Minterms in the words before plus the minterms in the lower bits of this word
+		const TruthTableWord lowerBits{ (1ULL << (inputValue & (NumberOfLanesInTruthTableWord - 1U))) - 1ULL };
+		result = numberOfMintermsBeforeWord[wordIndex] + numberOfSetBitsInTruthTableWord(word[wordIndex] & lowerBits);
+	}
+	return result;
+}
+
+
+// Get the n-th minterm
+MinTermNumber TruthTable::select(ull index) const noexcept
+{
+	// Find the word with the minterm. The directory is sorted, so we can use a binary search
+	const std::vector<ull>::const_iterator wordAfter{ std::upper_bound(numberOfMintermsBeforeWord.begin(), numberOfMintermsBeforeWord.end(), index) };
+	const std::size_t wordIndex{ static_cast<std::size_t>(std::distance(numberOfMintermsBeforeWord.begin(), wordAfter)) - 1U };
+	// And then the bit in this word. Remove the lower set bits
+	TruthTableWord w{ word[wordIndex] };
+	for (ull i = numberOfMintermsBeforeWord[wordIndex]; i < index; ++i)
+	{
+		w &= w - 1ULL;
+	}
+	return narrow_cast<MinTermNumber>((wordIndex << NumberOfLaneBitsInTruthTableWord) + indexOfLowestSetBitInTruthTableWord(w));
+}
+
+
+// All minterms in ascending order
+MintermVector TruthTable::toMintermVector() const
+{
+	MintermVector mv;
+	mv.reserve(static_cast<std::size_t>(numberOfMinterms()));
+	std::copy(begin(), end(), std::back_inserter(mv));
+	return mv;
+}
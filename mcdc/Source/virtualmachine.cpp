@@ -49,12 +49,15 @@
 // Feeding the virtual machine with all possible compbinations of input variables will create
 // a truth table. But only the minterms will be stored later.
 //
+// In the bit sliced mode, 64 input values are evaluated in one program run.
+//
 
 
 #include "codegenerator.hpp"
 #include "cloption.hpp"
 #include "virtualmachine.hpp"
 
+#include <algorithm>
 #include <iostream>
 #include <iomanip>
 #include <string>
@@ -65,7 +68,7 @@
 // The resulting code is printed
 // After loading the object code, the program can be ececuted
 
-void VirtualMachineForBooleanExpressions::load(ObjectCode& objectCode, const std::string& source)
+void VirtualMachineForBooleanExpressions::load(ObjectCode& objectCode, const std::string& source, bool showListing)
 {
 	// On executable code line of the resulting programm
 	// An executable code line consists of a function (for the operation) and 3 parameters
@@ -75,6 +78,8 @@ void VirtualMachineForBooleanExpressions::load(ObjectCode& objectCode, const std
 
 	// Clear the program before loading new object code. So delete all executable lines
 	program.clear();
+	byteCodeProgram.clear();
+	nativeCodeIsCompiled = false;
 
 	// And, before starting, compact the symbol table
 	objectCode.symbolTable.compact();
@@ -84,7 +89,9 @@ void VirtualMachineForBooleanExpressions::load(ObjectCode& objectCode, const std
 	const uint opCodeSize{ narrow_cast<uint>(objectCode.opCode.size()) };
 	const bool predicateForOutputToFile{ (opCodeSize > 150) };
 	OutStreamSelection outStreamSelection(ProgramOption::pcoc, predicateForOutputToFile);
-	std::ostream& os{ outStreamSelection() };
+	// If no listing is wanted, everything goes to the null stream
+	OutputHandling::NullStream nullStream;
+	std::ostream& os{ showListing ? outStreamSelection() : nullStream };
 
 	// Inform the user
 	os << "\n------------------ Compiling boolean expression\n\n'" << source << "'\n\n------------------ Compilation result. Virtual Machine Executable Code\n\n" ;
@@ -171,10 +178,13 @@ void VirtualMachineForBooleanExpressions::load(ObjectCode& objectCode, const std
 		}
 		// Add a new executable line to the program
 		program.push_back(executableCodeLine);
+		// And the same as dense byte code
+		byteCodeProgram.push_back({ opCodeLine.token, narrow_cast<ByteCodeOperand>(executableCodeLine.parameter1), narrow_cast<ByteCodeOperand>(executableCodeLine.parameter2), narrow_cast<ByteCodeOperand>(executableCodeLine.parameter3) });
 		++counter;
 	}
 	// After program has bee created, provide space for machine registers
 	machineRegister.resize(static_cast<size_t>(maxRegister) + 1U, 0);
+	numberOfMachineRegisters = maxRegister + 1U;
 
 	os << "\n\n";
 
@@ -182,8 +192,47 @@ void VirtualMachineForBooleanExpressions::load(ObjectCode& objectCode, const std
 
 
 
+// Translate the byte code to native machine code, if possible. Only once after loading a program
+void VirtualMachineForBooleanExpressions::compileNativeCode()
+{
+	if (!nativeCodeIsCompiled)
+	{
+		static_cast<void>(nativeCode.compile(byteCodeProgram, numberOfMachineRegisters));
+		nativeCodeIsCompiled = true;
+	}
+}
+
+
 // Run the program, generated from the boolean expression, for a given input value
+// This is the byte code interpreter. A simple switch loop without any indirect calls
 bool VirtualMachineForBooleanExpressions::run(uint sv)
+{
+	sourceValue = sv;
+	MachineRegisterType* const reg{ machineRegister.data() };
+	// Run the program line by line 
+	for (const ByteCodeLine& bcl : byteCodeProgram)
+	{
+		switch (bcl.operation)
+		{
+		case Token::ID:		reg[bcl.parameter2] = getSourceValue(bcl.parameter1); break;
+		case Token::IDNOT:	reg[bcl.parameter2] = getSourceValueNegated(bcl.parameter1); break;
+		case Token::OR:		reg[bcl.parameter3] = narrow_cast<MachineRegisterType>(reg[bcl.parameter1] | reg[bcl.parameter2]); break;
+		case Token::XOR:	reg[bcl.parameter3] = narrow_cast<MachineRegisterType>(reg[bcl.parameter1] ^ reg[bcl.parameter2]); break;
+		case Token::AND:	reg[bcl.parameter3] = narrow_cast<MachineRegisterType>(reg[bcl.parameter1] & reg[bcl.parameter2]); break;
+		case Token::NOT:	reg[bcl.parameter2] = narrow_cast<MachineRegisterType>(reg[bcl.parameter1] ^ 1U); break;
+		case Token::END:	programResult = reg[bcl.parameter1]; break;
+#pragma warning(suppress: 4061)
+#pragma warning(suppress: 4062)
+		default: break;
+		}
+	}
+	// ProgramResult will be set by end operation
+	return programResult ? true : false;
+}
+
+
+// Reference implementation. Run the program with the std::function executables
+bool VirtualMachineForBooleanExpressions::runReference(uint sv)
 {
 	sourceValue = sv;
 	// Run the program line by line 
@@ -198,3 +247,94 @@ bool VirtualMachineForBooleanExpressions::run(uint sv)
 
 
 
+// Run the program in bit sliced mode for the 64 input values starting at blockIndex*64
+// Each register holds 64 results. Bit k belongs to input value blockIndex*64+k
+TruthTableWord VirtualMachineForBooleanExpressions::runBitSliced(uint blockIndex)
+{
+	TruthTableWord result{ 0ULL };
+	// For one word only, we always use the scalar kernel
+	runBitSlicedKernel(SimdKernel::Scalar, byteCodeProgram, numberOfMachineRegisters, numberOfLiterals, blockIndex, blockIndex + 1U, &result);
+	return result;
+}
+
+
+// Calculate a part of the packed truth table with the bit sliced mode
+// The best available kernel for this CPU will be used
+TruthTableWordStream VirtualMachineForBooleanExpressions::runBitSlicedForRange(uint firstWord, uint lastWord)
+{
+	TruthTableWordStream truthTable(lastWord - firstWord, 0ULL);
+	if (!truthTable.empty())
+	{
+		runBitSlicedKernel(selectedSimdKernel(), byteCodeProgram, numberOfMachineRegisters, numberOfLiterals, firstWord, lastWord, truthTable.data());
+	}
+	return truthTable;
+}
+
+
+// Calculate the complete packed truth table with the bit sliced mode
+TruthTableWordStream VirtualMachineForBooleanExpressions::runBitSlicedForAllInputs()
+{
+	return runBitSlicedForRange(0U, numberOfTruthTableWords());
+}
+
+
+
+// Batch mode. Evaluate many arbitrary input values with one call
+// 64 input values are transposed, so that bit k of literal word v is bit v of inputs[k]. Then the byte code
+// is run once in bit sliced mode for these 64 input values
+void VirtualMachineForBooleanExpressions::runBatch(const uint32_t* inputs, std::size_t numberOfInputs, TruthTableWord* resultBits)
+{
+	// Working memory is kept in the virtual machine. So no allocation is needed for subsequent calls
+	batchLiteral.resize(numberOfLiterals);
+	batchMachineRegister.resize(numberOfMachineRegisters);
+	TruthTableWord* const literal{ batchLiteral.data() };
+	TruthTableWord* const machineWordRegister{ batchMachineRegister.data() };
+
+	for (std::size_t start = 0U; start < numberOfInputs; start += NumberOfLanesInTruthTableWord)
+	{
+		const std::size_t numberOfLanes{ std::min<std::size_t>(NumberOfLanesInTruthTableWord, numberOfInputs - start) };
+		// Transpose 64 input values into literal words
+		std::fill(batchLiteral.begin(), batchLiteral.end(), 0ULL);
+		for (std::size_t lane = 0U; lane < numberOfLanes; ++lane)
+		{
+			const uint32_t inputValue{ inputs[start + lane] };
+			for (uint bitPosition = 0U; bitPosition < numberOfLiterals; ++bitPosition)
+			{
+				literal[bitPosition] |= static_cast<TruthTableWord>((inputValue >> bitPosition) & 1U) << lane;
+			}
+		}
+		// Run the program for 64 lanes
+		TruthTableWord result{ 0ULL };
+		for (const ByteCodeLine& bcl : byteCodeProgram)
+		{
+			switch (bcl.operation)
+			{
+			case Token::ID:		machineWordRegister[bcl.parameter2] = literal[bcl.parameter1]; break;
+			case Token::IDNOT:	machineWordRegister[bcl.parameter2] = ~literal[bcl.parameter1]; break;
+			case Token::OR:		machineWordRegister[bcl.parameter3] = machineWordRegister[bcl.parameter1] | machineWordRegister[bcl.parameter2]; break;
+			case Token::XOR:	machineWordRegister[bcl.parameter3] = machineWordRegister[bcl.parameter1] ^ machineWordRegister[bcl.parameter2]; break;
+			case Token::AND:	machineWordRegister[bcl.parameter3] = machineWordRegister[bcl.parameter1] & machineWordRegister[bcl.parameter2]; break;
+			case Token::NOT:	machineWordRegister[bcl.parameter2] = ~machineWordRegister[bcl.parameter1]; break;
+			case Token::END:	result = machineWordRegister[bcl.parameter1]; break;
+#pragma warning(suppress: 4061)
+#pragma warning(suppress: 4062)
+			default: break;
+			}
+		}
+		// Unused lanes in the last word are 0
+		if (numberOfLanes < NumberOfLanesInTruthTableWord)
+		{
+			result &= (1ULL << numberOfLanes) - 1ULL;
+		}
+		resultBits[start / NumberOfLanesInTruthTableWord] = result;
+	}
+}
+
+
+// Batch mode with vectors
+TruthTableWordStream VirtualMachineForBooleanExpressions::runBatch(const std::vector<uint32_t>& inputs)
+{
+	TruthTableWordStream resultBits((inputs.size() + NumberOfLanesInTruthTableWord - 1U) / NumberOfLanesInTruthTableWord, 0ULL);
+	runBatch(inputs.data(), inputs.size(), resultBits.data());
+	return resultBits;
+}
@@ -0,0 +1,381 @@
+// --------------------------------------------------------------------------------------------------------------------------------
+// License:	BSD-3-Clause
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Copyright 2019      Armin Montigny
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+// following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the 
+//    following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the 
+//    following disclaimer in the documentation and /or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or 
+//    promote products derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+
+
+
+
+// Zero-suppressed binary decision diagram and a cover solver based on it. See zdd.hpp
+
+#include "zdd.hpp"
+#include "branchandbound.hpp"
+#include "statistics.hpp"
+
+#include <algorithm>
+
+
+// Create the 2 terminal nodes
+Zdd::Zdd() : node{ { TerminalVariable, Empty, Empty }, { TerminalVariable, Base, Base } }
+{
+}
+
+
+// Every node exists only once. A node with an empty high child is not needed. The low child is used instead
+Zdd::Node Zdd::getNode(uint variable, Node low, Node high)
+{
+	Node result{ low };
+	if (Empty != high)
+	{
+		if (variable >= uniqueTable.size())
+		{
+			uniqueTable.resize(static_cast<std::size_t>(variable) + 1U);
+		}
+		const ull key{ makeKey(low, high) };
+		const auto iter{ uniqueTable[variable].find(key) };
+		if (uniqueTable[variable].end() != iter)
+		{
+			result = iter->second;
+		}
+		else
+		{
+			result = narrow_cast<Node>(node.size());
+			node.push_back({ variable, low, high });
+			uniqueTable[variable].emplace(key, result);
+		}
+	}
+	return result;
+}
+
+
+// F + G. Split both families at the smaller top variable and unite the parts
+Zdd::Node Zdd::unite(Node f, Node g)
+{
+	if (f > g)
+	{
+		std::swap(f, g);
+	}
+	Node result{ g };
+	if ((Empty != f) && (f != g))
+	{
+		const ull key{ makeKey(f, g) };
+		const auto iter{ cacheUnite.find(key) };
+		if (cacheUnite.end() != iter)
+		{
+			result = iter->second;
+		}
+		else
+		{
+			// Copy the nodes. The node table may grow in the recursion
+			const NodeType nf{ node[f] };
+			const NodeType ng{ node[g] };
+			if (nf.variable < ng.variable)
+			{
+				result = getNode(nf.variable, unite(nf.low, g), nf.high);
+			}
+			else if (nf.variable > ng.variable)
+			{
+				result = getNode(ng.variable, unite(f, ng.low), ng.high);
+			}
+			else
+			{
+				// Both are different and are not terminal. Otherwise the terminals would be equal
+				result = getNode(nf.variable, unite(nf.low, ng.low), unite(nf.high, ng.high));
+			}
+			cacheUnite.emplace(key, result);
+		}
+	}
+	return result;
+}
+
+
+// F * G = all f u g. With v as smaller top variable: F = F0 + v F1 and G = G0 + v G1
+// F * G = F0 G0 + v (F1 G1 + F1 G0 + F0 G1)
+Zdd::Node Zdd::join(Node f, Node g)
+{
+	if (f > g)
+	{
+		std::swap(f, g);
+	}
+	Node result{ Empty };
+	if (Empty != f)
+	{
+		if (Base == f)
+		{
+			result = g;
+		}
+		else
+		{
+			const ull key{ makeKey(f, g) };
+			const auto iter{ cacheJoin.find(key) };
+			if (cacheJoin.end() != iter)
+			{
+				result = iter->second;
+			}
+			else
+			{
+				const NodeType nf{ node[f] };
+				const NodeType ng{ node[g] };
+				const uint variable{ std::min(nf.variable, ng.variable) };
+				const Node f0{ (nf.variable == variable) ? nf.low : f };
+				const Node f1{ (nf.variable == variable) ? nf.high : Empty };
+				const Node g0{ (ng.variable == variable) ? ng.low : g };
+				const Node g1{ (ng.variable == variable) ? ng.high : Empty };
+
+				const Node low{ join(f0, g0) };
+				const Node high{ unite(unite(join(f1, g1), join(f1, g0)), join(f0, g1)) };
+				result = getNode(variable, low, high);
+				cacheJoin.emplace(key, result);
+			}
+		}
+	}
+	return result;
+}
+
+
+// All sets with at most maxSize elements. Going to the high child uses one element
+Zdd::Node Zdd::restrictSize(Node f, uint maxSize)
+{
+	Node result{ f };
+	if (f > Base)
+	{
+		const ull key{ makeKey(f, maxSize) };
+		const auto iter{ cacheRestrictSize.find(key) };
+		if (cacheRestrictSize.end() != iter)
+		{
+			result = iter->second;
+		}
+		else
+		{
+			const NodeType nf{ node[f] };
+			const Node low{ restrictSize(nf.low, maxSize) };
+			const Node high{ (0U == maxSize) ? Empty : restrictSize(nf.high, maxSize - 1U) };
+			result = getNode(nf.variable, low, high);
+			cacheRestrictSize.emplace(key, result);
+		}
+	}
+	return result;
+}
+
+
+// Shortest path to the Base terminal. Every high edge counts as one element
+uint Zdd::minimumSize(Node f)
+{
+	uint result{ (Base == f) ? 0U : NoSet };
+	if (f > Base)
+	{
+		const auto iter{ cacheMinimumSize.find(f) };
+		if (cacheMinimumSize.end() != iter)
+		{
+			result = iter->second;
+		}
+		else
+		{
+			const NodeType nf{ node[f] };
+			const uint sizeLow{ minimumSize(nf.low) };
+			const uint sizeHigh{ minimumSize(nf.high) };
+			result = std::min(sizeLow, (NoSet == sizeHigh) ? NoSet : (sizeHigh + 1U));
+			cacheMinimumSize.emplace(f, result);
+		}
+	}
+	return result;
+}
+
+
+// Number of paths to the Base terminal
+ull Zdd::count(Node f)
+{
+	ull result{ (Base == f) ? 1ULL : 0ULL };
+	if (f > Base)
+	{
+		const auto iter{ cacheCount.find(f) };
+		if (cacheCount.end() != iter)
+		{
+			result = iter->second;
+		}
+		else
+		{
+			result = count(node[f].low) + count(node[f].high);
+			cacheCount.emplace(f, result);
+		}
+	}
+	return result;
+}
+
+
+// All sets with the minimum cost. The costs are different for every call. So the caches are cleared first
+Zdd::Node Zdd::minimumCost(Node f, const std::vector<uint>& cost)
+{
+	cacheCost.clear();
+	cacheMinimumCost.clear();
+	return selectMinimumCost(f, cost);
+}
+
+
+// Weighted shortest path to the Base terminal. A high edge costs the cost of its variable
+ull Zdd::calculateMinimumCost(Node f, const std::vector<uint>& cost)
+{
+	ull result{ (Base == f) ? 0ULL : NoCost };
+	if (f > Base)
+	{
+		const auto iter{ cacheCost.find(f) };
+		if (cacheCost.end() != iter)
+		{
+			result = iter->second;
+		}
+		else
+		{
+			const NodeType nf{ node[f] };
+			const ull costLow{ calculateMinimumCost(nf.low, cost) };
+			const ull costHigh{ calculateMinimumCost(nf.high, cost) };
+			const ull costVariable{ (nf.variable < cost.size()) ? cost[nf.variable] : 1ULL };
+			result = std::min(costLow, (NoCost == costHigh) ? NoCost : (costHigh + costVariable));
+			cacheCost.emplace(f, result);
+		}
+	}
+	return result;
+}
+
+
+// Keep only the children on a cheapest path. Each child is again reduced to its cheapest sets
+Zdd::Node Zdd::selectMinimumCost(Node f, const std::vector<uint>& cost)
+{
+	Node result{ f };
+	if (f > Base)
+	{
+		const auto iter{ cacheMinimumCost.find(f) };
+		if (cacheMinimumCost.end() != iter)
+		{
+			result = iter->second;
+		}
+		else
+		{
+			const NodeType nf{ node[f] };
+			const ull costNode{ calculateMinimumCost(f, cost) };
+			const ull costLow{ calculateMinimumCost(nf.low, cost) };
+			const ull costHigh{ calculateMinimumCost(nf.high, cost) };
+			const ull costVariable{ (nf.variable < cost.size()) ? cost[nf.variable] : 1ULL };
+			const Node low{ (costLow == costNode) ? selectMinimumCost(nf.low, cost) : Empty };
+			const Node high{ ((NoCost != costHigh) && ((costHigh + costVariable) == costNode)) ? selectMinimumCost(nf.high, cost) : Empty };
+			result = getNode(nf.variable, low, high);
+			cacheMinimumCost.emplace(f, result);
+		}
+	}
+	return result;
+}
+
+
+// Lexicographical order: The empty set first, then all sets with the smallest variable, then the sets without it
+void Zdd::enumerate(Node f, std::vector<ProductTerm>& result, std::size_t maxNumberOfSets) const
+{
+	ProductTerm productTerm;
+	enumerate(f, productTerm, result, maxNumberOfSets);
+}
+
+void Zdd::enumerate(Node f, ProductTerm& productTerm, std::vector<ProductTerm>& result, std::size_t maxNumberOfSets) const
+{
+	// The empty set is at the end of the path with only low edges
+	Node low{ f };
+	while (low > Base)
+	{
+		low = node[low].low;
+	}
+	if ((Base == low) && (result.size() < maxNumberOfSets))
+	{
+		result.push_back(productTerm);
+	}
+	// The low edges lead to the sets without the variable. So the variables on this path are increasing
+	for (Node n = f; (n > Base) && (result.size() < maxNumberOfSets); n = node[n].low)
+	{
+		const BooleanVariable variable{ narrow_cast<BooleanVariable>(node[n].variable) };
+		productTerm.insert(variable);
+		enumerate(node[n].high, productTerm, result, maxNumberOfSets);
+		productTerm.erase(variable);
+	}
+}
+
+
+
+
+// Functor operator. Multiply all rows of the table in a ZDD and take the cheapest minimum covers
+ProductTermVector ZddCovering::operator()(const std::vector<DynamicBitset>& tableRow)
+{
+	// Time and size of the ZDD for option -stats
+	StageTimer stageTimer("ZddCovering");
+
+	ProductTermVector result;
+	if (!tableRow.empty())
+	{
+		// The size of a minimum cover. Sets, that are longer, can never be a result
+		BranchAndBoundCovering branchAndBoundCovering(false);
+		const ProductTermVector oneCover{ branchAndBoundCovering(tableRow) };
+		if (!oneCover.empty())
+		{
+			const uint minimumCoverSize{ narrow_cast<uint>(oneCover[0].size()) };
+
+			// Rows with few columns first. So the intermediate ZDDs stay small
+			std::vector<std::pair<std::size_t, std::size_t>> numberOfColumnsAndRow;
+			for (std::size_t row = 0U; row < tableRow.size(); ++row)
+			{
+				numberOfColumnsAndRow.emplace_back(tableRow[row].count(), row);
+			}
+			std::sort(numberOfColumnsAndRow.begin(), numberOfColumnsAndRow.end());
+
+			Zdd zdd;
+			Zdd::Node product{ Zdd::Base };
+			for (const std::pair<std::size_t, std::size_t>& ncr : numberOfColumnsAndRow)
+			{
+				// The row as family of single columns. The variables must be increasing from the root. So start with the last column
+				const DynamicBitset& row{ tableRow[ncr.second] };
+				Zdd::Node rowFamily{ Zdd::Empty };
+				for (std::size_t column = row.size(); column > 0U; --column)
+				{
+					if (row.test(column - 1U))
+					{
+						rowFamily = zdd.unite(zdd.single(narrow_cast<uint>(column - 1U)), rowFamily);
+					}
+				}
+				product = zdd.restrictSize(zdd.join(product, rowFamily), minimumCoverSize);
+				stageTimer().append("zddNodes", zdd.numberOfNodes());
+			}
+
+			// Only sets with the minimum size are left. Select the cheapest of them in the ZDD
+			// and enumerate only these, in the order of Petricks method
+			const Zdd::Node cheapestCover{ zdd.minimumCost(product, columnCost) };
+			zdd.enumerate(cheapestCover, result, MaxNumberOfCovers);
+
+			stageTimer().add("minimumCoverSize", zdd.minimumSize(product));
+			stageTimer().add("minimumCovers", zdd.count(product));
+			stageTimer().add("cheapestCovers", zdd.count(cheapestCover));
+			stageTimer().add("enumeratedCovers", result.size());
+		}
+		stageTimer().add("rows", tableRow.size());
+		stageTimer().add("columns", tableRow[0].size());
+	}
+	return result;
+}